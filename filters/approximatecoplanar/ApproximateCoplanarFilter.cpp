@@ -35,11 +35,8 @@
 #include "ApproximateCoplanarFilter.hpp"
 
 #include <pdal/Eigen.hpp>
-#include <pdal/KDIndex.hpp>
 #include <pdal/pdal_macros.hpp>
 
-#include <Eigen/Dense>
-
 #include <string>
 #include <vector>
 
@@ -80,27 +77,13 @@ void ApproximateCoplanarFilter::addDimensions(PointLayoutPtr layout)
 
 void ApproximateCoplanarFilter::filter(PointView& view)
 {
-    using namespace Eigen;
-
-    KD3Index kdi(view);
-    kdi.build();
+    std::vector<NeighborhoodFeatures> features;
+    computeFeatures(view, m_knn, NeighborhoodFeatures::Eigenvalues, features,
+        0.01, numThreads());
 
     for (PointId i = 0; i < view.size(); ++i)
     {
-        // find the k-nearest neighbors
-        double x = view.getFieldAs<double>(Dimension::Id::X, i);
-        double y = view.getFieldAs<double>(Dimension::Id::Y, i);
-        double z = view.getFieldAs<double>(Dimension::Id::Z, i);
-        auto ids = kdi.neighbors(x, y, z, m_knn);
-
-        // compute covariance of the neighborhood
-        auto B = computeCovariance(view, ids);
-
-        // perform the eigen decomposition
-        SelfAdjointEigenSolver<Matrix3f> solver(B);
-        if (solver.info() != Success)
-            throw pdal_error("Cannot perform eigen decomposition.");
-        auto ev = solver.eigenvalues();
+        auto const& ev = features[i].eigenvalues;
 
         // test eigenvalues to label points that are approximately coplanar
         if ((ev[1] > m_thresh1 * ev[0]) && (m_thresh2 * ev[1] > ev[2]))
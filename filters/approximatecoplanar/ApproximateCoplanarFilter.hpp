@@ -72,6 +72,8 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void processOptions(const Options& options);
     virtual void filter(PointView& view);
+    virtual bool threadSafe() const
+        { return true; }
 
     ApproximateCoplanarFilter& operator=(const ApproximateCoplanarFilter&); // not implemented
     ApproximateCoplanarFilter(const ApproximateCoplanarFilter&); // not implemented
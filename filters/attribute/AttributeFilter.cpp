@@ -224,13 +224,19 @@ void AttributeFilter::UpdateGEOSBuffer(PointView& view)
         BOX3D box = p.bounds();
         std::vector<PointId> ids = idx.getPoints(box);
 
-
-        for (const auto& i : ids)
+        std::vector<double> x(ids.size());
+        std::vector<double> y(ids.size());
+        for (size_t i = 0; i < ids.size(); ++i)
         {
-            PointRef ref(view, i);
-            if (p.covers(ref))
-                view.setField(m_dim, i, fieldVal);
+            x[i] = view.getFieldAs<double>(Dimension::Id::X, ids[i]);
+            y[i] = view.getFieldAs<double>(Dimension::Id::Y, ids[i]);
         }
+        std::vector<uint8_t> covers(ids.size());
+        p.covers(x.data(), y.data(), ids.size(), covers.data());
+
+        for (size_t i = 0; i < ids.size(); ++i)
+            if (covers[i])
+                view.setField(m_dim, ids[i], fieldVal);
         feature = OGRFeaturePtr(OGR_L_GetNextFeature(m_lyr),
             OGRFeatureDeleter());
     }
@@ -33,6 +33,8 @@
 
 #include "ChipperFilter.hpp"
 
+#include <algorithm>
+#include <future>
 #include <iostream>
 #include <limits>
 
@@ -57,13 +59,19 @@ of the spare array then becomes the active array for the narrow direction.
 This avoids resorting of the arrays, which are already sorted.
 
 This procedure is then recursively applied to the created blocks until
-they contains only one or two partitions.  In the case of one partition,
+they contains only one or two partitions.  The two blocks created by a
+split share no entries of the arrays, so when more than one thread is
+allowed, large blocks are handled concurrently.  In the case of one partition,
 we are done, and we simply store away the contents of the block.  If there are
 two partitions in a block, we avoid the recopying the narrow array to the
 spare since the wide array already contains the desired points partitioned
 into two blocks.  We simply need to locate the maximum and minimum values
 from the narrow array so that the approriate extrema of the block can
 be stored.
+
+The list that holds the points of each final block is recorded by partition
+and the output views are made once the recursion is done, so that the views
+are created in the same order whatever the number of threads.
 **/
 
 #include <pdal/pdal_macros.hpp>
@@ -71,6 +79,14 @@ be stored.
 namespace pdal
 {
 
+namespace
+{
+
+// Blocks with fewer points than this aren't split across threads.
+const point_count_t MinParallelPoints = 65536;
+
+}
+
 static PluginInfo const s_info = PluginInfo(
     "filters.chipper",
     "Organize points into spatially contiguous, squarish, and non-overlapping chips.",
@@ -103,7 +119,16 @@ PointViewSet ChipperFilter::run(PointViewPtr view)
     m_inView = view;
     load(*view.get(), m_xvec, m_yvec, m_spare);
     partition(m_xvec.size());
-    decideSplit(m_xvec, m_yvec, m_spare, 0, m_partitions.size() - 1);
+    m_chips.assign(m_partitions.size() - 1, nullptr);
+
+    // Split the work until there's a block for each thread.
+    int splits = 0;
+    while ((size_t(1) << splits) < numThreads())
+        splits++;
+    decideSplit(m_xvec, m_yvec, m_spare, 0, m_partitions.size() - 1, splits);
+
+    for (PointId p = 0; p < m_chips.size(); ++p)
+        makeView(*m_chips[p], m_partitions[p], m_partitions[p + 1] - 1);
     return m_outViews;
 }
 
@@ -118,32 +143,52 @@ void ChipperFilter::load(PointView& view, ChipRefList& xvec, ChipRefList& yvec,
     yvec.reserve(view.size());
     spare.resize(view.size());
 
-    for (PointId i = 0; i < view.size(); ++i)
+    const point_count_t blockSize = 4096;
+    std::vector<double> x(blockSize);
+    std::vector<double> y(blockSize);
+    for (PointId begin = 0; begin < view.size(); begin += blockSize)
     {
-        ChipPtRef xref;
+        PointId end = (std::min)(begin + blockSize, view.size());
+        view.getFieldsAs(Dimension::Id::X, begin, end, x.data());
+        view.getFieldsAs(Dimension::Id::Y, begin, end, y.data());
+        for (PointId i = begin; i < end; ++i)
+        {
+            ChipPtRef xref;
 
-        xref.m_pos = view.getFieldAs<double>(Dimension::Id::X, i);
-        xref.m_ptindex = i;
-        xvec.push_back(xref);
+            xref.m_pos = x[i - begin];
+            xref.m_ptindex = i;
+            xvec.push_back(xref);
 
-        ChipPtRef yref;
+            ChipPtRef yref;
 
-        yref.m_pos = view.getFieldAs<double>(Dimension::Id::Y, i);
-        yref.m_ptindex = i;
-        yvec.push_back(yref);
+            yref.m_pos = y[i - begin];
+            yref.m_ptindex = i;
+            yvec.push_back(yref);
+        }
     }
 
-    // Sort xvec and assign other index in yvec to sorted indices in xvec.
+    // Sort yvec alongside xvec when there are threads to spare.
+    std::future<void> ysort;
+    if (numThreads() > 1 && view.size() >= MinParallelPoints)
+        ysort = std::async(std::launch::async,
+            [&yvec]() { std::stable_sort(yvec.begin(), yvec.end()); });
+    else
+        std::stable_sort(yvec.begin(), yvec.end());
+
+    // Sort xvec and note where each point landed, then assign other index
+    // in yvec to sorted indices in xvec.
     std::stable_sort(xvec.begin(), xvec.end());
+    std::vector<uint32_t> xpos(xvec.size());
     for (size_t i = 0; i < xvec.size(); ++i)
+        xpos[xvec[i].m_ptindex] = i;
+    if (ysort.valid())
+        ysort.get();
+    for (size_t i = 0; i < yvec.size(); ++i)
     {
-        idx = xvec[i].m_ptindex;
-        yvec[idx].m_oindex = i;
+        idx = yvec[i].m_ptindex;
+        yvec[i].m_oindex = xpos[idx];
     }
 
-    // Sort yvec.
-    std::stable_sort(yvec.begin(), yvec.end());
-
     // Iterate through the yvector, setting the xvector appropriately.
     for (size_t i = 0; i < yvec.size(); ++i)
         xvec[yvec[i].m_oindex].m_oindex = i;
@@ -176,7 +221,7 @@ void ChipperFilter::partition(point_count_t size)
 
 
 void ChipperFilter::decideSplit(ChipRefList& v1, ChipRefList& v2, ChipRefList& spare,
-    PointId pleft, PointId pright)
+    PointId pleft, PointId pright, int splits)
 {
     double v1range;
     double v2range;
@@ -188,13 +233,15 @@ void ChipperFilter::decideSplit(ChipRefList& v1, ChipRefList& v2, ChipRefList& s
     v1range = v1[right].m_pos - v1[left].m_pos;
     v2range = v2[right].m_pos - v2[left].m_pos;
     if (v1range > v2range)
-        split(v1, v2, spare, pleft, pright);
+        split(v1, v2, spare, pleft, pright, splits);
     else
-        split(v2, v1, spare, pleft, pright);
+        split(v2, v1, spare, pleft, pright, splits);
 }
 
+// While splits is positive, the left block of a large enough split is
+// handled on a new thread.
 void ChipperFilter::split(ChipRefList& wide, ChipRefList& narrow, ChipRefList& spare,
-    PointId pleft, PointId pright)
+    PointId pleft, PointId pright, int splits)
 {
     PointId lstart;
     PointId rstart;
@@ -211,9 +258,9 @@ void ChipperFilter::split(ChipRefList& wide, ChipRefList& narrow, ChipRefList& s
     // 2) We have a distance of three between left and right.
 
     if (pright - pleft == 1)
-        emit(wide, left, right);
+        emit(wide, pleft);
     else if (pright - pleft == 2)
-        finalSplit(wide, narrow, pleft, pright);
+        finalSplit(wide, pleft, pright);
     else
     {
         pcenter = (pleft + pright) / 2;
@@ -241,82 +288,41 @@ void ChipperFilter::split(ChipRefList& wide, ChipRefList& narrow, ChipRefList& s
             }
         }
 
-        // Save away the direction so we know which array is X and which is Y
-        // so that when we emit, we can properly label the max/min points.
-        Direction dir = narrow.m_dir;
-        spare.m_dir = dir;
-        decideSplit(wide, spare, narrow, pleft, pcenter);
-        decideSplit(wide, spare, narrow, pcenter, pright);
-        narrow.m_dir = dir;
-    }
-}
-
-// In this case the wide array is like we want it.  The narrow array is
-// ordered, but not for our split, so we have to find the max/min entries
-// for each partition in the final split.
-void ChipperFilter::finalSplit(ChipRefList& wide, ChipRefList& narrow,
-    PointId pleft, PointId pright)
-{
-
-    int64_t left1 = -1;
-    int64_t left2 = -1;
-    int64_t right1 = -1;
-    int64_t right2 = -1;
-
-    // It appears we're using int64_t here because we're using -1 as
-    // an indicator.  I'm not 100% sure that i ends up <0, but I don't
-    // think so.  These casts will at least shut up the compiler, but
-    // I think this code should be revisited to use std::vector<uint32_t>::const_iterator
-    // or std::vector<uint32_t>::size_type instead of this int64_t stuff -- hobu 11/15/10
-    int64_t left = m_partitions[pleft];
-    int64_t right = static_cast<int64_t>(m_partitions[pright] - 1);
-    int64_t center = static_cast<int64_t>(m_partitions[pright - 1]);
-
-    // Find left values for the partitions.
-    for (int64_t i = left; i <= right; ++i)
-    {
-        int64_t idx = static_cast<int64_t>(narrow[static_cast<uint32_t>(i)].m_oindex);
-        if (left1 < 0 && (idx < center))
+        if (splits > 0 && right - left + 1 >= MinParallelPoints)
         {
-            left1 = i;
-            if (left2 >= 0)
-                break;
+            std::future<void> leftBlock = std::async(std::launch::async,
+                [&, pleft, pcenter, splits]()
+                { decideSplit(wide, spare, narrow, pleft, pcenter,
+                    splits - 1); });
+            decideSplit(wide, spare, narrow, pcenter, pright, splits - 1);
+            leftBlock.get();
         }
-        else if (left2 < 0 && (idx >= center))
+        else
         {
-            left2 = i;
-            if (left1 >= 0)
-                break;
-        }
-    }
-    // Find right values for the partitions.
-    for (int64_t i = right; i >= left; --i)
-    {
-        int64_t idx = static_cast<int64_t>(narrow[static_cast<uint32_t>(i)].m_oindex);
-        if (right1 < 0 && (idx < center))
-        {
-            right1 = i;
-            if (right2 >= 0)
-                break;
-        }
-        else if (right2 < 0 && (idx >= center))
-        {
-            right2 = i;
-            if (right1 >= 0)
-                break;
+            decideSplit(wide, spare, narrow, pleft, pcenter, 0);
+            decideSplit(wide, spare, narrow, pcenter, pright, 0);
         }
     }
+}
 
-    // Emit results.
-    emit(wide,
-         left,
-         center - 1);
-    emit(wide,
-         center,
-         right);
+// In this case the wide array is like we want it: each of the two
+// partitions in [pleft, pright) is a chip.
+void ChipperFilter::finalSplit(ChipRefList& wide, PointId pleft,
+    PointId pright)
+{
+    emit(wide, pleft);
+    emit(wide, pright - 1);
+}
+
+// Record the list holding the points of the chip at partition p.  The
+// entries of the chip aren't touched by the rest of the recursion.
+void ChipperFilter::emit(ChipRefList& wide, PointId p)
+{
+    m_chips[p] = &wide;
 }
 
-void ChipperFilter::emit(ChipRefList& wide, PointId widemin, PointId widemax)
+void ChipperFilter::makeView(ChipRefList& wide, PointId widemin,
+    PointId widemax)
 {
     PointViewPtr view = m_inView->makeNew();
     for (size_t idx = widemin; idx <= widemax; ++idx)
@@ -154,17 +154,19 @@ private:
         ChipRefList& yvec, ChipRefList& spare);
     void partition(point_count_t size);
     void decideSplit(ChipRefList& v1, ChipRefList& v2,
-        ChipRefList& spare, PointId left, PointId right);
+        ChipRefList& spare, PointId left, PointId right, int splits);
     void split(ChipRefList& wide, ChipRefList& narrow,
-        ChipRefList& spare, PointId left, PointId right);
-    void finalSplit(ChipRefList& wide, ChipRefList& narrow,
-        PointId pleft, PointId pcenter);
-    void emit(ChipRefList& wide, PointId widemin, PointId widemax);
+        ChipRefList& spare, PointId left, PointId right, int splits);
+    void finalSplit(ChipRefList& wide, PointId pleft, PointId pright);
+    void emit(ChipRefList& wide, PointId p);
+    void makeView(ChipRefList& wide, PointId widemin, PointId widemax);
 
     PointId m_threshold;
     PointViewPtr m_inView;
     PointViewSet m_outViews;
     std::vector<PointId> m_partitions;
+    // List holding the points of the chip at each partition.
+    std::vector<ChipRefList *> m_chips;
     ChipRefList m_xvec;
     ChipRefList m_yvec;
     ChipRefList m_spare;
@@ -40,6 +40,7 @@
 #include <gdal.h>
 #include <ogr_spatialref.h>
 
+#include <algorithm>
 #include <array>
 
 namespace pdal
@@ -168,7 +169,10 @@ void ColorizationFilter::processOptions(const Options& options)
         BandInfo bi = parseDim(dim, defaultBand);
         defaultBand = bi.m_band + 1;
         m_bands.push_back(bi);
+        m_bandNums.push_back((int)bi.m_band);
     }
+
+    m_bilinear = options.getValueOrDefault<bool>("bilinear", false);
 }
 
 
@@ -203,34 +207,87 @@ void ColorizationFilter::ready(PointTableRef table)
 }
 
 
-bool ColorizationFilter::processOne(PointRef& point)
+// Read the bands at a number of locations, throwing if the raster
+// can't be read.
+void ColorizationFilter::read(const double *x, const double *y,
+    point_count_t count)
 {
-    static std::vector<double> data;
+    gdal::GDALError::Enum error = m_raster->read(x, y, count, m_bandNums,
+        m_data, m_valid, m_bilinear);
+    if (error != gdal::GDALError::None)
+        throw pdal_error(getName() + ": " + m_raster->errorMsg());
+}
+
 
+bool ColorizationFilter::processOne(PointRef& point)
+{
     double x = point.getFieldAs<double>(Dimension::Id::X);
     double y = point.getFieldAs<double>(Dimension::Id::Y);
 
-    if (m_raster->read(x, y, data) == gdal::GDALError::None)
+    read(&x, &y, 1);
+    if (!m_valid[0])
+        return false;
+    for (size_t b = 0; b < m_bands.size(); ++b)
+        point.setField(m_bands[b].m_dim, m_data[b] * m_bands[b].m_scale);
+    return true;
+}
+
+
+point_count_t ColorizationFilter::processBatch(PointRef& point,
+    point_count_t count, std::vector<uint8_t>& skips)
+{
+    const PointId begin = point.pointId();
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+
+    point.getFieldsAs(Dimension::Id::X, count, x.data());
+    point.getFieldsAs(Dimension::Id::Y, count, y.data());
+    read(x.data(), y.data(), count);
+
+    // Points outside of the raster are filtered out.
+    const size_t numBands = m_bands.size();
+    for (PointId i = 0; i < count; ++i)
     {
-        int i(0);
-        for (auto bi = m_bands.begin(); bi != m_bands.end(); ++bi)
+        if (skips[begin + i])
+            continue;
+        if (!m_valid[i])
         {
-            BandInfo& b = *bi;
-            point.setField(b.m_dim, data[i] * b.m_scale);
-            ++i;
+            skips[begin + i] = 1;
+            continue;
         }
-        return true;
+        point.setPointId(begin + i);
+        for (size_t b = 0; b < numBands; ++b)
+            point.setField(m_bands[b].m_dim,
+                m_data[i * numBands + b] * m_bands[b].m_scale);
     }
-    return false;
+    return count;
 }
 
+
 void ColorizationFilter::filter(PointView& view)
 {
-    PointRef point = view.point(0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    // Points are read in blocks so that nearby points share the blocks
+    // cached by the raster.
+    const point_count_t BlockSize = 4096;
+    const size_t numBands = m_bands.size();
+    std::vector<double> x(BlockSize);
+    std::vector<double> y(BlockSize);
+
+    for (PointId begin = 0; begin < view.size(); begin += BlockSize)
     {
-        point.setPointId(idx);
-        processOne(point);
+        point_count_t count = (std::min)(BlockSize, view.size() - begin);
+        view.getFieldsAs(Dimension::Id::X, begin, begin + count, x.data());
+        view.getFieldsAs(Dimension::Id::Y, begin, begin + count, y.data());
+        read(x.data(), y.data(), count);
+
+        for (PointId i = 0; i < count; ++i)
+        {
+            if (!m_valid[i])
+                continue;
+            for (size_t b = 0; b < numBands; ++b)
+                view.setField(m_bands[b].m_dim, begin + i,
+                    m_data[i * numBands + b] * m_bands[b].m_scale);
+        }
     }
 }
 
@@ -72,7 +72,7 @@ public:
     };
 
 
-    ColorizationFilter()
+    ColorizationFilter() : m_bilinear(false)
     {}
 
     static void * create();
@@ -87,10 +87,18 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void ready(PointTableRef table);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(PointRef& point, point_count_t count,
+        std::vector<uint8_t>& skips);
     virtual void filter(PointView& view);
 
+    void read(const double *x, const double *y, point_count_t count);
+
     std::string m_rasterFilename;
     std::vector<BandInfo> m_bands;
+    std::vector<int> m_bandNums;
+    bool m_bilinear;
+    std::vector<double> m_data;
+    std::vector<uint8_t> m_valid;
 
     std::unique_ptr<gdal::Raster> m_raster;
 
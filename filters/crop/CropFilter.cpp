@@ -41,6 +41,7 @@
 #include <pdal/Polygon.hpp>
 #include <pdal/pdal_macros.hpp>
 
+#include <algorithm>
 #include <sstream>
 #include <cstdarg>
 
@@ -156,6 +157,36 @@ bool CropFilter::processOne(PointRef& point)
 }
 
 
+point_count_t CropFilter::processBatch(PointRef& point, point_count_t count,
+    std::vector<uint8_t>& skips)
+{
+    const PointId begin = point.pointId();
+
+    if (m_bounds.empty() && m_geoms.empty())
+        return count;
+
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    point.getFieldsAs(Dimension::Id::X, count, x.data());
+    point.getFieldsAs(Dimension::Id::Y, count, y.data());
+
+    for (auto& box : m_bounds)
+        for (PointId i = 0; i < count; ++i)
+            if (m_cropOutside == box.contains(x[i], y[i]))
+                skips[begin + i] = 1;
+
+    std::vector<uint8_t> covers(count);
+    for (auto& geom : m_geoms)
+    {
+        geom.m_geom.covers(x.data(), y.data(), count, covers.data());
+        for (PointId i = 0; i < count; ++i)
+            if (m_cropOutside == (bool)covers[i])
+                skips[begin + i] = 1;
+    }
+    return count;
+}
+
+
 PointViewSet CropFilter::run(PointViewPtr view)
 {
     PointViewSet viewSet;
@@ -223,14 +254,24 @@ bool CropFilter::crop(PointRef& point, const GeomPkg& g)
 
 void CropFilter::crop(const GeomPkg& g, PointView& input, PointView& output)
 {
-    PointRef point = input.point(0);
-    for (PointId idx = 0; idx < input.size(); ++idx)
+    // Points are tested a block at a time to limit the memory used for
+    // their coordinates.
+    const point_count_t blockSize = 4096;
+    std::vector<double> x(blockSize);
+    std::vector<double> y(blockSize);
+    std::vector<uint8_t> covers(blockSize);
+    for (PointId begin = 0; begin < input.size(); begin += blockSize)
     {
-        point.setPointId(idx);
-        bool covers = g.m_geom.covers(point);
-        bool keep = (m_cropOutside != covers);
-        if (keep)
-            output.appendPoint(input, idx);
+        PointId end = (std::min)(begin + blockSize, input.size());
+        input.getFieldsAs(Dimension::Id::X, begin, end, x.data());
+        input.getFieldsAs(Dimension::Id::Y, begin, end, y.data());
+        g.m_geom.covers(x.data(), y.data(), end - begin, covers.data());
+        for (PointId idx = begin; idx < end; ++idx)
+        {
+            bool keep = (m_cropOutside != (bool)covers[idx - begin]);
+            if (keep)
+                output.appendPoint(input, idx);
+        }
     }
 }
 
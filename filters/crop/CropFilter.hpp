@@ -78,6 +78,8 @@ private:
     virtual void processOptions(const Options& options);
     virtual void ready(PointTableRef table);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(PointRef& point, point_count_t count,
+        std::vector<uint8_t>& skips);
     virtual PointViewSet run(PointViewPtr view);
     bool crop(PointRef& point, const BOX2D& box);
     void crop(const BOX2D& box, PointView& input, PointView& output);
@@ -65,6 +65,8 @@ private:
         { m_index = 0; }
     bool processOne(PointRef& point);
     PointViewSet run(PointViewPtr view);
+    bool threadSafe() const
+        { return true; }
     void decimate(PointView& input, PointView& output);
 
     DecimationFilter& operator=(const DecimationFilter&); // not implemented
@@ -35,11 +35,8 @@
 #include "EigenvaluesFilter.hpp"
 
 #include <pdal/Eigen.hpp>
-#include <pdal/KDIndex.hpp>
 #include <pdal/pdal_macros.hpp>
 
-#include <Eigen/Dense>
-
 #include <string>
 #include <vector>
 
@@ -78,27 +75,13 @@ void EigenvaluesFilter::addDimensions(PointLayoutPtr layout)
 
 void EigenvaluesFilter::filter(PointView& view)
 {
-    using namespace Eigen;
-
-    KD3Index kdi(view);
-    kdi.build();
+    std::vector<NeighborhoodFeatures> features;
+    computeFeatures(view, m_knn, NeighborhoodFeatures::Eigenvalues, features,
+        0.01, numThreads());
 
     for (PointId i = 0; i < view.size(); ++i)
     {
-        // find the k-nearest neighbors
-        double x = view.getFieldAs<double>(Dimension::Id::X, i);
-        double y = view.getFieldAs<double>(Dimension::Id::Y, i);
-        double z = view.getFieldAs<double>(Dimension::Id::Z, i);
-        auto ids = kdi.neighbors(x, y, z, m_knn);
-
-        // compute covariance of the neighborhood
-        auto B = computeCovariance(view, ids);
-
-        // perform the eigen decomposition
-        SelfAdjointEigenSolver<Matrix3f> solver(B);
-        if (solver.info() != Success)
-            throw pdal_error("Cannot perform eigen decomposition.");
-        auto ev = solver.eigenvalues();
+        auto const& ev = features[i].eigenvalues;
 
         view.setField(m_e0, i, ev[0]);
         view.setField(m_e1, i, ev[1]);
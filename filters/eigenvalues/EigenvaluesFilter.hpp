@@ -70,6 +70,8 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void processOptions(const Options& options);
     virtual void filter(PointView& view);
+    virtual bool threadSafe() const
+        { return true; }
 
     EigenvaluesFilter& operator=(const EigenvaluesFilter&); // not implemented
     EigenvaluesFilter(const EigenvaluesFilter&); // not implemented
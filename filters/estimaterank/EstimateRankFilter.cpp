@@ -35,7 +35,6 @@
 #include "EstimateRankFilter.hpp"
 
 #include <pdal/Eigen.hpp>
-#include <pdal/KDIndex.hpp>
 #include <pdal/pdal_macros.hpp>
 
 #include <string>
@@ -76,19 +75,12 @@ void EstimateRankFilter::addDimensions(PointLayoutPtr layout)
 
 void EstimateRankFilter::filter(PointView& view)
 {
-    KD3Index kdi(view);
-    kdi.build();
+    std::vector<NeighborhoodFeatures> features;
+    computeFeatures(view, m_knn, NeighborhoodFeatures::Rank, features,
+        m_thresh, numThreads());
 
     for (PointId i = 0; i < view.size(); ++i)
-    {
-        // find the k-nearest neighbors
-        double x = view.getFieldAs<double>(Dimension::Id::X, i);
-        double y = view.getFieldAs<double>(Dimension::Id::Y, i);
-        double z = view.getFieldAs<double>(Dimension::Id::Z, i);
-        auto ids = kdi.neighbors(x, y, z, m_knn);
-
-        view.setField(m_rank, i, computeRank(view, ids, m_thresh));
-    }
+        view.setField(m_rank, i, features[i].rank);
 }
 
 } // namespace pdal
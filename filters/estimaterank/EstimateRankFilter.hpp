@@ -71,6 +71,8 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void processOptions(const Options& options);
     virtual void filter(PointView& view);
+    virtual bool threadSafe() const
+        { return true; }
 
     EstimateRankFilter& operator=(const EstimateRankFilter&); // not implemented
     EstimateRankFilter(const EstimateRankFilter&); // not implemented
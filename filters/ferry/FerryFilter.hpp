@@ -65,6 +65,8 @@ private:
     virtual void ready(PointTableRef table);
     virtual bool processOne(PointRef& point);
     virtual void filter(PointView& view);
+    virtual bool threadSafe() const
+        { return true; }
 
     FerryFilter& operator=(const FerryFilter&); // not implemented
     FerryFilter(const FerryFilter&); // not implemented
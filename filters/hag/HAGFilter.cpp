@@ -93,8 +93,7 @@ void HAGFilter::filter(PointView& view)
         throw pdal_error("HAGFilter: the input PointView does not appear to have any points classified as ground");
 
     // Build the 2D KD-tree.
-    KD2Index kdi(*gView);
-    kdi.build();
+    KD2Index& kdi = gView->build2dIndex(numThreads());
 
     // Second pass: Find Z difference between non-ground points and the nearest 
     // neighbor (2D) in the ground view.
@@ -66,6 +66,8 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void prepared(PointTableRef table);
     virtual void filter(PointView& view);
+    virtual bool threadSafe() const
+        { return true; }
 
     HAGFilter& operator=(const HAGFilter&); // not implemented
     HAGFilter(const HAGFilter&); // not implemented
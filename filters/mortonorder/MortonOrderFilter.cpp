@@ -34,11 +34,11 @@
 
 #include "MortonOrderFilter.hpp"
 #include <pdal/pdal_macros.hpp>
+#include <pdal/util/RadixSort.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
-#include <climits>
-#include <iostream>
+#include <algorithm>
 #include <limits>
-#include <map>
 
 namespace pdal
 {
@@ -55,72 +55,152 @@ std::string MortonOrderFilter::getName() const { return s_info.name; }
 Options MortonOrderFilter::getDefaultOptions()
 {
     Options options;
+    options.add("curve", "morton", "Curve along which points are ordered, "
+        "'morton' or 'hilbert'");
+    options.add("dimension", "", "Name of a dimension into which the key "
+        "of each point is written, or empty to not write keys");
     return options;
 }
 
 
-//This used to be a lambda, but the VS compiler exploded, I guess.
-typedef std::pair<double, double> Coord;
+void MortonOrderFilter::processOptions(const Options& options)
+{
+    std::string curve = Utils::tolower(
+        options.getValueOrDefault<std::string>("curve", "morton"));
+    if (curve == "hilbert")
+        m_hilbert = true;
+    else if (curve != "morton")
+        throw pdal_error(getName() + ": invalid curve '" + curve +
+            "'.  Must be 'morton' or 'hilbert'.");
+    m_keyDimName = options.getValueOrDefault<std::string>("dimension", "");
+}
+
+
+void MortonOrderFilter::addDimensions(PointLayoutPtr layout)
+{
+    if (m_keyDimName.size())
+        m_keyDim = layout->registerOrAssignDim(m_keyDimName,
+            Dimension::Type::Unsigned64);
+}
+
+
 namespace
 {
-bool less_msb(const int& x, const int& y)
+
+// Spread the bits of a 32-bit value so that there's a zero bit between
+// each of them.
+inline uint64_t spread(uint32_t v)
 {
-    return x < y && x < (x ^ y);
-};
+    uint64_t x = v;
+    x = (x | (x << 16)) & 0x0000FFFF0000FFFFULL;
+    x = (x | (x << 8)) & 0x00FF00FF00FF00FFULL;
+    x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    x = (x | (x << 2)) & 0x3333333333333333ULL;
+    x = (x | (x << 1)) & 0x5555555555555555ULL;
+    return x;
+}
 
-class CmpZOrder
+// Position along the Z-order curve.  X is the more significant coordinate.
+inline uint64_t mortonKey(uint32_t x, uint32_t y)
 {
-public:
-    bool operator()(const Coord& c1, const Coord& c2) const
-    {
-        int a[2] = {(int)(c1.first * INT_MAX), (int)(c1.second * INT_MAX)};
-        int b[2] = {(int)(c2.first * INT_MAX), (int)(c2.second * INT_MAX)};
+    return (spread(x) << 1) | spread(y);
+}
 
-        int j = 0;
-        int x = 0;
+// Position along the Hilbert curve that fills a 2^32 x 2^32 grid.
+inline uint64_t hilbertKey(uint32_t x, uint32_t y)
+{
+    uint64_t d = 0;
+    for (uint32_t s = 1u << 31; s; s >>= 1)
+    {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += (uint64_t)s * s * ((3 * rx) ^ ry);
 
-        for (int k = 0; k < 2; k++)
+        // Rotate the quadrant so that the curve within it starts and ends
+        // at the right corners.
+        if (ry == 0)
         {
-            int y = a[k] ^ b[k];
-            if (less_msb(x, y))
+            if (rx == 1)
             {
-                j = k;
-                x = y;
+                x = ~x;
+                y = ~y;
             }
+            std::swap(x, y);
         }
-        return (a[j] - b[j]) < 0;
-    };
-};
+    }
+    return d;
 }
 
+// Scale a coordinate to the range of a 32-bit grid.
+inline uint32_t gridPos(double v, double min, double scale)
+{
+    double pos = (v - min) * scale;
+    return (uint32_t)(std::min)((std::max)(pos, 0.0),
+        (double)(std::numeric_limits<uint32_t>::max)());
+}
+
+} // unnamed namespace
+
+
 PointViewSet MortonOrderFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
     if (!inView->size())
         return viewSet;
-    CmpZOrder compare;
-    std::multimap<Coord, PointId, CmpZOrder> sorted(compare);
 
-    BOX2D buffer_bounds;
-    inView->calculateBounds(buffer_bounds);
-    double xrange = buffer_bounds.maxx - buffer_bounds.minx;
-    double yrange = buffer_bounds.maxy - buffer_bounds.miny;
+    BOX2D bounds;
+    inView->calculateBounds(bounds);
+    const double gridMax = (double)(std::numeric_limits<uint32_t>::max)();
+    double xrange = bounds.maxx - bounds.minx;
+    double yrange = bounds.maxy - bounds.miny;
+    double xscale = xrange > 0 ? gridMax / xrange : 0;
+    double yscale = yrange > 0 ? gridMax / yrange : 0;
+
+    // Compute the keys a block at a time, spreading the blocks across
+    // threads.
+    const point_count_t size = inView->size();
+    const point_count_t blockSize = 65536;
+    std::vector<uint64_t> keys(size);
+    std::vector<uint64_t> ids(size);
+
+    auto computeKeys = [&](PointId begin)
+    {
+        PointId end = (std::min)(begin + blockSize, size);
+        std::vector<double> x(end - begin);
+        std::vector<double> y(end - begin);
+        inView->getFieldsAs(Dimension::Id::X, begin, end, x.data());
+        inView->getFieldsAs(Dimension::Id::Y, begin, end, y.data());
+        for (PointId i = begin; i < end; ++i)
+        {
+            uint32_t gx = gridPos(x[i - begin], bounds.minx, xscale);
+            uint32_t gy = gridPos(y[i - begin], bounds.miny, yscale);
+            keys[i] = m_hilbert ? hilbertKey(gx, gy) : mortonKey(gx, gy);
+            ids[i] = i;
+        }
+    };
 
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    std::size_t threads = numThreads();
+    if (threads > 1 && size > blockSize)
     {
-        double xpos = (inView->getFieldAs<double>(Dimension::Id::X, idx) -
-            buffer_bounds.minx) / xrange;
-        double ypos = (inView->getFieldAs<double>(Dimension::Id::Y, idx) -
-            buffer_bounds.miny) / yrange;
-        Coord loc(xpos, ypos);
-        sorted.insert(std::make_pair(loc, idx));
+        ThreadPool pool(threads);
+        for (PointId begin = 0; begin < size; begin += blockSize)
+            pool.add([&computeKeys, begin](){ computeKeys(begin); });
+        pool.join();
     }
+    else
+        for (PointId begin = 0; begin < size; begin += blockSize)
+            computeKeys(begin);
+
+    Utils::radixSort(keys, ids, threads);
 
+    // Field values pass through a double when they're read, so only the
+    // 52 most significant bits of the keys are stored.
     PointViewPtr outView = inView->makeNew();
-    std::multimap<Coord, PointId, CmpZOrder>::iterator pos;
-    for (pos = sorted.begin(); pos != sorted.end(); ++pos)
+    for (PointId i = 0; i < size; ++i)
     {
-        outView->appendPoint(*inView, pos->second);
+        outView->appendPoint(*inView, ids[i]);
+        if (m_keyDim != Dimension::Id::Unknown)
+            outView->setField(m_keyDim, i, keys[i] >> 12);
     }
     viewSet.insert(outView);
 
@@ -46,7 +46,7 @@ namespace pdal
 class PDAL_DLL MortonOrderFilter : public pdal::Filter
 {
 public:
-    MortonOrderFilter()
+    MortonOrderFilter() : m_hilbert(false), m_keyDim(Dimension::Id::Unknown)
     {}
 
     static void * create();
@@ -56,9 +56,14 @@ public:
     Options getDefaultOptions();
 
 private:
-    virtual void processOptions(const Options& ) {};
+    virtual void processOptions(const Options& options);
+    virtual void addDimensions(PointLayoutPtr layout);
     virtual PointViewSet run(PointViewPtr view);
 
+    bool m_hilbert;
+    std::string m_keyDimName;
+    Dimension::Id::Enum m_keyDim;
+
     MortonOrderFilter& operator=(const MortonOrderFilter&); // not implemented
     MortonOrderFilter(const MortonOrderFilter&); // not implemented
 };
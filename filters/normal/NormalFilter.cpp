@@ -35,11 +35,9 @@
 #include "NormalFilter.hpp"
 
 #include <pdal/Eigen.hpp>
-#include <pdal/KDIndex.hpp>
 #include <pdal/pdal_macros.hpp>
 
-#include <Eigen/Dense>
-
+#include <cmath>
 #include <string>
 #include <vector>
 
@@ -79,28 +77,14 @@ void NormalFilter::addDimensions(PointLayoutPtr layout)
 
 void NormalFilter::filter(PointView& view)
 {
-    using namespace Eigen;
-
-    KD3Index kdi(view);
-    kdi.build();
+    std::vector<NeighborhoodFeatures> features;
+    computeFeatures(view, m_knn, NeighborhoodFeatures::Eigenvalues |
+        NeighborhoodFeatures::Normal, features, 0.01, numThreads());
 
     for (PointId i = 0; i < view.size(); ++i)
     {
-        // find the k-nearest neighbors
-        double x = view.getFieldAs<double>(Dimension::Id::X, i);
-        double y = view.getFieldAs<double>(Dimension::Id::Y, i);
-        double z = view.getFieldAs<double>(Dimension::Id::Z, i);
-        auto ids = kdi.neighbors(x, y, z, m_knn);
-
-        // compute covariance of the neighborhood
-        auto B = computeCovariance(view, ids);
-
-        // perform the eigen decomposition
-        SelfAdjointEigenSolver<Matrix3f> solver(B);
-        if (solver.info() != Success)
-            throw pdal_error("Cannot perform eigen decomposition.");
-        auto eval = solver.eigenvalues();
-        auto evec = solver.eigenvectors().col(0);
+        auto const& eval = features[i].eigenvalues;
+        auto const& evec = features[i].normal;
 
         view.setField(m_nx, i, evec[0]);
         view.setField(m_ny, i, evec[1]);
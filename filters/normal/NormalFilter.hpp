@@ -70,6 +70,8 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void processOptions(const Options& options);
     virtual void filter(PointView& view);
+    virtual bool threadSafe() const
+        { return true; }
 
     NormalFilter& operator=(const NormalFilter&); // not implemented
     NormalFilter(const NormalFilter&); // not implemented
@@ -35,15 +35,21 @@
 #include "OutlierFilter.hpp"
 
 #include <pdal/KDIndex.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/util/Utils.hpp>
 #include <pdal/pdal_macros.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <string>
 #include <vector>
 
 namespace pdal
 {
 
+// Number of points whose neighbors are found together.
+static const point_count_t SlabSize = 1 << 20;
+
 static PluginInfo const s_info =
     PluginInfo("filters.outlier", "Outlier removal",
                "http://pdal.io/stages/filters.outlier.html");
@@ -66,6 +72,12 @@ Options OutlierFilter::getDefaultOptions()
     options.add("multiplier", 2, "Standard deviation threshold");
     options.add("classify", true, "Apply classification labels?");
     options.add("extract", false, "Extract ground returns?");
+    options.add("tile_size", 0, "Size of the tiles processed separately, "
+        "or 0 to process all points together");
+    options.add("buffer", "", "Width of the region around a tile whose "
+        "points are neighbor candidates [default: radius for the radius "
+        "method, derived from the neighbor distances for the statistical "
+        "method]");
     return options;
 }
 
@@ -79,6 +91,9 @@ void OutlierFilter::processOptions(const Options& options)
     m_multiplier = options.getValueOrDefault<double>("multiplier", 2);
     m_classify = options.getValueOrDefault<bool>("classify", true);
     m_extract = options.getValueOrDefault<bool>("extract", false);
+    m_tileSize = options.getValueOrDefault<double>("tile_size", 0);
+    m_bufferSet = options.hasOption("buffer");
+    m_buffer = options.getValueOrDefault<double>("buffer", 0);
 }
 
 
@@ -88,23 +103,136 @@ void OutlierFilter::addDimensions(PointLayoutPtr layout)
 }
 
 
-Indices OutlierFilter::processRadius(PointViewPtr inView)
+// Split the points of a view into square XY tiles.  Each tile is passed
+// to f as a new view holding the points of the tile followed by the
+// points within the buffer around the tile, along with the number of
+// points in the tile, their IDs in the input view and the buffer width.
+// f returns the buffer width that its results need.  If that's wider than
+// the buffer used, the tile is passed to f again with the wider buffer.
+// Tiles are processed concurrently.
+template<typename FUNC>
+void OutlierFilter::forEachTile(PointViewPtr inView, double buffer, FUNC f)
 {
-    KD3Index index(*inView);
-    index.build();
+    const point_count_t np = inView->size();
+
+    BOX2D bounds;
+    inView->calculateBounds(bounds);
+    size_t cols = (size_t)((bounds.maxx - bounds.minx) / m_tileSize) + 1;
+    size_t rows = (size_t)((bounds.maxy - bounds.miny) / m_tileSize) + 1;
+
+    auto tileCol = [&bounds, cols, this](double x)
+    {
+        double c = std::floor((x - bounds.minx) / m_tileSize);
+        return (size_t)(std::min)((std::max)(c, 0.0), (double)(cols - 1));
+    };
+    auto tileRow = [&bounds, rows, this](double y)
+    {
+        double r = std::floor((y - bounds.miny) / m_tileSize);
+        return (size_t)(std::min)((std::max)(r, 0.0), (double)(rows - 1));
+    };
+
+    std::vector<double> xs(np);
+    std::vector<double> ys(np);
+    std::vector<std::vector<PointId>> core(cols * rows);
+    for (PointId i = 0; i < np; ++i)
+    {
+        xs[i] = inView->getFieldAs<double>(Dimension::Id::X, i);
+        ys[i] = inView->getFieldAs<double>(Dimension::Id::Y, i);
+        core[tileRow(ys[i]) * cols + tileCol(xs[i])].push_back(i);
+    }
+
+    // The buffer of a tile holds the points of the other tiles within the
+    // buffer width of the tile's extent.
+    auto runTile = [&](size_t tile)
+    {
+        const size_t row = tile / cols;
+        const size_t col = tile % cols;
+        const double minx = bounds.minx + col * m_tileSize;
+        const double miny = bounds.miny + row * m_tileSize;
+        const std::vector<PointId>& ids = core[tile];
+
+        double width = buffer;
+        while (true)
+        {
+            PointViewPtr tileView = inView->makeNew();
+            for (auto const& id : ids)
+                tileView->appendPoint(*inView, id);
+            for (size_t r = tileRow(miny - width);
+                r <= tileRow(miny + m_tileSize + width); ++r)
+                for (size_t c = tileCol(minx - width);
+                    c <= tileCol(minx + m_tileSize + width); ++c)
+                {
+                    if (r == row && c == col)
+                        continue;
+                    for (auto const& id : core[r * cols + c])
+                        if (xs[id] >= minx - width &&
+                            xs[id] <= minx + m_tileSize + width &&
+                            ys[id] >= miny - width &&
+                            ys[id] <= miny + m_tileSize + width)
+                            tileView->appendPoint(*inView, id);
+                }
+
+            double needed = f(*tileView, ids.size(), ids, width);
+            if (needed <= width || tileView->size() == np)
+                break;
+            width = needed;
+        }
+    };
+
+    ThreadPool pool(numThreads());
+    for (size_t tile = 0; tile < core.size(); ++tile)
+        if (core[tile].size())
+            pool.add([&runTile, tile](){ runTile(tile); });
+    pool.join();
+}
+
 
+Indices OutlierFilter::processRadius(PointViewPtr inView)
+{
     point_count_t np = inView->size();
 
     std::vector<PointId> inliers, outliers;
 
-    for (PointId i = 0; i < np; ++i)
+    // Number of neighbors of each point.
+    std::vector<point_count_t> counts(np);
+    if (m_tileSize > 0)
     {
-        double x = inView->getFieldAs<double>(Dimension::Id::X, i);
-        double y = inView->getFieldAs<double>(Dimension::Id::Y, i);
-        double z = inView->getFieldAs<double>(Dimension::Id::Z, i);
+        double buffer = m_bufferSet ? m_buffer : m_radius;
+        forEachTile(inView, buffer, [this, &counts](PointView& tile,
+            point_count_t numCore, const std::vector<PointId>& coreIds,
+            double /*width*/)
+        {
+            KD3Index index(tile);
+            index.build();
+
+            std::vector<point_count_t> offsets;
+            std::vector<PointId> ids;
+            index.radius(0, numCore, m_radius, offsets, ids);
+            for (PointId i = 0; i < numCore; ++i)
+                counts[coreIds[i]] = offsets[i + 1] - offsets[i];
+            return 0.0;
+        });
+    }
+    else
+    {
+        KD3Index& index = inView->build3dIndex(numThreads());
+
+        // Neighbors are found for a slab of points at a time to limit the
+        // memory used by the neighbor lists.
+        std::vector<point_count_t> offsets;
+        std::vector<PointId> ids;
+        for (PointId begin = 0; begin < np; begin += SlabSize)
+        {
+            PointId end = std::min(begin + SlabSize, np);
+            index.radius(begin, end, m_radius, offsets, ids, numThreads());
+            for (PointId i = begin; i < end; ++i)
+                counts[i] = offsets[i - begin + 1] - offsets[i - begin];
+        }
+    }
 
-        auto ids = index.radius(x, y, z, m_radius);
-        if (ids.size() > size_t(m_minK))
+    for (PointId i = 0; i < np; ++i)
+    {
+        if (counts[i] > size_t(m_minK))
             inliers.push_back(i);
         else
             outliers.push_back(i);
@@ -116,32 +244,75 @@ Indices OutlierFilter::processRadius(PointViewPtr inView)
 
 Indices OutlierFilter::processStatistical(PointViewPtr inView)
 {
-    KD3Index index(*inView);
-    index.build();
-
     point_count_t np = inView->size();
 
     std::vector<PointId> inliers, outliers;
 
+    // we increase the count by one because the query point itself will
+    // be included with a distance of 0
+    point_count_t count = m_meanK + 1;
+
+    // Mean distance from each point to its neighbors.
     std::vector<double> distances(np);
-    for (PointId i = 0; i < np; ++i)
+    auto meanDistances = [this, &distances](
+        const std::vector<double>& sqrDists, point_count_t k, PointId begin,
+        PointId end, const PointId *ids)
     {
-        double x = inView->getFieldAs<double>(Dimension::Id::X, i);
-        double y = inView->getFieldAs<double>(Dimension::Id::Y, i);
-        double z = inView->getFieldAs<double>(Dimension::Id::Z, i);
-
-        // we increase the count by one because the query point itself will
-        // be included with a distance of 0
-        point_count_t count = m_meanK + 1;
+        auto d = sqrDists.begin();
+        for (PointId i = begin; i < end; ++i)
+        {
+            double dist_sum = 0.0;
+            for (point_count_t j = 0; j < k; ++j)
+                dist_sum += sqrt(*d++);
+            distances[ids ? ids[i] : i] = dist_sum / m_meanK;
+        }
+    };
 
-        std::vector<PointId> indices(count);
-        std::vector<double> sqr_dists(count);
-        index.knnSearch(x, y, z, count, &indices, &sqr_dists);
+    if (m_tileSize > 0)
+    {
+        // Unless a buffer is given, the buffer is derived from the
+        // distances to the neighbors.  A point's neighbors among the points
+        // of a tile and its buffer are no nearer than its true neighbors,
+        // so once the buffer is as wide as the farthest neighbor found,
+        // the true neighbors of every point of the tile are in the buffer.
+        double buffer = m_bufferSet ? m_buffer : 0;
+        forEachTile(inView, buffer, [this, count, &meanDistances](
+            PointView& tile, point_count_t numCore,
+            const std::vector<PointId>& coreIds, double width)
+        {
+            KD3Index index(tile);
+            index.build();
+
+            std::vector<PointId> indices;
+            std::vector<double> sqr_dists;
+            point_count_t k = index.knnSearch(0, numCore, count, indices,
+                sqr_dists);
+            meanDistances(sqr_dists, k, 0, numCore, coreIds.data());
+            if (m_bufferSet)
+                return 0.0;
+
+            // Too few points to find all the neighbors: widen the buffer.
+            if (k < count)
+                return 2 * width + m_tileSize;
+            double maxSqrDist = 0;
+            for (PointId i = 0; i < numCore; ++i)
+                maxSqrDist = (std::max)(maxSqrDist, sqr_dists[i * k + k - 1]);
+            return std::sqrt(maxSqrDist);
+        });
+    }
+    else
+    {
+        KD3Index& index = inView->build3dIndex(numThreads());
 
-        double dist_sum = 0.0;
-        for (auto const& d : sqr_dists)
-            dist_sum += sqrt(d);
-        distances[i] = dist_sum / m_meanK;
+        std::vector<PointId> indices;
+        std::vector<double> sqr_dists;
+        for (PointId begin = 0; begin < np; begin += SlabSize)
+        {
+            PointId end = std::min(begin + SlabSize, np);
+            point_count_t k = index.knnSearch(begin, end, count, indices,
+                sqr_dists, numThreads());
+            meanDistances(sqr_dists, k, begin, end, nullptr);
+        }
     }
 
     double sum = 0.0, sq_sum = 0.0;
@@ -75,9 +75,14 @@ private:
     double m_multiplier;
     bool m_classify;
     bool m_extract;
+    double m_tileSize;
+    double m_buffer;
+    bool m_bufferSet;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void processOptions(const Options& options);
+    template<typename FUNC>
+    void forEachTile(PointViewPtr inView, double buffer, FUNC f);
     Indices processRadius(PointViewPtr inView);
     Indices processStatistical(PointViewPtr inView);
     virtual PointViewSet run(PointViewPtr view);
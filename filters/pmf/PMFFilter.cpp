@@ -37,9 +37,56 @@
 #include <pdal/KDIndex.hpp>
 #include <pdal/pdal_macros.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
 namespace pdal
 {
 
+namespace
+{
+
+// Largest number of cells in the raster of the approximate algorithm.  The
+// raster and its filter buffers use several times this many doubles.
+const double MaxRasterCells = 1 << 28;
+
+// Replace each of count values, stride apart, with the result of op over
+// the values within h positions of it.  Positions beyond the ends hold
+// fill.  This is the van Herk/Gil-Werman algorithm: the values are split
+// into blocks the size of the window, and each result combines a suffix
+// of one block with a prefix of the next, so the cost per value doesn't
+// depend on the window size.
+template<typename OP>
+void windowFilter(double *data, size_t count, size_t stride, size_t h,
+    double fill, OP op, std::vector<double>& buf)
+{
+    const size_t w = 2 * h + 1;
+    const size_t len = ((count + 2 * h + w - 1) / w) * w;
+
+    buf.assign(3 * len, fill);
+    double *v = buf.data();
+    double *prefix = v + len;
+    double *suffix = prefix + len;
+
+    for (size_t i = 0; i < count; ++i)
+        v[h + i] = data[i * stride];
+    for (size_t b = 0; b < len; b += w)
+    {
+        prefix[b] = v[b];
+        for (size_t i = b + 1; i < b + w; ++i)
+            prefix[i] = op(prefix[i - 1], v[i]);
+        suffix[b + w - 1] = v[b + w - 1];
+        for (size_t i = b + w - 1; i > b; --i)
+            suffix[i - 1] = op(suffix[i], v[i - 1]);
+    }
+    for (size_t i = 0; i < count; ++i)
+        data[i * stride] = op(suffix[i], prefix[i + w - 1]);
+}
+
+} // unnamed namespace
+
 static PluginInfo const s_info =
     PluginInfo("filters.pmf", "Progressive morphological filter",
                "http://pdal.io/stages/filters.pmf.html");
@@ -86,8 +133,7 @@ std::vector<double> PMFFilter::morphOpen(PointViewPtr view, float radius)
 {
     point_count_t np(view->size());
 
-    KD2Index index(*view);
-    index.build();
+    KD2Index& index = view->build2dIndex(numThreads());
 
     std::vector<double> minZ(np), maxZ(np);
     typedef std::vector<PointId> PointIdVec;
@@ -129,13 +175,37 @@ std::vector<double> PMFFilter::morphOpen(PointViewPtr view, float radius)
     return maxZ;
 }
 
-std::vector<PointId> PMFFilter::processGround(PointViewPtr view)
+// Apply a morphological opening (erosion, then dilation) with a square
+// window of 2h+1 cells to a raster of cols by rows cells.  Empty cells
+// hold infinity and don't contribute to the result.
+void PMFFilter::morphOpen(std::vector<double>& raster, size_t cols,
+    size_t rows, size_t h)
 {
-    point_count_t np(view->size());
+    const double empty = (std::numeric_limits<double>::max)();
+    const double lowest = std::numeric_limits<double>::lowest();
+    auto minOp = [](double a, double b) { return (std::min)(a, b); };
+    auto maxOp = [](double a, double b) { return (std::max)(a, b); };
+    std::vector<double> buf;
+
+    // The window is square, so each operation is done on the rows and
+    // then on the columns.
+    for (size_t r = 0; r < rows; ++r)
+        windowFilter(raster.data() + r * cols, cols, 1, h, empty, minOp, buf);
+    for (size_t c = 0; c < cols; ++c)
+        windowFilter(raster.data() + c, rows, cols, h, empty, minOp, buf);
+
+    // Cells with no data in their window don't raise their neighbors.
+    std::replace(raster.begin(), raster.end(), empty, lowest);
+    for (size_t r = 0; r < rows; ++r)
+        windowFilter(raster.data() + r * cols, cols, 1, h, lowest, maxOp, buf);
+    for (size_t c = 0; c < cols; ++c)
+        windowFilter(raster.data() + c, rows, cols, h, lowest, maxOp, buf);
+    std::replace(raster.begin(), raster.end(), lowest, empty);
+}
 
-    // Compute the series of window sizes and height thresholds
-    std::vector<float> height_thresholds;
-    std::vector<float> window_sizes;
+void PMFFilter::computeThresholds(std::vector<float>& window_sizes,
+    std::vector<float>& height_thresholds)
+{
     int iteration = 0;
     float window_size = 0.0f;
     float height_threshold = 0.0f;
@@ -163,6 +233,16 @@ std::vector<PointId> PMFFilter::processGround(PointViewPtr view)
 
         iteration++;
     }
+}
+
+std::vector<PointId> PMFFilter::processGround(PointViewPtr view)
+{
+    point_count_t np(view->size());
+
+    // Compute the series of window sizes and height thresholds
+    std::vector<float> height_thresholds;
+    std::vector<float> window_sizes;
+    computeThresholds(window_sizes, height_thresholds);
 
     std::vector<PointId> groundIdx;
     for (PointId i = 0; i < np; ++i)
@@ -176,8 +256,9 @@ std::vector<PointId> PMFFilter::processGround(PointViewPtr view)
         for (PointId i = 0; i < groundIdx.size(); ++i)
             ground->appendPoint(*view, groundIdx[i]);
 
-        printf("      Iteration %ld (height threshold = %f, window size = %f)...",
-               j, height_thresholds[j], window_sizes[j]);
+        log()->get(LogLevel::Debug) << "Iteration " << j <<
+            " (height threshold = " << height_thresholds[j] <<
+            ", window size = " << window_sizes[j] << ")\n";
 
         // Create new cloud to hold the filtered results. Apply the morphological
         // opening operation at the current window size.
@@ -200,6 +281,71 @@ std::vector<PointId> PMFFilter::processGround(PointViewPtr view)
     return groundIdx;
 }
 
+// Approximate the progressive morphological filter on a raster of the
+// minimum Z of the points in each cell.  Each iteration opens the raster
+// produced by the previous one, and points remain ground if they are near
+// the opened surface of their cell.
+std::vector<PointId> PMFFilter::processGroundApprox(PointViewPtr view)
+{
+    point_count_t np(view->size());
+
+    std::vector<float> height_thresholds;
+    std::vector<float> window_sizes;
+    computeThresholds(window_sizes, height_thresholds);
+
+    BOX2D bounds;
+    view->calculateBounds(bounds);
+    double dcols = std::floor((bounds.maxx - bounds.minx) / m_cellSize) + 1;
+    double drows = std::floor((bounds.maxy - bounds.miny) / m_cellSize) + 1;
+    if (!(dcols * drows <= MaxRasterCells))
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Raster of " << dcols << " x " << drows <<
+            " cells is too large for the approximate algorithm.  "
+            "Increase 'cell_size'.";
+        throw pdal_error(oss.str());
+    }
+    size_t cols = (size_t)dcols;
+    size_t rows = (size_t)drows;
+
+    std::vector<double> z(np);
+    std::vector<size_t> cells(np);
+    std::vector<double> raster(cols * rows,
+        (std::numeric_limits<double>::max)());
+    for (PointId i = 0; i < np; ++i)
+    {
+        double x = view->getFieldAs<double>(Dimension::Id::X, i);
+        double y = view->getFieldAs<double>(Dimension::Id::Y, i);
+        size_t c = (size_t)((x - bounds.minx) / m_cellSize);
+        size_t r = (size_t)((y - bounds.miny) / m_cellSize);
+        cells[i] = (std::min)(r, rows - 1) * cols + (std::min)(c, cols - 1);
+        z[i] = view->getFieldAs<double>(Dimension::Id::Z, i);
+        raster[cells[i]] = (std::min)(raster[cells[i]], z[i]);
+    }
+
+    std::vector<PointId> groundIdx;
+    for (PointId i = 0; i < np; ++i)
+        groundIdx.push_back(i);
+
+    for (size_t j = 0; j < window_sizes.size(); ++j)
+    {
+        log()->get(LogLevel::Debug) << "Iteration " << j <<
+            " (height threshold = " << height_thresholds[j] <<
+            ", window size = " << window_sizes[j] << ")\n";
+
+        size_t h = (size_t)(window_sizes[j] / m_cellSize) / 2;
+        morphOpen(raster, cols, rows, h);
+
+        std::vector<PointId> pt_indices;
+        for (auto const& i : groundIdx)
+            if (z[i] - raster[cells[i]] < height_thresholds[j])
+                pt_indices.push_back(i);
+        groundIdx.swap(pt_indices);
+    }
+
+    return groundIdx;
+}
+
 PointViewSet PMFFilter::run(PointViewPtr input)
 {
     bool logOutput = log()->getLevel() > LogLevel::Debug1;
@@ -207,7 +353,8 @@ PointViewSet PMFFilter::run(PointViewPtr input)
         log()->floatPrecision(8);
     log()->get(LogLevel::Debug2) << "Process PMFFilter...\n";
 
-    auto idx = processGround(input);
+    auto idx = m_approximate ? processGroundApprox(input) :
+        processGround(input);
 
     PointViewSet viewSet;
     if (!idx.empty() && (m_classify || m_extract))
@@ -75,7 +75,12 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void processOptions(const Options& options);
     std::vector<double> morphOpen(PointViewPtr view, float radius);
+    void morphOpen(std::vector<double>& raster, size_t cols, size_t rows,
+        size_t h);
+    void computeThresholds(std::vector<float>& window_sizes,
+        std::vector<float>& height_thresholds);
     std::vector<PointId> processGround(PointViewPtr view);
+    std::vector<PointId> processGroundApprox(PointViewPtr view);
     virtual PointViewSet run(PointViewPtr view);
 
     PMFFilter& operator=(const PMFFilter&); // not implemented
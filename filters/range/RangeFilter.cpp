@@ -224,6 +224,33 @@ bool RangeFilter::processOne(PointRef& point)
 }
 
 
+// Evaluate the ranges a dimension at a time.  As in processOne(), a point
+// passes if it's within any of the ranges of each dimension.
+point_count_t RangeFilter::processBatch(PointRef& point, point_count_t count,
+    std::vector<uint8_t>& skips)
+{
+    const PointId begin = point.pointId();
+    std::vector<double> values(count);
+    std::vector<uint8_t> passes(count);
+
+    auto r = m_range_list.begin();
+    while (r != m_range_list.end())
+    {
+        Dimension::Id::Enum id = r->m_id;
+        point.getFieldsAs(id, count, values.data());
+        std::fill(passes.begin(), passes.end(), 0);
+        for (; r != m_range_list.end() && r->m_id == id; ++r)
+            for (PointId i = 0; i < count; ++i)
+                if (!passes[i])
+                    passes[i] = dimensionPasses(values[i], *r);
+        for (PointId i = 0; i < count; ++i)
+            if (!passes[i])
+                skips[begin + i] = 1;
+    }
+    return count;
+}
+
+
 PointViewSet RangeFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
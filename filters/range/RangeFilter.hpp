@@ -94,7 +94,11 @@ private:
     virtual void processOptions(const Options&options);
     virtual void prepared(PointTableRef table);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(PointRef& point, point_count_t count,
+        std::vector<uint8_t>& skips);
     virtual PointViewSet run(PointViewPtr view);
+    virtual bool threadSafe() const
+        { return true; }
     bool dimensionPasses(double v, const Range& r) const;
 
     RangeFilter& operator=(const RangeFilter&); // not implemented
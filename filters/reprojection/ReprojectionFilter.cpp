@@ -37,10 +37,12 @@
 #include <pdal/PointView.hpp>
 #include <pdal/pdal_macros.hpp>
 #include <pdal/GDALUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <gdal.h>
 #include <ogr_spatialref.h>
 
+#include <algorithm>
 #include <memory>
 
 namespace pdal
@@ -65,8 +67,7 @@ ReprojectionFilter::ReprojectionFilter()
 
 ReprojectionFilter::~ReprojectionFilter()
 {
-    if (m_transform_ptr)
-        OCTDestroyCoordinateTransformation(m_transform_ptr);
+    destroyTransforms();
     if (m_in_ref_ptr)
         OSRDestroySpatialReference(m_in_ref_ptr);
     if (m_out_ref_ptr)
@@ -172,8 +173,7 @@ void ReprojectionFilter::createTransform(const SpatialReference& srsSRS)
             "in the source file.";
         throw pdal_error(oss.str());
     }
-    if (m_transform_ptr)
-        OCTDestroyCoordinateTransformation(m_transform_ptr);
+    destroyTransforms();
     m_transform_ptr = OCTNewCoordinateTransformation(m_in_ref_ptr,
         m_out_ref_ptr);
     if (!m_transform_ptr)
@@ -182,6 +182,68 @@ void ReprojectionFilter::createTransform(const SpatialReference& srsSRS)
         oss << getName() << ": Could not construct coordinate transformation object in createTransform";
         throw pdal_error(oss.str());
     }
+
+    size_t threads = numThreads();
+    if (threads > 1)
+    {
+        for (size_t i = 1; i < threads; ++i)
+        {
+            TransformPtr t = OCTNewCoordinateTransformation(m_in_ref_ptr,
+                m_out_ref_ptr);
+            if (!t)
+            {
+                std::ostringstream oss;
+                oss << getName() << ": Could not construct coordinate transformation object in createTransform";
+                throw pdal_error(oss.str());
+            }
+            m_threadTransforms.push_back(t);
+        }
+        m_pool.reset(new ThreadPool(threads));
+    }
+}
+
+
+void ReprojectionFilter::destroyTransforms()
+{
+    m_pool.reset();
+    for (TransformPtr t : m_threadTransforms)
+        OCTDestroyCoordinateTransformation(t);
+    m_threadTransforms.clear();
+    if (m_transform_ptr)
+        OCTDestroyCoordinateTransformation(m_transform_ptr);
+    m_transform_ptr = NULL;
+}
+
+
+// Transform the coordinates of a number of points in place.  The points
+// are split among the threads, each of which uses its own transformation.
+// Points that can't be transformed have their success flag cleared.
+void ReprojectionFilter::transform(point_count_t count, double *x, double *y,
+    double *z, int *success)
+{
+    const point_count_t minChunk = 1024;
+
+    size_t chunks = m_threadTransforms.size() + 1;
+    chunks = (size_t)(std::min)((point_count_t)chunks,
+        (count + minChunk - 1) / minChunk);
+    if (chunks <= 1)
+    {
+        OCTTransformEx(m_transform_ptr, (int)count, x, y, z, success);
+        return;
+    }
+
+    point_count_t chunkSize = (count + chunks - 1) / chunks;
+    for (size_t i = 0; i < chunks; ++i)
+    {
+        TransformPtr t = i ? m_threadTransforms[i - 1] : m_transform_ptr;
+        point_count_t b = i * chunkSize;
+        point_count_t n = (std::min)(chunkSize, count - b);
+        m_pool->add([t, b, n, x, y, z, success]()
+        {
+            OCTTransformEx(t, (int)n, x + b, y + b, z + b, success + b);
+        });
+    }
+    m_pool->join();
 }
 
 PointViewSet ReprojectionFilter::run(PointViewPtr view)
@@ -191,12 +253,41 @@ PointViewSet ReprojectionFilter::run(PointViewPtr view)
 
     createTransform(view->spatialReference());
 
-    PointRef point(*view, 0);
-    for (PointId id = 0; id < view->size(); ++id)
+    // Points are transformed a block at a time.  Points that can't be
+    // transformed keep their original values and are left out of the
+    // output view.
+    const point_count_t blockSize = 65536;
+    point_count_t np = view->size();
+    point_count_t bufSize = (std::min)(np, blockSize);
+    std::vector<double> x(bufSize);
+    std::vector<double> y(bufSize);
+    std::vector<double> z(bufSize);
+    std::vector<int> success(bufSize);
+    for (PointId begin = 0; begin < np; begin += blockSize)
     {
-        point.setPointId(id);
-        if (processOne(point))
-            outView->appendPoint(*view, id);
+        PointId end = (std::min)(begin + blockSize, np);
+        point_count_t count = end - begin;
+        view->getFieldsAs(Dimension::Id::X, begin, end, x.data());
+        view->getFieldsAs(Dimension::Id::Y, begin, end, y.data());
+        view->getFieldsAs(Dimension::Id::Z, begin, end, z.data());
+
+        transform(count, x.data(), y.data(), z.data(), success.data());
+
+        for (PointId i = 0; i < count; ++i)
+        {
+            if (success[i])
+                continue;
+            x[i] = view->getFieldAs<double>(Dimension::Id::X, begin + i);
+            y[i] = view->getFieldAs<double>(Dimension::Id::Y, begin + i);
+            z[i] = view->getFieldAs<double>(Dimension::Id::Z, begin + i);
+        }
+        view->setFields(Dimension::Id::X, begin, end, x.data());
+        view->setFields(Dimension::Id::Y, begin, end, y.data());
+        view->setFields(Dimension::Id::Z, begin, end, z.data());
+
+        for (PointId i = 0; i < count; ++i)
+            if (success[i])
+                outView->appendPoint(*view, begin + i);
     }
 
     viewSet.insert(outView);
@@ -227,4 +318,42 @@ bool ReprojectionFilter::processOne(PointRef& point)
     }
 }
 
+
+point_count_t ReprojectionFilter::processBatch(PointRef& point,
+    point_count_t count, std::vector<uint8_t>& skips)
+{
+    const PointId begin = point.pointId();
+    std::vector<double> x(count);
+    std::vector<double> y(count);
+    std::vector<double> z(count);
+    std::vector<int> success(count);
+
+    point.getFieldsAs(Dimension::Id::X, count, x.data());
+    point.getFieldsAs(Dimension::Id::Y, count, y.data());
+    point.getFieldsAs(Dimension::Id::Z, count, z.data());
+
+    transform(count, x.data(), y.data(), z.data(), success.data());
+
+    // Points that were skipped or couldn't be transformed keep their
+    // original values.  Points that couldn't be transformed are filtered
+    // out.
+    for (PointId i = 0; i < count; ++i)
+    {
+        if (success[i] && !skips[begin + i])
+            continue;
+        if (!success[i])
+            skips[begin + i] = 1;
+        point.setPointId(begin + i);
+        x[i] = point.getFieldAs<double>(Dimension::Id::X);
+        y[i] = point.getFieldAs<double>(Dimension::Id::Y);
+        z[i] = point.getFieldAs<double>(Dimension::Id::Z);
+    }
+
+    point.setPointId(begin);
+    point.setFields(Dimension::Id::X, count, x.data());
+    point.setFields(Dimension::Id::Y, count, y.data());
+    point.setFields(Dimension::Id::Z, count, z.data());
+    return count;
+}
+
 } // namespace pdal
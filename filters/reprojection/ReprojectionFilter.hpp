@@ -38,6 +38,7 @@
 #include <pdal/Filter.hpp>
 
 #include <memory>
+#include <vector>
 
 extern "C" int32_t ReprojectionFilter_ExitFunc();
 extern "C" PF_ExitFunc ReprojectionFilter_InitPlugin();
@@ -50,6 +51,8 @@ namespace gdal
     class ErrorHandler;
 }
 
+class ThreadPool;
+
 class PDAL_DLL ReprojectionFilter : public Filter
 {
 public:
@@ -66,9 +69,14 @@ private:
     virtual void ready(PointTableRef table);
     virtual PointViewSet run(PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(PointRef& point, point_count_t count,
+        std::vector<uint8_t>& skips);
 
     void updateBounds();
     void createTransform(const SpatialReference& srs);
+    void destroyTransforms();
+    void transform(point_count_t count, double *x, double *y, double *z,
+        int *success);
 
     SpatialReference m_inSRS;
     SpatialReference m_outSRS;
@@ -79,6 +87,10 @@ private:
     ReferencePtr m_in_ref_ptr;
     ReferencePtr m_out_ref_ptr;
     TransformPtr m_transform_ptr;
+    // Additional transformations, one per extra thread, since a
+    // transformation can't be used by several threads at once.
+    std::vector<TransformPtr> m_threadTransforms;
+    std::unique_ptr<ThreadPool> m_pool;
     gdal::ErrorHandler* m_errorHandler;
 
     ReprojectionFilter& operator=(const ReprojectionFilter&); // not implemented
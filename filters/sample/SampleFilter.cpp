@@ -34,10 +34,15 @@
 
 #include "SampleFilter.hpp"
 
-#include <pdal/KDIndex.hpp>
+#include <pdal/PointRef.hpp>
 #include <pdal/util/Utils.hpp>
 #include <pdal/pdal_macros.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <limits>
+#include <random>
 #include <string>
 #include <vector>
 
@@ -60,6 +65,8 @@ Options SampleFilter::getDefaultOptions()
 {
     Options options;
     options.add("radius", 1, "Radius");
+    options.add("seed", "", "Seed for the random shuffle of the points "
+        "[default: current time]");
     return options;
 }
 
@@ -67,6 +74,11 @@ Options SampleFilter::getDefaultOptions()
 void SampleFilter::processOptions(const Options& options)
 {
     m_radius = options.getValueOrDefault<double>("radius", 1);
+    if (m_radius <= 0)
+        throw pdal_error(getName() + ": option 'radius' must be greater "
+            "than 0.");
+    m_seed = options.getValueOrDefault<uint32_t>("seed",
+        (uint32_t)std::time(NULL));
 }
 
 
@@ -76,6 +88,58 @@ void SampleFilter::addDimensions(PointLayoutPtr layout)
 }
 
 
+void SampleFilter::ready(PointTableRef)
+{
+    m_voxels.clear();
+    m_samples.clear();
+}
+
+
+// Keep the point at (x, y, z) as a sample unless it is within m_radius of
+// a sample that has already been kept.
+bool SampleFilter::accept(double x, double y, double z)
+{
+    Voxel v { (int64_t)std::floor(x / m_radius),
+        (int64_t)std::floor(y / m_radius), (int64_t)std::floor(z / m_radius) };
+    double r2 = m_radius * m_radius;
+
+    const size_t none = (std::numeric_limits<size_t>::max)();
+    for (int64_t i = v.x - 1; i <= v.x + 1; ++i)
+        for (int64_t j = v.y - 1; j <= v.y + 1; ++j)
+            for (int64_t k = v.z - 1; k <= v.z + 1; ++k)
+            {
+                auto it = m_voxels.find(Voxel { i, j, k });
+                if (it == m_voxels.end())
+                    continue;
+                for (size_t s = it->second; s != none; s = m_samples[s].next)
+                {
+                    const Sample& p = m_samples[s];
+                    double dx = p.x - x;
+                    double dy = p.y - y;
+                    double dz = p.z - z;
+                    if (dx * dx + dy * dy + dz * dz < r2)
+                        return false;
+                }
+            }
+
+    // Push the new sample onto the front of its voxel's chain.
+    auto it = m_voxels.insert(std::make_pair(v, none)).first;
+    m_samples.push_back(Sample { x, y, z, it->second });
+    it->second = m_samples.size() - 1;
+    return true;
+}
+
+
+bool SampleFilter::processOne(PointRef& point)
+{
+    // Points are sampled in the order they arrive, so only the samples
+    // need to be held in memory.
+    return accept(point.getFieldAs<double>(Dimension::Id::X),
+        point.getFieldAs<double>(Dimension::Id::Y),
+        point.getFieldAs<double>(Dimension::Id::Z));
+}
+
+
 PointViewSet SampleFilter::run(PointViewPtr inView)
 {
     point_count_t np = inView->size();
@@ -87,39 +151,24 @@ PointViewSet SampleFilter::run(PointViewPtr inView)
         return viewSet;
     PointViewPtr outView = inView->makeNew();
 
-    // Build the 3D KD-tree.
-    KD3Index index(*inView);
-    index.build();
-
     // The result looks much better if we take some time to shuffle the indices.
-    std::srand(std::time(NULL));
+    std::mt19937 generator(m_seed);
     std::vector<PointId> indices(np);
     for (PointId i = 0; i < np; ++i)
         indices[i] = i;
-    std::random_shuffle(indices.begin(), indices.end());
-
-    // All points are marked as kept (1) by default. As they are masked by
-    // neighbors within the user-specified radius, their value is changed to 0.
-    std::vector<int> keep(np, 1);
+    std::shuffle(indices.begin(), indices.end(), generator);
 
-    // We are able to subsample in a single pass over the shufflled indices.
+    // We are able to subsample in a single pass over the shuffled indices.
+    // A point is kept if no previously kept point is within m_radius of it.
+    m_voxels.clear();
+    m_samples.clear();
     for (auto const& i : indices)
     {
-        // If a point is masked, it is forever masked, and cannot be part of the
-        // sampled cloud. Otherwise, the current index is appended to the output
-        // PointView.
-        if (keep[i] == 0)
-            continue;
-        outView->appendPoint(*inView, i);
-
-        // We now proceed to mask all neighbors within m_radius of the kept
-        // point.
         double x = inView->getFieldAs<double>(Dimension::Id::X, i);
         double y = inView->getFieldAs<double>(Dimension::Id::Y, i);
         double z = inView->getFieldAs<double>(Dimension::Id::Z, i);
-        auto ids = index.radius(x, y, z, m_radius);
-        for (PointId j = 1; j < ids.size(); ++j)
-            keep[ids[j]] = 0;
+        if (accept(x, y, z))
+            outView->appendPoint(*inView, i);
     }
 
     // Simply calculate the percentage of retained points.
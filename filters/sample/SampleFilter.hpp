@@ -37,7 +37,10 @@
 #include <pdal/Filter.hpp>
 #include <pdal/plugin.hpp>
 
+#include <cstdint>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 extern "C" int32_t SampleFilter_ExitFunc();
 extern "C" PF_ExitFunc SampleFilter_InitPlugin();
@@ -60,11 +63,50 @@ public:
     Options getDefaultOptions();
 
 private:
+    // Voxels are cubes with sides of length m_radius, so a sample can only
+    // be closer than m_radius to samples in its own voxel or the 26
+    // adjacent ones.
+    struct Voxel
+    {
+        int64_t x;
+        int64_t y;
+        int64_t z;
+
+        bool operator==(const Voxel& other) const
+            { return x == other.x && y == other.y && z == other.z; }
+    };
+
+    struct VoxelHash
+    {
+        size_t operator()(const Voxel& v) const
+        {
+            // Unsigned arithmetic so that the products wrap rather than
+            // overflow.
+            return (size_t)(((uint64_t)v.x * 73856093u) ^
+                ((uint64_t)v.y * 19349663u) ^ ((uint64_t)v.z * 83492791u));
+        }
+    };
+
+    // Samples in a voxel are chained through 'next'.
+    struct Sample
+    {
+        double x;
+        double y;
+        double z;
+        size_t next;
+    };
+
     double m_radius;
+    uint32_t m_seed;
+    std::unordered_map<Voxel, size_t, VoxelHash> m_voxels;
+    std::vector<Sample> m_samples;
 
     virtual void addDimensions(PointLayoutPtr layout);
     virtual void processOptions(const Options& options);
+    virtual void ready(PointTableRef table);
+    virtual bool processOne(PointRef& point);
     virtual PointViewSet run(PointViewPtr view);
+    bool accept(double x, double y, double z);
 
     SampleFilter& operator=(const SampleFilter&); // not implemented
     SampleFilter(const SampleFilter&); // not implemented
@@ -34,6 +34,12 @@
 
 #include "SortFilter.hpp"
 #include <pdal/pdal_macros.hpp>
+#include <pdal/util/RadixSort.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
 
 namespace pdal
 {
@@ -47,5 +53,165 @@ CREATE_STATIC_PLUGIN(1, 0, SortFilter, Filter, s_info)
 
 std::string SortFilter::getName() const { return s_info.name; }
 
+
+void SortFilter::processOptions(const Options& options)
+{
+    m_dimNames = options.getValueOrThrow<StringList>("dimension");
+    if (m_dimNames.empty())
+        throw pdal_error(getName() + ": no dimension provided.");
+
+    StringList order = options.getValueOrDefault<StringList>("order",
+        StringList(1, "ASC"));
+    if (order.size() != 1 && order.size() != m_dimNames.size())
+        throw pdal_error(getName() + ": 'order' option must have one value "
+            "or one value for each dimension.");
+    for (size_t i = 0; i < m_dimNames.size(); ++i)
+    {
+        std::string o = Utils::toupper(order[order.size() == 1 ? 0 : i]);
+        if (o != "ASC" && o != "DESC")
+            throw pdal_error(getName() + ": invalid order '" + o +
+                "'.  Must be 'ASC' or 'DESC'.");
+        m_descending.push_back(o == "DESC");
+    }
+}
+
+
+void SortFilter::ready(PointTableRef table)
+{
+    // Points aren't sorted if any of the dimensions doesn't exist.
+    m_keys.clear();
+    for (size_t i = 0; i < m_dimNames.size(); ++i)
+    {
+        SortKey key { table.layout()->findDim(m_dimNames[i]),
+            m_descending[i] };
+        if (key.m_dim == Dimension::Id::Unknown)
+        {
+            m_keys.clear();
+            return;
+        }
+        m_keys.push_back(key);
+    }
+}
+
+
+namespace
+{
+
+// Fetch the values of a dimension as unsigned integers that sort in the
+// same order as the values.
+void extractKeys(const PointView& view, Dimension::Id::Enum dim,
+    PointId begin, PointId end, uint64_t *keys)
+{
+    const uint64_t signBit = 1ULL << 63;
+
+    switch (view.dimType(dim))
+    {
+    case Dimension::Type::Float:
+    case Dimension::Type::Double:
+        for (PointId i = begin; i < end; ++i)
+        {
+            double d = view.getFieldAs<double>(dim, i);
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            // Negative numbers sort in reverse order of their bits.
+            *keys++ = (bits & signBit) ? ~bits : bits | signBit;
+        }
+        break;
+    case Dimension::Type::Signed8:
+    case Dimension::Type::Signed16:
+    case Dimension::Type::Signed32:
+    case Dimension::Type::Signed64:
+        for (PointId i = begin; i < end; ++i)
+        {
+            int64_t v = 0;
+            switch (view.dimSize(dim))
+            {
+            case 1:
+                v = view.getFieldAs<int8_t>(dim, i);
+                break;
+            case 2:
+                v = view.getFieldAs<int16_t>(dim, i);
+                break;
+            case 4:
+                v = view.getFieldAs<int32_t>(dim, i);
+                break;
+            default:
+                view.getRawField(dim, i, &v);
+                break;
+            }
+            *keys++ = (uint64_t)v ^ signBit;
+        }
+        break;
+    case Dimension::Type::Unsigned8:
+    case Dimension::Type::Unsigned16:
+    case Dimension::Type::Unsigned32:
+    case Dimension::Type::Unsigned64:
+        for (PointId i = begin; i < end; ++i)
+        {
+            uint64_t v = 0;
+            if (view.dimSize(dim) == 8)
+                view.getRawField(dim, i, &v);
+            else
+                v = view.getFieldAs<uint32_t>(dim, i);
+            *keys++ = v;
+        }
+        break;
+    case Dimension::Type::None:
+        break;
+    }
+}
+
+} // unnamed namespace
+
+
+// Sort on the least significant key first.  The radix sort is stable, so
+// each following sort keeps the order of points whose more significant
+// keys are equal.  The view's index is reordered once at the end.
+void SortFilter::filter(PointView& view)
+{
+    if (m_keys.empty() || view.size() < 2)
+        return;
+
+    const point_count_t size = view.size();
+    const point_count_t blockSize = 65536;
+    const std::size_t threads = numThreads();
+    std::unique_ptr<ThreadPool> pool;
+    if (threads > 1)
+        pool.reset(new ThreadPool(threads));
+
+    std::vector<uint64_t> order(size);
+    for (PointId i = 0; i < size; ++i)
+        order[i] = i;
+
+    std::vector<uint64_t> values(size);
+    std::vector<uint64_t> keys(size);
+    for (auto ki = m_keys.rbegin(); ki != m_keys.rend(); ++ki)
+    {
+        const SortKey& key = *ki;
+        auto extract = [&view, &key, &values, size, blockSize](PointId begin)
+        {
+            PointId end = (std::min)(begin + blockSize, size);
+            extractKeys(view, key.m_dim, begin, end, values.data() + begin);
+            if (key.m_descending)
+                for (PointId i = begin; i < end; ++i)
+                    values[i] = ~values[i];
+        };
+        for (PointId begin = 0; begin < size; begin += blockSize)
+            if (pool)
+                pool->add([&extract, begin](){ extract(begin); });
+            else
+                extract(begin);
+        if (pool)
+            pool->join();
+
+        // Arrange the keys in the current order of the points.
+        for (PointId i = 0; i < size; ++i)
+            keys[i] = values[order[i]];
+        Utils::radixSort(keys, order, threads);
+    }
+
+    view.reorder(std::vector<PointId>(order.begin(), order.end()));
+}
+
 } // namespace pdal
 
@@ -35,7 +35,6 @@
 #pragma once
 
 #include <pdal/Filter.hpp>
-#include <pdal/PointViewIter.hpp>
 #include <pdal/plugin.hpp>
 
 extern "C" int32_t SortFilter_ExitFunc();
@@ -55,27 +54,25 @@ public:
     std::string getName() const;
 
 private:
-    // Dimension on which to sort.
-    Dimension::Id::Enum m_dim;
-    // Dimension name.
-    std::string m_dimName;
-
-    virtual void processOptions(const Options& options)
-        { m_dimName = options.getValueOrThrow<std::string>("dimension"); }
-
-    virtual void ready(PointTableRef table)
-        { m_dim = table.layout()->findDim(m_dimName); }
-
-    virtual void filter(PointView& view)
+    struct SortKey
     {
-        if (m_dim == Dimension::Id::Unknown)
-            return;
+        Dimension::Id::Enum m_dim;
+        bool m_descending;
+    };
+
+    // Names of the dimensions on which to sort, most significant first.
+    StringList m_dimNames;
+    // Sort order of each dimension.
+    std::vector<bool> m_descending;
+    // Keys on which to sort.
+    std::vector<SortKey> m_keys;
 
-        auto cmp = [this](const PointIdxRef& p1, const PointIdxRef& p2)
-            { return p1.compare(m_dim, p2); };
+    virtual void processOptions(const Options& options);
+    virtual void ready(PointTableRef table);
+    virtual void filter(PointView& view);
 
-        std::sort(view.begin(), view.end(), cmp);
-    }
+    virtual bool threadSafe() const
+        { return true; }
 
     SortFilter& operator=(const SortFilter&); // not implemented
     SortFilter(const SortFilter&); // not implemented
@@ -36,9 +36,11 @@
 
 #include <pdal/pdal_macros.hpp>
 
+#include <algorithm>
 #include <cmath>
-#include <iostream>
 #include <limits>
+#include <unordered_map>
+#include <vector>
 
 namespace pdal
 {
@@ -72,59 +74,60 @@ Options SplitterFilter::getDefaultOptions()
 }
 
 
-//This used to be a lambda, but the VS compiler exploded, I guess.
-typedef std::pair<int, int> Coord;
-namespace
-{
-class CoordCompare
-{
-public:
-    bool operator () (const Coord& c1, const Coord& c2) const
-    {
-        return c1.first < c2.first ? true :
-            c1.first > c2.first ? false :
-            c1.second < c2.second ? true :
-            false;
-    };
-};
-}
-
 PointViewSet SplitterFilter::run(PointViewPtr inView)
 {
     PointViewSet viewSet;
     if (!inView->size())
         return viewSet;
 
-    CoordCompare compare;
-    std::map<Coord, PointViewPtr, CoordCompare> viewMap(compare);
-
     // Use the location of the first point as the origin, unless specified.
     // (!= test == isnan(), which doesn't exist on windows)
     if (m_xOrigin != m_xOrigin)
         m_xOrigin = inView->getFieldAs<double>(Dimension::Id::X, 0);
     if (m_yOrigin != m_yOrigin)
         m_yOrigin = inView->getFieldAs<double>(Dimension::Id::Y, 0);
+
     // Overlay a grid of squares on the points (m_length sides).  Each square
-    // corresponds to a new point buffer.  Place the points falling in the
-    // each square in the corresponding point buffer.
-    for (PointId idx = 0; idx < inView->size(); idx++)
+    // corresponds to a new point view.  The first pass numbers the squares
+    // in the order they're first seen and counts the points that fall in
+    // each.  The second pass places the points in views sized to fit.
+    const point_count_t count = inView->size();
+    const point_count_t blockSize = 4096;
+    std::unordered_map<uint64_t, uint32_t> cellMap;
+    std::vector<uint32_t> cells(count);
+    std::vector<point_count_t> cellCounts;
+    std::vector<double> x(blockSize);
+    std::vector<double> y(blockSize);
+    for (PointId begin = 0; begin < count; begin += blockSize)
+    {
+        PointId end = (std::min)(begin + blockSize, count);
+        inView->getFieldsAs(Dimension::Id::X, begin, end, x.data());
+        inView->getFieldsAs(Dimension::Id::Y, begin, end, y.data());
+        for (PointId idx = begin; idx < end; ++idx)
+        {
+            uint64_t key = cellKey(x[idx - begin], y[idx - begin],
+                m_xOrigin, m_yOrigin, m_length);
+            auto it = cellMap.insert(
+                std::make_pair(key, (uint32_t)cellCounts.size()));
+            if (it.second)
+                cellCounts.push_back(0);
+            uint32_t cell = it.first->second;
+            cells[idx] = cell;
+            cellCounts[cell]++;
+        }
+    }
+
+    std::vector<PointViewPtr> views(cellCounts.size());
+    for (size_t cell = 0; cell < views.size(); ++cell)
     {
-        double x = inView->getFieldAs<double>(Dimension::Id::X, idx);
-        int xpos = (x - m_xOrigin) / m_length;
-        double y = inView->getFieldAs<double>(Dimension::Id::Y, idx);
-        int ypos = (y - m_yOrigin) / m_length;
-
-        Coord loc(xpos, ypos);
-        PointViewPtr& outView = viewMap[loc];
-        if (!outView)
-            outView = inView->makeNew();
-        outView->appendPoint(*inView.get(), idx);
+        views[cell] = inView->makeNew();
+        views[cell]->reserve(cellCounts[cell]);
     }
+    for (PointId idx = 0; idx < count; ++idx)
+        views[cells[idx]]->appendPoint(*inView, idx);
 
-    // Pull the buffers out of the map and stick them in the standard
-    // output set, setting the bounds as we go.
-    for (auto bi = viewMap.begin(); bi != viewMap.end(); ++bi)
-        viewSet.insert(bi->second);
+    for (auto& v : views)
+        viewSet.insert(v);
     return viewSet;
 }
 
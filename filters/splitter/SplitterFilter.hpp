@@ -55,6 +55,22 @@ public:
 
     Options getDefaultOptions();
 
+    /// Key of the grid cell that contains a point.  Cell indices are the
+    /// truncated offsets from the origin in units of the cell length,
+    /// packed as two 32-bit signed values (X in the high half).
+    /// \param x  X coordinate of the point.
+    /// \param y  Y coordinate of the point.
+    /// \param xOrigin  X origin of the grid.
+    /// \param yOrigin  Y origin of the grid.
+    /// \param length  Length of the sides of a cell.
+    static uint64_t cellKey(double x, double y, double xOrigin,
+        double yOrigin, double length)
+    {
+        int64_t xpos = (int64_t)((x - xOrigin) / length);
+        int64_t ypos = (int64_t)((y - yOrigin) / length);
+        return ((uint64_t)(uint32_t)xpos << 32) | (uint32_t)ypos;
+    }
+
 private:
     double m_length;
     double m_xOrigin;
@@ -34,6 +34,7 @@
 
 #include "StatsFilter.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <unordered_map>
 
@@ -42,6 +43,7 @@
 #include <pdal/Polygon.hpp>
 #include <pdal/PDALUtils.hpp>
 #include <pdal/pdal_macros.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -58,6 +60,149 @@ std::string StatsFilter::getName() const { return s_info.name; }
 namespace stats
 {
 
+void QuantileSketch::compress(size_t level)
+{
+    for (; level < m_levels.size() && m_levels[level].size() >= m_capacity;
+        ++level)
+    {
+        if (level + 1 == m_levels.size())
+            m_levels.resize(level + 2);
+        std::vector<double>& values = m_levels[level];
+        std::vector<double>& next = m_levels[level + 1];
+
+        // Promote every other sorted value, alternating between the even
+        // and odd ones so that the estimates aren't biased.  An odd value
+        // out stays on this level.
+        std::sort(values.begin(), values.end());
+        bool odd = values.size() % 2;
+        double leftover = values.back();
+        if (odd)
+            values.pop_back();
+        for (size_t i = m_offset; i < values.size(); i += 2)
+            next.push_back(values[i]);
+        m_offset = 1 - m_offset;
+        values.clear();
+        if (odd)
+            values.push_back(leftover);
+    }
+}
+
+
+void QuantileSketch::merge(const QuantileSketch& other)
+{
+    if (m_levels.size() < other.m_levels.size())
+        m_levels.resize(other.m_levels.size());
+    for (size_t level = 0; level < other.m_levels.size(); ++level)
+        m_levels[level].insert(m_levels[level].end(),
+            other.m_levels[level].begin(), other.m_levels[level].end());
+    m_count += other.m_count;
+    for (size_t level = 0; level < m_levels.size(); ++level)
+        compress(level);
+}
+
+
+// Return the values of the sketch in order along with the number of
+// values that each stands for.
+QuantileSketch::WeightedValues QuantileSketch::weightedValues() const
+{
+    WeightedValues values;
+    for (size_t level = 0; level < m_levels.size(); ++level)
+        for (double v : m_levels[level])
+            values.push_back(std::make_pair(v, point_count_t(1) << level));
+    std::sort(values.begin(), values.end());
+    return values;
+}
+
+
+double QuantileSketch::quantile(double q) const
+{
+    if (m_count == 0)
+        return std::numeric_limits<double>::quiet_NaN();
+
+    WeightedValues values = weightedValues();
+    double target = q * m_count;
+    point_count_t cumulative = 0;
+    for (auto& v : values)
+    {
+        cumulative += v.second;
+        if (cumulative >= target)
+            return v.first;
+    }
+    return values.back().first;
+}
+
+
+std::vector<point_count_t> QuantileSketch::histogram(double minimum,
+    double maximum, size_t bins) const
+{
+    std::vector<point_count_t> counts(bins);
+    if (bins == 0 || m_count == 0)
+        return counts;
+
+    double width = (maximum - minimum) / bins;
+    for (auto& v : weightedValues())
+    {
+        size_t bin = (width > 0) ? (size_t)((v.first - minimum) / width) : 0;
+        counts[(std::min)(bin, bins - 1)] += v.second;
+    }
+    return counts;
+}
+
+
+double Summary::quantile(double q) const
+{
+    return m_sketchValues.quantile(q);
+}
+
+
+void Summary::merge(const Summary& s)
+{
+    if (s.m_cnt == 0)
+        return;
+
+    m_min = (std::min)(m_min, s.m_min);
+    m_max = (std::max)(m_max, s.m_max);
+    for (auto& v : s.m_values)
+        m_values[v.first] += v.second;
+    m_sketchValues.merge(s.m_sketchValues);
+
+    if (m_cnt == 0)
+    {
+        m_cnt = s.m_cnt;
+        m_avg = s.m_avg;
+        M1 = s.M1;
+        M2 = s.M2;
+        M3 = s.M3;
+        M4 = s.M4;
+        return;
+    }
+
+    // Pairwise update of the central moments from Pebay, "Formulas for
+    // Robust, One-Pass Parallel Computation of Covariances and
+    // Arbitrary-Order Statistical Moments", SAND2008-6212.
+    double na = (double)m_cnt;
+    double nb = (double)s.m_cnt;
+    double n = na + nb;
+    double delta = s.M1 - M1;
+    double delta2 = delta * delta;
+    double delta3 = delta2 * delta;
+    double delta4 = delta2 * delta2;
+
+    double m4 = M4 + s.M4 +
+        delta4 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n) +
+        6 * delta2 * (na * na * s.M2 + nb * nb * M2) / (n * n) +
+        4 * delta * (na * s.M3 - nb * M3) / n;
+    double m3 = M3 + s.M3 + delta3 * na * nb * (na - nb) / (n * n) +
+        3 * delta * (na * s.M2 - nb * M2) / n;
+    M2 += s.M2 + delta2 * na * nb / n;
+    M3 = m3;
+    M4 = m4;
+    M1 += delta * nb / n;
+    m_avg += (s.m_avg - m_avg) * nb / n;
+    m_cnt += s.m_cnt;
+}
+
+
 void Summary::extractMetadata(MetadataNode &m) const
 {
     uint32_t cnt = static_cast<uint32_t>(count());
@@ -110,19 +255,84 @@ bool StatsFilter::processOne(PointRef& point)
 }
 
 
+point_count_t StatsFilter::processBatch(PointRef& point,
+    point_count_t count, std::vector<uint8_t>& skips)
+{
+    const PointId begin = point.pointId();
+    std::vector<double> values(count);
+
+    for (auto p = m_stats.begin(); p != m_stats.end(); ++p)
+    {
+        Summary& c = p->second;
+        point.getFieldsAs(p->first, count, values.data());
+        for (PointId i = 0; i < count; ++i)
+            if (!skips[begin + i])
+                c.insert(values[i]);
+    }
+    return count;
+}
+
+
 void StatsFilter::filter(PointView& view)
 {
-    PointRef point(view, 0);
-    for (PointId idx = 0; idx < view.size(); ++idx)
+    const point_count_t blockSize = 4096;
+
+    // Each thread summarizes a contiguous range of blocks of points.  The
+    // partial summaries are merged in point order.
+    point_count_t numBlocks = (view.size() + blockSize - 1) / blockSize;
+    std::size_t threads = (std::max)(std::size_t(1),
+        (std::min)(numThreads(), (std::size_t)numBlocks));
+    point_count_t chunk = ((numBlocks + threads - 1) / threads) * blockSize;
+
+    SummaryMap empty(m_stats);
+    for (auto& p : empty)
+        p.second.reset();
+    std::vector<SummaryMap> partials(threads, empty);
+
+    auto summarize = [&view, &partials, chunk, blockSize](std::size_t t)
+    {
+        std::vector<double> values(blockSize);
+        PointId first = (std::min)((PointId)(t * chunk), view.size());
+        PointId last = (std::min)(first + chunk, view.size());
+
+        // Fetch the values of each dimension a block at a time.
+        for (PointId begin = first; begin < last; begin += blockSize)
+        {
+            PointId end = (std::min)(begin + blockSize, last);
+            for (auto p = partials[t].begin(); p != partials[t].end(); ++p)
+            {
+                Summary& c = p->second;
+                view.getFieldsAs(p->first, begin, end, values.data());
+                for (PointId i = 0; i < end - begin; ++i)
+                    c.insert(values[i]);
+            }
+        }
+    };
+
+    if (threads == 1)
+        summarize(0);
+    else
     {
-        point.setPointId(idx);
-        processOne(point);
+        ThreadPool pool(threads);
+        for (std::size_t t = 0; t < threads; ++t)
+            pool.add([&summarize, t](){ summarize(t); });
+        pool.join();
+        for (std::size_t t = 1; t < threads; ++t)
+            for (auto& p : partials[0])
+                p.second.merge(partials[t].find(p.first)->second);
     }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_viewStats[view.id()] = std::move(partials[0]);
 }
 
 
 void StatsFilter::done(PointTableRef table)
 {
+    for (auto& v : m_viewStats)
+        for (auto& p : m_stats)
+            p.second.merge(v.second.find(p.first)->second);
+    m_viewStats.clear();
     extractMetadata(table);
 }
 
@@ -132,6 +342,18 @@ void StatsFilter::processOptions(const Options& options)
     m_dimNames = options.getValueOrDefault<StringList>("dimensions");
     m_enums = options.getValueOrDefault<StringList>("enumerate");
     m_counts = options.getValueOrDefault<StringList>("count");
+    m_median = options.getValueOrDefault<bool>("median", false);
+    m_bins = options.getValueOrDefault<uint32_t>("bins", 0);
+
+    StringList quantiles = options.getValueOrDefault<StringList>("quantiles");
+    for (auto& s : quantiles)
+    {
+        double q;
+        if (!Utils::fromString(s, q) || q < 0 || q > 1)
+            throw pdal_error(getName() + ": invalid quantile '" + s +
+                "'.  Quantiles must be between 0 and 1.");
+        m_quantiles.push_back(q);
+    }
 }
 
 
@@ -180,9 +402,10 @@ void StatsFilter::prepared(PointTableRef table)
     }
 
     // Create the summary objects.
+    bool sketch = m_median || m_quantiles.size() || m_bins;
     for (auto& dv : dims)
         m_stats.insert(std::make_pair(layout->findDim(dv.first),
-            Summary(dv.first, dv.second)));
+            Summary(dv.first, dv.second, sketch)));
 }
 
 
@@ -200,6 +423,19 @@ void StatsFilter::extractMetadata(PointTableRef table)
         MetadataNode t = m_metadata.addList("statistic");
         t.add("position", position++);
         s.extractMetadata(t);
+        if (!s.count())
+            continue;
+        if (m_median)
+            t.add("median", s.median(), "approximate median");
+        for (double q : m_quantiles)
+        {
+            MetadataNode qn = t.addList("quantiles");
+            qn.add("fraction", q);
+            qn.add("value", s.quantile(q), "approximate quantile");
+        }
+        if (m_bins)
+            for (point_count_t c : s.histogram(m_bins))
+                t.addList("histogram", c);
     }
 
     // If we have X, Y, & Z dims, output bboxes
@@ -37,6 +37,9 @@
 #include <pdal/Filter.hpp>
 #include <pdal/plugin.hpp>
 
+#include <map>
+#include <mutex>
+
 extern "C" int32_t StatsFilter_ExitFunc();
 extern "C" PF_ExitFunc StatsFilter_InitPlugin();
 
@@ -45,6 +48,53 @@ namespace pdal
 namespace stats
 {
 
+// A mergeable sketch of a set of values from which approximate quantiles
+// can be computed.  Values are kept in levels.  When a level fills, it's
+// sorted and every other value is promoted to the next level, where each
+// value stands for twice as many values as on the level below.  The error
+// in the rank of an estimated quantile is roughly
+// count * log2(count / capacity) / capacity.
+class PDAL_DLL QuantileSketch
+{
+public:
+    QuantileSketch(size_t capacity = 256) : m_capacity(capacity),
+        m_count(0), m_offset(0)
+    {}
+
+    void insert(double value)
+    {
+        if (m_levels.empty())
+            m_levels.resize(1);
+        m_levels[0].push_back(value);
+        m_count++;
+        if (m_levels[0].size() >= m_capacity)
+            compress(0);
+    }
+
+    void merge(const QuantileSketch& other);
+    double quantile(double q) const;
+    std::vector<point_count_t> histogram(double minimum, double maximum,
+        size_t bins) const;
+    point_count_t count() const
+        { return m_count; }
+    void clear()
+    {
+        m_levels.clear();
+        m_count = 0;
+    }
+
+private:
+    typedef std::vector<std::pair<double, point_count_t>> WeightedValues;
+
+    void compress(size_t level);
+    WeightedValues weightedValues() const;
+
+    size_t m_capacity;
+    point_count_t m_count;
+    int m_offset;
+    std::vector<std::vector<double>> m_levels;
+};
+
 class PDAL_DLL Summary
 {
 public:
@@ -58,8 +108,8 @@ public:
 typedef std::map<double, point_count_t> EnumMap;
 
 public:
-    Summary(std::string name, EnumType enumerate) :
-        m_name(name), m_enumerate(enumerate)
+    Summary(std::string name, EnumType enumerate, bool sketch = false) :
+        m_name(name), m_enumerate(enumerate), m_sketch(sketch)
     { reset(); }
 
     double minimum() const
@@ -82,6 +132,18 @@ public:
         { return m_name; }
     const EnumMap& values() const
         { return m_values; }
+    bool sketched() const
+        { return m_sketch; }
+    // Approximate quantile.  Only available if the summary was created
+    // with a sketch.
+    double quantile(double q) const;
+    double median() const
+        { return quantile(.5); }
+    // Approximate number of values in each of 'bins' equal ranges
+    // between the minimum and maximum.  Only available if the summary was
+    // created with a sketch.
+    std::vector<point_count_t> histogram(size_t bins) const
+        { return m_sketchValues.histogram(m_min, m_max, bins); }
 
     void extractMetadata(MetadataNode &m) const;
 
@@ -92,8 +154,15 @@ public:
         m_cnt = 0;
         m_avg = 0.0;
         M1 = M2 = M3 = M4 = 0.0;
+        m_values.clear();
+        m_sketchValues.clear();
     }
 
+    // Combine the values summarized by another summary with those of this
+    // one.  The result is the same as if the values had been inserted
+    // into this summary, up to rounding.
+    void merge(const Summary& s);
+
     void insert(double value)
     {
         double delta, delta_n, delta_n2, term1;
@@ -107,10 +176,11 @@ public:
         m_avg += (value - m_avg) / m_cnt;
         if (m_enumerate != NoEnum)
             m_values[value]++;
+        if (m_sketch)
+            m_sketchValues.insert(value);
 
         // stolen from http://www.johndcook.com/blog/skewness_kurtosis/
 
-        n1 = n;
         delta = value - M1;
         delta_n = delta / n;
         delta_n2 = delta_n * delta_n;
@@ -128,6 +198,8 @@ private:
     double m_min;
     double m_avg;
     EnumMap m_values;
+    bool m_sketch;
+    QuantileSketch m_sketchValues;
     point_count_t m_cnt;
     double M1, M2, M3, M4;
 };
@@ -139,7 +211,7 @@ private:
 class PDAL_DLL StatsFilter : public Filter
 {
 public:
-    StatsFilter() : Filter()
+    StatsFilter() : Filter(), m_median(false), m_bins(0)
         {}
 
     static void * create();
@@ -154,15 +226,28 @@ private:
     StatsFilter(const StatsFilter&); // not implemented
     virtual void processOptions(const Options& options);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(PointRef& point, point_count_t count,
+        std::vector<uint8_t>& skips);
     virtual void prepared(PointTableRef table);
     virtual void done(PointTableRef table);
     virtual void filter(PointView& view);
+    virtual bool threadSafe() const
+        { return true; }
     void extractMetadata(PointTableRef table);
 
+    typedef std::map<Dimension::Id::Enum, stats::Summary> SummaryMap;
+
     StringList m_dimNames;
     StringList m_enums;
     StringList m_counts;
-    std::map<Dimension::Id::Enum, stats::Summary> m_stats;
+    bool m_median;
+    std::vector<double> m_quantiles;
+    size_t m_bins;
+    SummaryMap m_stats;
+    // Summaries of the views run in standard mode, keyed by view ID so
+    // that they're merged in a consistent order.
+    std::map<int, SummaryMap> m_viewStats;
+    std::mutex m_mutex;
 };
 
 } // namespace pdal
@@ -71,6 +71,8 @@ private:
     virtual void processOptions(const Options& options);
     virtual bool processOne(PointRef& point);
     virtual void filter(PointView& view);
+    virtual bool threadSafe() const
+        { return true; }
 
     TransformationMatrix m_matrix;
 };
@@ -49,8 +49,12 @@
 
 #include <pdal/Dimension.hpp>
 #include <pdal/DimType.hpp>
+#include <pdal/util/IStream.hpp>
 #include <pdal/util/OStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
+#include <algorithm>
+#include <limits>
 #include <map>
 #include <vector>
 
@@ -215,12 +219,23 @@ class LazPerfVlrCompressor
     typedef laszip::factory::record_schema Schema;
 
 public:
+    /**
+      Compressor for LAZ point data.  With more than one thread, points are
+      buffered and whole chunks are compressed concurrently.  Chunks are
+      still written in order.
+    */
     LazPerfVlrCompressor(std::ostream& stream, const Schema& schema,
-        uint32_t chunksize) :
+        uint32_t chunksize, std::size_t threads = 1) :
         m_stream(stream), m_outputStream(stream), m_schema(schema),
         m_chunksize(chunksize), m_chunkPointsWritten(0), m_chunkInfoPos(0),
-        m_chunkOffset(0)
-    {}
+        m_chunkOffset(0), m_started(false), m_numChunks(0)
+    {
+        if (threads > 1)
+        {
+            m_pool.reset(new ThreadPool(threads));
+            m_chunks.resize(2 * m_pool->numThreads());
+        }
+    }
 
     ~LazPerfVlrCompressor()
     {
@@ -233,15 +248,16 @@ public:
     void compress(const char *inbuf)
     {
         // First time through.
-        if (!m_encoder || !m_compressor)
+        if (!m_started)
+            start();
+        if (m_pool)
         {
-            // Get the position 
-            m_chunkInfoPos = m_stream.tellp();
-            // Seek over the chunk info offset value
-            m_stream.seekp(sizeof(uint64_t), std::ios::cur);
-            m_chunkOffset = m_stream.tellp();
-            resetCompressor();
+            bufferPoint(inbuf);
+            return;
         }
+
+        if (!m_encoder || !m_compressor)
+            resetCompressor();
         else if (m_chunkPointsWritten == m_chunksize)
         {
             resetCompressor();
@@ -253,11 +269,24 @@ public:
 
     void done()
     {
-        // Close and clear the point encoder.
-        m_encoder->done();
-        m_encoder.reset();
+        if (!m_started)
+            start();
+        if (m_pool)
+        {
+            // Compress the full chunks and any partial chunk.
+            size_t count = m_numChunks;
+            if (!m_chunks[count].m_points.empty())
+                count++;
+            writeChunks(count);
+        }
+        else if (m_encoder)
+        {
+            // Close and clear the point encoder.
+            m_encoder->done();
+            m_encoder.reset();
 
-        newChunk();
+            newChunk();
+        }
 
         // Save our current position.  Go to the location where we need
         // to write the chunk table offset at the beginning of the point data.
@@ -290,6 +319,22 @@ public:
     }
 
 private:
+    struct Chunk
+    {
+        std::vector<char> m_points;
+        std::vector<unsigned char> m_data;
+    };
+
+    void start()
+    {
+        // Get the position
+        m_chunkInfoPos = m_stream.tellp();
+        // Seek over the chunk info offset value
+        m_stream.seekp(sizeof(uint64_t), std::ios::cur);
+        m_chunkOffset = m_stream.tellp();
+        m_started = true;
+    }
+
     void resetCompressor()
     {
         if (m_encoder)
@@ -306,6 +351,56 @@ private:
         m_chunkPointsWritten = 0;
     }
 
+    void bufferPoint(const char *inbuf)
+    {
+        const size_t pointSize = m_schema.size_in_bytes();
+
+        Chunk& c = m_chunks[m_numChunks];
+        c.m_points.insert(c.m_points.end(), inbuf, inbuf + pointSize);
+        if (c.m_points.size() == m_chunksize * pointSize)
+        {
+            m_numChunks++;
+            if (m_numChunks == m_chunks.size())
+                writeChunks(m_numChunks);
+        }
+    }
+
+    // Compress buffered chunks concurrently and write them in order.
+    void writeChunks(size_t count)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            Chunk& c = m_chunks[i];
+            m_pool->add([this, &c]()
+            {
+                compressChunk(c);
+            });
+        }
+        m_pool->join();
+
+        for (size_t i = 0; i < count; ++i)
+        {
+            Chunk& c = m_chunks[i];
+            m_stream.write((const char *)c.m_data.data(), c.m_data.size());
+            m_chunkTable.push_back((uint32_t)c.m_data.size());
+            c.m_points.clear();
+            c.m_data.clear();
+        }
+        m_numChunks = 0;
+    }
+
+    void compressChunk(Chunk& c) const
+    {
+        const size_t pointSize = m_schema.size_in_bytes();
+
+        LazPerfBuf out(c.m_data);
+        laszip::encoders::arithmetic<LazPerfBuf> encoder(out);
+        auto compressor = laszip::factory::build_compressor(encoder, m_schema);
+        for (size_t pos = 0; pos < c.m_points.size(); pos += pointSize)
+            compressor->compress(c.m_points.data() + pos);
+        encoder.done();
+    }
+
     std::ostream& m_stream;
     OutputStream m_outputStream;
     std::unique_ptr<Encoder> m_encoder;
@@ -316,6 +411,10 @@ private:
     std::streampos m_chunkInfoPos;
     std::streampos m_chunkOffset;
     std::vector<uint32_t> m_chunkTable;
+    bool m_started;
+    std::unique_ptr<ThreadPool> m_pool;
+    std::vector<Chunk> m_chunks;
+    size_t m_numChunks;
 };
 
 
@@ -403,10 +502,116 @@ private:
     uint32_t m_chunkPointsRead;
 };
 
+// Reads the chunk table of LAZ point data so that chunks can be
+// decompressed independently of each other, and so concurrently.
+class LazPerfVlrChunkDecompressor
+{
+public:
+    LazPerfVlrChunkDecompressor(std::istream& stream, const char *vlrData,
+        std::streamoff pointOffset) : m_chunksize(0), m_valid(false)
+    {
+        laszip::io::laz_vlr zipvlr(vlrData);
+        m_chunksize = zipvlr.chunk_size;
+        m_schema = laszip::io::laz_vlr::to_schema(zipvlr);
+
+        // Only chunks of a fixed number of points are supported.  Variable
+        // sized chunks store point counts in the chunk table.
+        if (zipvlr.compressor != 2 ||
+            m_chunksize == (std::numeric_limits<uint32_t>::max)())
+            return;
+
+        // The point data starts with the position of the chunk table, which
+        // is -1 if it was never written.
+        ILeStream in(&stream);
+        int64_t tablePos;
+        stream.seekg(pointOffset);
+        in >> tablePos;
+        if (!stream.good() || tablePos <= pointOffset)
+            return;
+
+        uint32_t version;
+        uint32_t numChunks;
+        stream.seekg(tablePos);
+        in >> version >> numChunks;
+        if (!stream.good())
+            return;
+
+        InputStream inputStream(stream);
+        Decoder decoder(inputStream);
+        decoder.readInitBytes();
+        laszip::decompressors::integer decompressor(32, 2);
+        decompressor.init();
+
+        uint64_t offset = pointOffset + sizeof(int64_t);
+        uint32_t predictor = 0;
+        for (uint32_t i = 0; i < numChunks; ++i)
+        {
+            uint32_t size = (uint32_t)decompressor.decompress(decoder,
+                predictor, 1);
+            predictor = size;
+            m_offsets.push_back(offset);
+            m_sizes.push_back(size);
+            offset += size;
+        }
+        m_valid = !stream.bad();
+    }
+
+    bool valid() const
+        { return m_valid; }
+    size_t pointSize() const
+        { return (size_t)m_schema.size_in_bytes(); }
+    uint32_t chunkSize() const
+        { return m_chunksize; }
+    size_t numChunks() const
+        { return m_sizes.size(); }
+
+    // Read the compressed data of a chunk.  The data is padded so that the
+    // decoder never reads past the end of the buffer.
+    void readChunk(std::istream& stream, size_t chunk,
+        std::vector<unsigned char>& buf) const
+    {
+        const size_t padding = 16;
+
+        buf.resize(m_sizes[chunk] + padding);
+        std::fill(buf.end() - padding, buf.end(), 0);
+        stream.seekg(m_offsets[chunk]);
+        stream.read((char *)buf.data(), m_sizes[chunk]);
+        if (stream.gcount() != (std::streamsize)m_sizes[chunk])
+            throw pdal_error("Unable to read compressed chunk.");
+    }
+
+    // Decompress the first count points of a chunk read with readChunk().
+    void decompress(std::vector<unsigned char>& buf, char *outbuf,
+        point_count_t count) const
+    {
+        LazPerfBuf input(buf);
+        laszip::decoders::arithmetic<LazPerfBuf> decoder(input);
+        auto decompressor =
+            laszip::factory::build_decompressor(decoder, m_schema);
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            decompressor->decompress(outbuf);
+            outbuf += pointSize();
+        }
+    }
+
+private:
+    typedef laszip::io::__ifstream_wrapper<std::istream> InputStream;
+    typedef laszip::decoders::arithmetic<InputStream> Decoder;
+    typedef laszip::factory::record_schema Schema;
+
+    Schema m_schema;
+    uint32_t m_chunksize;
+    std::vector<uint64_t> m_offsets;
+    std::vector<uint32_t> m_sizes;
+    bool m_valid;
+};
+
 #else
 
 typedef char LazPerfVlrCompressor;
 typedef char LazPerfVlrDecompressor;
+typedef char LazPerfVlrChunkDecompressor;
 
 #endif  // PDAL_HAVE_LAZPERF
 
@@ -177,6 +177,54 @@ inline Type::Enum type(std::string s)
 }
 
 
+/// Get the type corresponding to a C++ arithmetic type.
+/// \return  Corresponding type enumeration value, or None if there is no
+///   corresponding dimension type.
+template<typename T>
+inline Type::Enum type()
+    { return Type::None; }
+
+template<>
+inline Type::Enum type<int8_t>()
+    { return Type::Signed8; }
+
+template<>
+inline Type::Enum type<int16_t>()
+    { return Type::Signed16; }
+
+template<>
+inline Type::Enum type<int32_t>()
+    { return Type::Signed32; }
+
+template<>
+inline Type::Enum type<int64_t>()
+    { return Type::Signed64; }
+
+template<>
+inline Type::Enum type<uint8_t>()
+    { return Type::Unsigned8; }
+
+template<>
+inline Type::Enum type<uint16_t>()
+    { return Type::Unsigned16; }
+
+template<>
+inline Type::Enum type<uint32_t>()
+    { return Type::Unsigned32; }
+
+template<>
+inline Type::Enum type<uint64_t>()
+    { return Type::Unsigned64; }
+
+template<>
+inline Type::Enum type<float>()
+    { return Type::Float; }
+
+template<>
+inline Type::Enum type<double>()
+    { return Type::Double; }
+
+
 /// Extract a dimension name of a string.  Dimension names start with an alpha
 /// and continue with numbers or underscores.
 /// \param s  String from which to extract dimension name.
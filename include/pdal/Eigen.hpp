@@ -131,4 +131,52 @@ PDAL_DLL Eigen::Matrix3f computeCovariance(PointView& view, std::vector<PointId>
  * \return the estimated rank.
  */
 PDAL_DLL uint8_t computeRank(PointView& view, std::vector<PointId> ids, double threshold);
+
+/**
+ * \brief Features of the neighborhood of a point.
+ *
+ * Eigenvalues are those of the covariance matrix of the neighborhood, in
+ * increasing order, and the normal is the eigenvector of the smallest one.
+ */
+struct NeighborhoodFeatures
+{
+    enum Flags
+    {
+        Eigenvalues = 1,
+        Normal = 2,
+        Rank = 4
+    };
+
+    Eigen::Vector3d eigenvalues;
+    Eigen::Vector3d normal;
+    uint8_t rank;
+};
+
+/**
+ * \brief Compute features of the k-nearest neighborhoods of all points.
+ *
+ * Neighbors are found with a batched search of the view's cached 3D index.
+ * The covariance of each neighborhood is accumulated in a single pass over
+ * the neighbor coordinates and only the requested features are derived from
+ * it, so filters needing several features don't repeat the work.
+ *
+ * \code
+ * // compute the normal and curvature of every point (k=8)
+ * std::vector<NeighborhoodFeatures> features;
+ * computeFeatures(view, 8, NeighborhoodFeatures::Eigenvalues |
+ *     NeighborhoodFeatures::Normal, features);
+ * \endcode
+ *
+ * \param view the source PointView.
+ * \param knn the number of neighbors of each point, including the point.
+ * \param flags the features to compute, as NeighborhoodFeatures::Flags.
+ * \param[out] features the features of each point, indexed by PointId.
+ * \param threshold the threshold used to estimate the rank.
+ * \param threads the number of threads used to find neighbors and compute
+ *    features.
+ */
+PDAL_DLL void computeFeatures(PointView& view, point_count_t knn, int flags,
+    std::vector<NeighborhoodFeatures>& features, double threshold = 0.01,
+    std::size_t threads = 1);
+
 } // namespace pdal
@@ -42,7 +42,10 @@
 
 #include <array>
 #include <functional>
+#include <list>
+#include <memory>
 #include <sstream>
+#include <unordered_map>
 #include <vector>
 
 #include <cpl_port.h>
@@ -253,6 +256,8 @@ enum Enum
 
 } // namespace GDALError
 
+class BandReader;
+
 class PDAL_DLL Raster
 {
 
@@ -263,6 +268,36 @@ public:
     void close();
 
     GDALError::Enum read(double x, double y, std::vector<double>& data);
+    /**
+      Read the values of some bands at a number of locations.  Blocks of
+      the raster are decoded once and kept in a cache of the most recently
+      used blocks, so nearby locations don't cause additional reads.
+
+      \param x  X coordinates of the locations.
+      \param y  Y coordinates of the locations.
+      \param count  Number of locations.
+      \param bands  Band numbers to read.  Band numbers start at 1.
+      \param data  Vector into which values are read.  The value of band
+        bands[b] at location i is data[i * bands.size() + b].  The vector
+        is resized appropriately.
+      \param valid  Vector set to 1 for each location inside the raster and
+        0 for the others.  The vector is resized appropriately.
+      \param bilinear  Interpolate between the centers of the four pixels
+        nearest a location rather than using the value of the pixel that
+        contains it.  Nodata pixels are left out of the interpolation.
+    */
+    GDALError::Enum read(const double *x, const double *y,
+        point_count_t count, const std::vector<int>& bands,
+        std::vector<double>& data, std::vector<uint8_t>& valid,
+        bool bilinear = false);
+    /**
+      Set the maximum size of the cache of decoded blocks.
+
+      \param bytes  Maximum size in bytes.  At least one block per band is
+        always kept.
+    */
+    void setCacheSize(size_t bytes)
+        { m_cacheSize = bytes; }
     std::vector<pdal::Dimension::Type::Enum> getPDALDimensionTypes() const
        { return m_types; }
     /**
@@ -295,9 +330,24 @@ public:
     std::string m_errorMsg;
 
 private:
+    // A decoded block of a band.
+    struct CachedBlock
+    {
+        uint64_t m_key;
+        std::vector<double> m_data;
+    };
+
+    std::vector<std::unique_ptr<BandReader>> m_bandReaders;
+    std::list<CachedBlock> m_blocks;  // Most recently used first.
+    std::unordered_map<uint64_t, std::list<CachedBlock>::iterator>
+        m_blockIndex;
+    size_t m_cacheSize;
+
     bool getPixelAndLinePosition(double x, double y,
         int32_t& pixel, int32_t& line);
     GDALError::Enum computePDALDimensionTypes();
+    GDALError::Enum initBandReaders();
+    double value(int band, int pixel, int line);
 };
 
 } // namespace gdal
@@ -36,8 +36,12 @@
 
 #include "nanoflann.hpp"
 
+#include <future>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <pdal/PointView.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace nanoflann
 {
@@ -51,6 +55,68 @@ namespace nanoflann
 namespace pdal
 {
 
+// A nanoflann KD tree that can build its subtrees concurrently, and whose
+// points can then be addressed by their position in the tree so that the
+// points of a leaf can be stored together.  The splitting code follows
+// nanoflann's, so the trees are the same as those nanoflann builds.
+template<typename Distance, class DatasetAdaptor, int DIM>
+class KDTree : public nanoflann::KDTreeSingleIndexAdaptor<Distance,
+    DatasetAdaptor, DIM, std::size_t>
+{
+    typedef nanoflann::KDTreeSingleIndexAdaptor<Distance, DatasetAdaptor,
+        DIM, std::size_t> Base;
+    typedef typename Base::Node Node;
+    typedef typename Base::NodePtr NodePtr;
+    typedef typename Base::BoundingBox BoundingBox;
+    typedef typename Base::ElementType ElementType;
+    typedef typename Base::DistanceType DistanceType;
+
+public:
+    KDTree(const DatasetAdaptor& data,
+            const nanoflann::KDTreeSingleIndexAdaptorParams& params) :
+        Base(DIM, data, params)
+    {}
+
+    /**
+      Build the tree, building the subtrees below the first splits
+      concurrently on up to \a threads threads.
+
+      \param threads  Number of threads used to build the tree.
+    */
+    void buildIndex(std::size_t threads);
+
+    /**
+      Take the order of the points in the leaves of the tree, in which the
+      points of a leaf are consecutive.  From then on, the point at position
+      i of the order is addressed as point i, both in the dataset and in
+      search results.
+
+      \param order  Filled with the indices of the points in tree order.
+    */
+    void takeOrder(std::vector<std::size_t>& order)
+    {
+        order.swap(this->vind);
+        this->vind.resize(order.size());
+        std::iota(this->vind.begin(), this->vind.end(), 0);
+    }
+
+private:
+    // Allocators of the subtrees built on other threads.
+    std::vector<std::unique_ptr<nanoflann::PooledAllocator>> m_pools;
+    std::mutex m_poolsMutex;
+
+    ElementType get(std::size_t idx, int dim) const
+        { return this->dataset.kdtree_get_pt(idx, dim); }
+    NodePtr divideTree(std::size_t left, std::size_t right,
+        BoundingBox& bbox, nanoflann::PooledAllocator& alloc, int splits);
+    void middleSplit(std::size_t *ind, std::size_t count, std::size_t& index,
+        int& cutfeat, DistanceType& cutval, const BoundingBox& bbox);
+    void computeMinMax(const std::size_t *ind, std::size_t count, int dim,
+        ElementType& minElem, ElementType& maxElem) const;
+    void planeSplit(std::size_t *ind, std::size_t count, int cutfeat,
+        DistanceType cutval, std::size_t& lim1, std::size_t& lim2);
+};
+
 template<int DIM>
 class PDAL_DLL KDIndex
 {
@@ -62,29 +128,85 @@ protected:
     {}
 
 public:
+    // The dataset interface used by nanoflann.  Points are addressed by
+    // their position in the coordinate buffer, which holds them in view
+    // order while the tree is built and in tree order once it's built.
     std::size_t kdtree_get_point_count() const
-        { return m_buf.size(); }
-
-    double kdtree_get_pt(const PointId idx, int dim) const;
+        { return m_coords.size() / DIM; }
+    double kdtree_get_pt(const PointId idx, int dim) const
+        { return m_coords[idx * DIM + dim]; }
     double kdtree_distance(const double *p1, const PointId p2_idx,
         size_t /*numDims*/) const;
     template <class BBOX> bool kdtree_get_bbox(BBOX& bb) const;
-    void build()
-    {
-        m_index.reset(new my_kd_tree_t(DIM, *this,
-            nanoflann::KDTreeSingleIndexAdaptorParams(10, DIM)));
-        m_index->buildIndex();
-    }
+
+    /**
+      Build the index.  The coordinates of the points are copied from the
+      view, so changes to the view after the index is built aren't seen.
+
+      \param threads  Number of threads used to build the index.
+    */
+    void build(std::size_t threads = 1);
+
+    /**
+      Find the k nearest neighbors of each point in a range of the indexed
+      view.  The neighbors of point (begin + i) are stored, nearest first,
+      in indices[i * k] through indices[(i + 1) * k - 1].  A point is its
+      own nearest neighbor.
+
+      \param begin  First point to query.
+      \param end  One past the last point to query.
+      \param k  Number of neighbors to find for each point.
+      \param indices  Neighbors of the points.
+      \param sqrDists  Square distances to the neighbors of the points.
+      \param threads  Number of threads used to run the queries.
+      \return  Number of neighbors found for each point, which is k unless
+        the view holds fewer than k points.
+    */
+    point_count_t knnSearch(PointId begin, PointId end, point_count_t k,
+        std::vector<PointId>& indices, std::vector<double>& sqrDists,
+        std::size_t threads = 1) const;
+
+    /**
+      Find the points within a radius of each point in a range of the
+      indexed view.  The neighbors of point (begin + i) are stored, nearest
+      first, in indices[offsets[i]] through indices[offsets[i + 1] - 1].
+
+      \param begin  First point to query.
+      \param end  One past the last point to query.
+      \param r  Radius of the neighborhood.
+      \param offsets  Position of the neighbors of each point in indices.
+        Holds one more entry than the number of points queried.
+      \param indices  Neighbors of the points.
+      \param threads  Number of threads used to run the queries.
+    */
+    void radius(PointId begin, PointId end, double r,
+        std::vector<point_count_t>& offsets, std::vector<PointId>& indices,
+        std::size_t threads = 1) const;
 
 protected:
     const PointView& m_buf;
+    // Coordinates of the points, DIM values per point.
+    std::vector<double> m_coords;
+
+    // Points of the view in tree order.  Search results hold positions in
+    // the tree, which are mapped to points of the view with pointId().
+    std::vector<std::size_t> m_order;
 
-    typedef nanoflann::KDTreeSingleIndexAdaptor<nanoflann::L2_Simple_Adaptor<
-        double, KDIndex, double>, KDIndex, -1, std::size_t> my_kd_tree_t;
+    // A fixed dimension lets nanoflann keep its search state on the stack.
+    typedef KDTree<nanoflann::L2_Simple_Adaptor<double, KDIndex, double>,
+        KDIndex, DIM> my_kd_tree_t;
 
     std::unique_ptr<my_kd_tree_t> m_index;
 
+    PointId pointId(std::size_t pos) const
+        { return (PointId)m_order[pos]; }
+
 private:
+    template<typename FUNC>
+    void runBlocks(PointId begin, PointId end, std::size_t threads,
+        FUNC f) const;
+    void loadCoords(PointId begin, PointId end, double *coords) const;
+
     KDIndex(const KDIndex&);
     KDIndex& operator=(KDIndex&);
 };
@@ -119,9 +241,13 @@ public:
         pt.push_back(x);
         pt.push_back(y);
         m_index->findNeighbors(resultSet, &pt[0], nanoflann::SearchParams(10));
+        for (PointId& id : output)
+            id = pointId(id);
         return output;
     }
 
+    using KDIndex<2>::radius;
+
     std::vector<PointId> radius(double const& x, double const& y,
         double const& r) const
     {
@@ -140,7 +266,7 @@ public:
             m_index->radiusSearch(&pt[0], r * r, ret_matches, params);
 
         for (std::size_t i = 0; i < count; ++i)
-            output.push_back(ret_matches[i].first);
+            output.push_back(pointId(ret_matches[i].first));
         return output;
     }
 };
@@ -179,9 +305,14 @@ public:
         pt.push_back(y);
         pt.push_back(z);
         m_index->findNeighbors(resultSet, &pt[0], nanoflann::SearchParams(10));
+        for (PointId& id : output)
+            id = pointId(id);
         return output;
     }
     
+    using KDIndex<3>::knnSearch;
+    using KDIndex<3>::radius;
+
     void knnSearch(double x, double y, double z, point_count_t k,
         std::vector<PointId> *indices, std::vector<double> *sqr_dists)
     {
@@ -195,6 +326,8 @@ public:
         pt.push_back(y);
         pt.push_back(z);
         m_index->findNeighbors(resultSet, &pt[0], nanoflann::SearchParams(10));
+        for (point_count_t i = 0; i < k; ++i)
+            (*indices)[i] = pointId((*indices)[i]);
     }
 
     std::vector<PointId> radius(double x, double y, double z, double r) const
@@ -215,134 +348,415 @@ public:
             m_index->radiusSearch(&pt[0], r * r, ret_matches, params);
 
         for (std::size_t i = 0; i < count; ++i)
-            output.push_back(ret_matches[i].first);
+            output.push_back(pointId(ret_matches[i].first));
         return output;
     }
 };
 
-template<>
-inline
-double KDIndex<2>::kdtree_get_pt(const PointId idx, int dim) const
+template<typename Distance, class DatasetAdaptor, int DIM>
+void KDTree<Distance, DatasetAdaptor, DIM>::buildIndex(std::size_t threads)
+{
+    this->m_size = this->dataset.kdtree_get_point_count();
+    this->vind.resize(this->m_size);
+    std::iota(this->vind.begin(), this->vind.end(), 0);
+    this->root_bbox.resize(DIM);
+    this->dataset.kdtree_get_bbox(this->root_bbox);
+    this->freeIndex();
+    m_pools.clear();
+
+    // Split the work until there's a subtree for each thread.
+    int splits = 0;
+    while (((std::size_t)1 << splits) < threads)
+        splits++;
+    if (this->m_size)
+        this->root_node = divideTree(0, this->m_size, this->root_bbox,
+            this->pool, splits);
+}
+
+
+// Make a node for the points from vind[left] to vind[right - 1], splitting
+// them between two subtrees if there are too many for a leaf.  While splits
+// is positive, the first subtree is built on another thread with its own
+// allocator.
+template<typename Distance, class DatasetAdaptor, int DIM>
+typename KDTree<Distance, DatasetAdaptor, DIM>::NodePtr
+KDTree<Distance, DatasetAdaptor, DIM>::divideTree(std::size_t left,
+    std::size_t right, BoundingBox& bbox, nanoflann::PooledAllocator& alloc,
+    int splits)
 {
-    if (idx >= m_buf.size())
-        return 0.0;
+    NodePtr node = alloc.template allocate<Node>();
+    std::vector<std::size_t>& vind = this->vind;
+
+    if (right - left <= this->m_leaf_max_size)
+    {
+        node->child1 = node->child2 = NULL;
+        node->lr.left = left;
+        node->lr.right = right;
+
+        // Compute the bounding box of the points of the leaf.
+        for (int i = 0; i < DIM; ++i)
+            bbox[i].low = bbox[i].high = get(vind[left], i);
+        for (std::size_t k = left + 1; k < right; ++k)
+            for (int i = 0; i < DIM; ++i)
+            {
+                bbox[i].low = (std::min)(bbox[i].low, get(vind[k], i));
+                bbox[i].high = (std::max)(bbox[i].high, get(vind[k], i));
+            }
+        return node;
+    }
+
+    std::size_t idx;
+    int cutfeat;
+    DistanceType cutval;
+    middleSplit(vind.data() + left, right - left, idx, cutfeat, cutval, bbox);
+    node->sub.divfeat = cutfeat;
+
+    BoundingBox leftBbox(bbox);
+    leftBbox[cutfeat].high = cutval;
+    BoundingBox rightBbox(bbox);
+    rightBbox[cutfeat].low = cutval;
+
+    if (splits > 0)
+    {
+        nanoflann::PooledAllocator *childAlloc =
+            new nanoflann::PooledAllocator();
+        {
+            std::lock_guard<std::mutex> lock(m_poolsMutex);
+            m_pools.push_back(
+                std::unique_ptr<nanoflann::PooledAllocator>(childAlloc));
+        }
+        std::future<NodePtr> child1 = std::async(std::launch::async,
+            [this, left, idx, &leftBbox, childAlloc, splits]()
+            {
+                return divideTree(left, left + idx, leftBbox, *childAlloc,
+                    splits - 1);
+            });
+        node->child2 = divideTree(left + idx, right, rightBbox, alloc,
+            splits - 1);
+        node->child1 = child1.get();
+    }
+    else
+    {
+        node->child1 = divideTree(left, left + idx, leftBbox, alloc, 0);
+        node->child2 = divideTree(left + idx, right, rightBbox, alloc, 0);
+    }
 
-    Dimension::Id::Enum id = Dimension::Id::Unknown;
-    switch (dim)
+    node->sub.divlow = leftBbox[cutfeat].high;
+    node->sub.divhigh = rightBbox[cutfeat].low;
+    for (int i = 0; i < DIM; ++i)
     {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    default:
-        throw pdal_error("kdtree_get_pt: Request for invalid dimension "
-            "from nanoflann");
+        bbox[i].low = (std::min)(leftBbox[i].low, rightBbox[i].low);
+        bbox[i].high = (std::max)(leftBbox[i].high, rightBbox[i].high);
     }
-    return m_buf.getFieldAs<double>(id, idx);
+    return node;
 }
 
-template<>
-inline
-double KDIndex<3>::kdtree_get_pt(const PointId idx, int dim) const
+
+// Choose the split of a node as nanoflann's middleSplit_() does, including
+// its use of the spread of the first dimension to pick the cut dimension.
+template<typename Distance, class DatasetAdaptor, int DIM>
+void KDTree<Distance, DatasetAdaptor, DIM>::middleSplit(std::size_t *ind,
+    std::size_t count, std::size_t& index, int& cutfeat, DistanceType& cutval,
+    const BoundingBox& bbox)
 {
-    if (idx >= m_buf.size())
-        return 0.0;
+    const DistanceType eps = static_cast<DistanceType>(0.00001);
+    ElementType maxSpan = bbox[0].high - bbox[0].low;
+    for (int i = 1; i < DIM; ++i)
+        maxSpan = (std::max)(maxSpan, bbox[i].high - bbox[i].low);
+
+    ElementType maxSpread = -1;
+    cutfeat = 0;
+    for (int i = 0; i < DIM; ++i)
+    {
+        ElementType span = bbox[i].high - bbox[i].low;
+        if (span > (1 - eps) * maxSpan)
+        {
+            ElementType minElem, maxElem;
+            computeMinMax(ind, count, cutfeat, minElem, maxElem);
+            ElementType spread = maxElem - minElem;
+            if (spread > maxSpread)
+            {
+                cutfeat = i;
+                maxSpread = spread;
+            }
+        }
+    }
+
+    // Split in the middle.
+    DistanceType splitVal = (bbox[cutfeat].low + bbox[cutfeat].high) / 2;
+    ElementType minElem, maxElem;
+    computeMinMax(ind, count, cutfeat, minElem, maxElem);
+    if (splitVal < minElem)
+        cutval = minElem;
+    else if (splitVal > maxElem)
+        cutval = maxElem;
+    else
+        cutval = splitVal;
+
+    std::size_t lim1, lim2;
+    planeSplit(ind, count, cutfeat, cutval, lim1, lim2);
+    if (lim1 > count / 2)
+        index = lim1;
+    else if (lim2 < count / 2)
+        index = lim2;
+    else
+        index = count / 2;
+}
+
 
-    Dimension::Id::Enum id = Dimension::Id::Unknown;
-    switch (dim)
+template<typename Distance, class DatasetAdaptor, int DIM>
+void KDTree<Distance, DatasetAdaptor, DIM>::computeMinMax(
+    const std::size_t *ind, std::size_t count, int dim, ElementType& minElem,
+    ElementType& maxElem) const
+{
+    minElem = maxElem = get(ind[0], dim);
+    for (std::size_t i = 1; i < count; ++i)
     {
-    case 0:
-        id = Dimension::Id::X;
-        break;
-    case 1:
-        id = Dimension::Id::Y;
-        break;
-    case 2:
-        id = Dimension::Id::Z;
-        break;
-    default:
-        throw pdal_error("kdtree_get_pt: Request for invalid dimension "
-            "from nanoflann");
+        ElementType val = get(ind[i], dim);
+        minElem = (std::min)(minElem, val);
+        maxElem = (std::max)(maxElem, val);
     }
-    return m_buf.getFieldAs<double>(id, idx);
 }
 
-// nanoflann hands us a vector that represents the position of p1.  We fetch
-// the position of p2 and and compute the square distance.
-template<>
-inline double KDIndex<2>::kdtree_distance(const double *p1, const PointId idx,
-    size_t /*numDims*/) const
+
+// Reorder the points so that those below cutval come first, then those
+// equal to it, then those above it.  On return, lim1 is the position of
+// the first point not below cutval and lim2 of the first point above it.
+template<typename Distance, class DatasetAdaptor, int DIM>
+void KDTree<Distance, DatasetAdaptor, DIM>::planeSplit(std::size_t *ind,
+    std::size_t count, int cutfeat, DistanceType cutval, std::size_t& lim1,
+    std::size_t& lim2)
 {
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
+    std::size_t left = 0;
+    std::size_t right = count - 1;
+    while (true)
+    {
+        while (left <= right && get(ind[left], cutfeat) < cutval)
+            ++left;
+        while (right && left <= right && get(ind[right], cutfeat) >= cutval)
+            --right;
+        if (left > right || !right)
+            break;
+        std::swap(ind[left], ind[right]);
+        ++left;
+        --right;
+    }
+    lim1 = left;
 
-    return (d0 * d0 + d1 * d1);
+    right = count - 1;
+    while (true)
+    {
+        while (left <= right && get(ind[left], cutfeat) <= cutval)
+            ++left;
+        while (right && left <= right && get(ind[right], cutfeat) > cutval)
+            --right;
+        if (left > right || !right)
+            break;
+        std::swap(ind[left], ind[right]);
+        ++left;
+        --right;
+    }
+    lim2 = left;
 }
 
-template<>
-inline double KDIndex<3>::kdtree_distance(const double *p1, const PointId idx,
-    size_t /*numDims*/) const
+
+// nanoflann hands us a vector that represents the position of p1.  We fetch
+// the position of p2 and and compute the square distance.
+template<int DIM>
+inline double KDIndex<DIM>::kdtree_distance(const double *p1,
+    const PointId idx, size_t /*numDims*/) const
 {
-    double d0 = p1[0] - m_buf.getFieldAs<double>(Dimension::Id::X, idx);
-    double d1 = p1[1] - m_buf.getFieldAs<double>(Dimension::Id::Y, idx);
-    double d2 = p1[2] - m_buf.getFieldAs<double>(Dimension::Id::Z, idx);
+    const double *p2 = m_coords.data() + idx * DIM;
 
-    return (d0 * d0 + d1 * d1 + d2 * d2);
+    double dist = 0;
+    for (int d = 0; d < DIM; ++d)
+        dist += (p1[d] - p2[d]) * (p1[d] - p2[d]);
+    return dist;
 }
 
 
-template<>
+template<int DIM>
 template <class BBOX>
-bool KDIndex<2>::kdtree_get_bbox(BBOX& bb) const
+bool KDIndex<DIM>::kdtree_get_bbox(BBOX& bb) const
 {
-    if (m_buf.empty())
+    for (int d = 0; d < DIM; ++d)
     {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
+        bb[d].low = 0.0;
+        bb[d].high = 0.0;
     }
-    else
+    if (m_coords.empty())
+        return true;
+
+    for (int d = 0; d < DIM; ++d)
+        bb[d].low = bb[d].high = m_coords[d];
+    for (auto pos = m_coords.begin(); pos != m_coords.end(); pos += DIM)
+        for (int d = 0; d < DIM; ++d)
+        {
+            bb[d].low = (std::min)(bb[d].low, pos[d]);
+            bb[d].high = (std::max)(bb[d].high, pos[d]);
+        }
+    return true;
+}
+
+
+// Number of points queried by each task of a batch query.
+static const point_count_t KDBlockSize = 4096;
+
+// Run a function over blocks of a range of points, concurrently if more
+// than one thread is requested.  The function is passed the range of each
+// block and the block number.
+template<int DIM>
+template<typename FUNC>
+void KDIndex<DIM>::runBlocks(PointId begin, PointId end, std::size_t threads,
+    FUNC f) const
+{
+    if (threads <= 1 || end - begin <= KDBlockSize)
     {
-        BOX2D bounds;
-        m_buf.calculateBounds(bounds);
+        for (PointId b = begin, block = 0; b < end; b += KDBlockSize, ++block)
+            f(b, (std::min)(b + KDBlockSize, end), block);
+        return;
+    }
 
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
+    ThreadPool pool(threads);
+    for (PointId b = begin, block = 0; b < end; b += KDBlockSize, ++block)
+    {
+        PointId e = (std::min)(b + KDBlockSize, end);
+        pool.add([&f, b, e, block](){ f(b, e, block); });
     }
-    return true;
+    pool.join();
 }
 
-template<>
-template <class BBOX>
-bool KDIndex<3>::kdtree_get_bbox(BBOX& bb) const
+
+// Copy the coordinates of a range of points from the view.
+template<int DIM>
+void KDIndex<DIM>::loadCoords(PointId begin, PointId end,
+    double *coords) const
 {
-    if (m_buf.empty())
+    static const Dimension::Id::Enum dims[] =
+        { Dimension::Id::X, Dimension::Id::Y, Dimension::Id::Z };
+
+    double vals[KDBlockSize];
+    while (begin < end)
     {
-        bb[0].low = 0.0;
-        bb[0].high = 0.0;
-        bb[1].low = 0.0;
-        bb[1].high = 0.0;
-        bb[2].low = 0.0;
-        bb[2].high = 0.0;
+        PointId blockEnd = (std::min)(begin + KDBlockSize, end);
+        for (int d = 0; d < DIM; ++d)
+        {
+            m_buf.getFieldsAs(dims[d], begin, blockEnd, vals);
+            for (PointId i = 0; i < blockEnd - begin; ++i)
+                coords[i * DIM + d] = vals[i];
+        }
+        coords += (blockEnd - begin) * DIM;
+        begin = blockEnd;
     }
-    else
+}
+
+
+// The coordinates are copied so that the tree is built from contiguous
+// memory, and then placed in tree order so that the points of a leaf are
+// adjacent when searched.
+template<int DIM>
+void KDIndex<DIM>::build(std::size_t threads)
+{
+    const point_count_t np = m_buf.size();
+
+    m_coords.resize(np * DIM);
+    runBlocks(0, np, threads, [this](PointId b, PointId e, PointId)
+        { loadCoords(b, e, m_coords.data() + b * DIM); });
+
+    m_index.reset(new my_kd_tree_t(*this,
+        nanoflann::KDTreeSingleIndexAdaptorParams(10, DIM)));
+    m_index->buildIndex(threads);
+
+    m_index->takeOrder(m_order);
+    std::vector<double> coords(np * DIM);
+    runBlocks(0, np, threads, [this, &coords](PointId b, PointId e, PointId)
     {
-        BOX3D bounds;
-        m_buf.calculateBounds(bounds);
-
-        bb[0].low = bounds.minx;
-        bb[0].high = bounds.maxx;
-        bb[1].low = bounds.miny;
-        bb[1].high = bounds.maxy;
-        bb[2].low = bounds.minz;
-        bb[2].high = bounds.maxz;
-    }
-    return true;
+        for (PointId i = b; i < e; ++i)
+            for (int d = 0; d < DIM; ++d)
+                coords[i * DIM + d] = m_coords[m_order[i] * DIM + d];
+    });
+    m_coords.swap(coords);
+}
+
+
+template<int DIM>
+point_count_t KDIndex<DIM>::knnSearch(PointId begin, PointId end,
+    point_count_t k, std::vector<PointId>& indices,
+    std::vector<double>& sqrDists, std::size_t threads) const
+{
+    end = (std::min)(end, (PointId)m_buf.size());
+    begin = (std::min)(begin, end);
+    k = (std::min)(m_buf.size(), k);
+    indices.resize((end - begin) * k);
+    sqrDists.resize((end - begin) * k);
+
+    auto query = [this, begin, k, &indices, &sqrDists](PointId b, PointId e,
+        PointId /*block*/)
+    {
+        std::vector<double> coords((e - b) * DIM);
+        loadCoords(b, e, coords.data());
+        for (PointId i = b; i < e; ++i)
+        {
+            const double *pt = coords.data() + (i - b) * DIM;
+            nanoflann::KNNResultSet<double, PointId, point_count_t>
+                resultSet(k);
+            PointId *ids = indices.data() + (i - begin) * k;
+            resultSet.init(ids, sqrDists.data() + (i - begin) * k);
+            m_index->findNeighbors(resultSet, pt,
+                nanoflann::SearchParams(10));
+            for (point_count_t j = 0; j < k; ++j)
+                ids[j] = pointId(ids[j]);
+        }
+    };
+    runBlocks(begin, end, threads, query);
+    return k;
+}
+
+
+template<int DIM>
+void KDIndex<DIM>::radius(PointId begin, PointId end, double r,
+    std::vector<point_count_t>& offsets, std::vector<PointId>& indices,
+    std::size_t threads) const
+{
+    end = (std::min)(end, (PointId)m_buf.size());
+    begin = (std::min)(begin, end);
+    offsets.assign(end - begin + 1, 0);
+
+    // Each block collects its neighbors separately.  They're joined once
+    // the number of neighbors of every point is known.
+    std::vector<std::vector<PointId>> blockIndices(
+        (end - begin + KDBlockSize - 1) / KDBlockSize);
+    auto query = [this, begin, r, &offsets, &blockIndices](PointId b,
+        PointId e, PointId block)
+    {
+        std::vector<std::pair<std::size_t, double>> matches;
+        nanoflann::SearchParams params;
+        params.sorted = true;
+
+        std::vector<double> coords((e - b) * DIM);
+        loadCoords(b, e, coords.data());
+
+        std::vector<PointId>& ids = blockIndices[block];
+        for (PointId i = b; i < e; ++i)
+        {
+            const double *pt = coords.data() + (i - b) * DIM;
+
+            // Our distance metric is square distance, so we use the square
+            // of the radius.
+            m_index->radiusSearch(pt, r * r, matches, params);
+            for (auto const& m : matches)
+                ids.push_back(pointId(m.first));
+            offsets[i - begin + 1] = matches.size();
+        }
+    };
+    runBlocks(begin, end, threads, query);
+
+    for (size_t i = 1; i < offsets.size(); ++i)
+        offsets[i] += offsets[i - 1];
+    indices.resize(offsets.back());
+    auto pos = indices.begin();
+    for (auto const& ids : blockIndices)
+        pos = std::copy(ids.begin(), ids.end(), pos);
 }
 
 } // namespace pdal
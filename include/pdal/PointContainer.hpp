@@ -34,6 +34,10 @@
 
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <sstream>
+
 #include <pdal/pdal_types.hpp>
 #include <pdal/Dimension.hpp>
 #include <pdal/PointLayout.hpp>
@@ -51,8 +55,174 @@ private:
         const void *val) = 0;
     virtual void getFieldInternal(Dimension::Id::Enum dim, PointId idx,
         void *val) const = 0;
+
+    // Copy the values of a dimension for a list of points to/from a buffer
+    // of packed values.  Containers can override these to avoid the
+    // per-point dispatch of the single-point functions.
+    virtual void setFieldsInternal(Dimension::Id::Enum dim,
+        const PointId *ids, point_count_t count, const void *val)
+    {
+        const std::size_t size = layout()->dimSize(dim);
+        const char *pos = (const char *)val;
+        for (point_count_t i = 0; i < count; ++i, pos += size)
+            setFieldInternal(dim, ids[i], pos);
+    }
+    virtual void getFieldsInternal(Dimension::Id::Enum dim,
+        const PointId *ids, point_count_t count, void *val) const
+    {
+        const std::size_t size = layout()->dimSize(dim);
+        char *pos = (char *)val;
+        for (point_count_t i = 0; i < count; ++i, pos += size)
+            getFieldInternal(dim, ids[i], pos);
+    }
 public:
     virtual PointLayoutPtr layout() const = 0;
+
+private:
+    // Maximum number of points passed to getTypedFields()/setTypedFields().
+    static const point_count_t m_fieldBlockSize = 1024;
+
+    template<typename T>
+    void getTypedFields(Dimension::Id::Enum dim, const PointId *ids,
+        point_count_t count, T *buf) const;
+    template<typename T>
+    void setTypedFields(Dimension::Id::Enum dim, const PointId *ids,
+        point_count_t count, const T *buf);
+    template<typename T_IN, typename T_OUT>
+    static void convertFields(Dimension::Id::Enum dim, const T_IN *in,
+        T_OUT *out, point_count_t count);
 };
 
+
+template<typename T_IN, typename T_OUT>
+void PointContainer::convertFields(Dimension::Id::Enum dim, const T_IN *in,
+    T_OUT *out, point_count_t count)
+{
+    for (point_count_t i = 0; i < count; ++i)
+        if (!Utils::numericCast(in[i], out[i]))
+        {
+            std::ostringstream oss;
+            oss << "Unable to convert data as requested: ";
+            oss << Dimension::name(dim) << ":" <<
+                Utils::typeidName<T_IN>() << "(" << (double)in[i] <<
+                ") -> " << Utils::typeidName<T_OUT>();
+            throw pdal_error(oss.str());
+        }
+}
+
+
+// Fetch the values of a dimension for a list of at most m_fieldBlockSize
+// points, converting them to type T.
+template<typename T>
+void PointContainer::getTypedFields(Dimension::Id::Enum dim,
+    const PointId *ids, point_count_t count, T *buf) const
+{
+    assert(count <= m_fieldBlockSize);
+    const Dimension::Type::Enum type = layout()->dimType(dim);
+
+    // When no conversion is needed, read straight into the caller's buffer.
+    if (type == Dimension::type<T>())
+    {
+        getFieldsInternal(dim, ids, count, buf);
+        return;
+    }
+
+    uint64_t raw[m_fieldBlockSize];
+    getFieldsInternal(dim, ids, count, raw);
+    switch (type)
+    {
+    case Dimension::Type::Float:
+        convertFields(dim, (const float *)raw, buf, count);
+        break;
+    case Dimension::Type::Double:
+        convertFields(dim, (const double *)raw, buf, count);
+        break;
+    case Dimension::Type::Signed8:
+        convertFields(dim, (const int8_t *)raw, buf, count);
+        break;
+    case Dimension::Type::Signed16:
+        convertFields(dim, (const int16_t *)raw, buf, count);
+        break;
+    case Dimension::Type::Signed32:
+        convertFields(dim, (const int32_t *)raw, buf, count);
+        break;
+    case Dimension::Type::Signed64:
+        convertFields(dim, (const int64_t *)raw, buf, count);
+        break;
+    case Dimension::Type::Unsigned8:
+        convertFields(dim, (const uint8_t *)raw, buf, count);
+        break;
+    case Dimension::Type::Unsigned16:
+        convertFields(dim, (const uint16_t *)raw, buf, count);
+        break;
+    case Dimension::Type::Unsigned32:
+        convertFields(dim, (const uint32_t *)raw, buf, count);
+        break;
+    case Dimension::Type::Unsigned64:
+        convertFields(dim, (const uint64_t *)raw, buf, count);
+        break;
+    case Dimension::Type::None:
+    default:
+        std::fill(buf, buf + count, T(0));
+        break;
+    }
+}
+
+
+// Set the values of a dimension for a list of at most m_fieldBlockSize
+// points from values of type T.
+template<typename T>
+void PointContainer::setTypedFields(Dimension::Id::Enum dim,
+    const PointId *ids, point_count_t count, const T *buf)
+{
+    assert(count <= m_fieldBlockSize);
+    const Dimension::Type::Enum type = layout()->dimType(dim);
+
+    // When no conversion is needed, write straight from the caller's buffer.
+    if (type == Dimension::type<T>())
+    {
+        setFieldsInternal(dim, ids, count, buf);
+        return;
+    }
+
+    uint64_t raw[m_fieldBlockSize];
+    switch (type)
+    {
+    case Dimension::Type::Float:
+        convertFields(dim, buf, (float *)raw, count);
+        break;
+    case Dimension::Type::Double:
+        convertFields(dim, buf, (double *)raw, count);
+        break;
+    case Dimension::Type::Signed8:
+        convertFields(dim, buf, (int8_t *)raw, count);
+        break;
+    case Dimension::Type::Signed16:
+        convertFields(dim, buf, (int16_t *)raw, count);
+        break;
+    case Dimension::Type::Signed32:
+        convertFields(dim, buf, (int32_t *)raw, count);
+        break;
+    case Dimension::Type::Signed64:
+        convertFields(dim, buf, (int64_t *)raw, count);
+        break;
+    case Dimension::Type::Unsigned8:
+        convertFields(dim, buf, (uint8_t *)raw, count);
+        break;
+    case Dimension::Type::Unsigned16:
+        convertFields(dim, buf, (uint16_t *)raw, count);
+        break;
+    case Dimension::Type::Unsigned32:
+        convertFields(dim, buf, (uint32_t *)raw, count);
+        break;
+    case Dimension::Type::Unsigned64:
+        convertFields(dim, buf, (uint64_t *)raw, count);
+        break;
+    case Dimension::Type::None:
+    default:
+        return;
+    }
+    setFieldsInternal(dim, ids, count, raw);
+}
+
 } // namespace pdal
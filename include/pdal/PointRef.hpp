@@ -158,6 +158,26 @@ public:
 
     void setPointId(PointId idx)
         { m_idx = idx; }
+    PointId pointId() const
+        { return m_idx; }
+
+    /// Fill a buffer with the values of a dimension for a range of points
+    /// starting at this point, converted to type T.
+    /// \param dim  Dimension to fetch.
+    /// \param count  Number of points.
+    /// \param buf  Buffer to fill.  Must have room for \a count values.
+    template<typename T>
+    void getFieldsAs(Dimension::Id::Enum dim, point_count_t count,
+        T *buf) const;
+
+    /// Set the values of a dimension for a range of points starting at this
+    /// point from a buffer of values of type T.
+    /// \param dim  Dimension to set.
+    /// \param count  Number of points.
+    /// \param buf  Buffer containing \a count values.
+    template<typename T>
+    void setFields(Dimension::Id::Enum dim, point_count_t count,
+        const T *buf);
     inline void getField(char *val, Dimension::Id::Enum d,
         Dimension::Type::Enum type) const;
     inline void setField(Dimension::Id::Enum dim,
@@ -197,6 +217,44 @@ private:
     PointId m_idx;
 };
 
+template<typename T>
+void PointRef::getFieldsAs(Dimension::Id::Enum dim, point_count_t count,
+    T *buf) const
+{
+    PointId ids[PointContainer::m_fieldBlockSize];
+    PointId idx = m_idx;
+    while (count)
+    {
+        point_count_t n =
+            (std::min)(count, (point_count_t)PointContainer::m_fieldBlockSize);
+        for (point_count_t i = 0; i < n; ++i)
+            ids[i] = idx++;
+        m_container.getTypedFields(dim, ids, n, buf);
+        buf += n;
+        count -= n;
+    }
+}
+
+
+template<typename T>
+void PointRef::setFields(Dimension::Id::Enum dim, point_count_t count,
+    const T *buf)
+{
+    PointId ids[PointContainer::m_fieldBlockSize];
+    PointId idx = m_idx;
+    while (count)
+    {
+        point_count_t n =
+            (std::min)(count, (point_count_t)PointContainer::m_fieldBlockSize);
+        for (point_count_t i = 0; i < n; ++i)
+            ids[i] = idx++;
+        m_container.setTypedFields(dim, ids, n, buf);
+        buf += n;
+        count -= n;
+    }
+}
+
+
 inline void PointRef::getField(char *val, Dimension::Id::Enum d,
     Dimension::Type::Enum type) const
 {
@@ -34,6 +34,8 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <set>
 #include <vector>
 
@@ -52,7 +54,8 @@ class PDAL_DLL BasePointTable : public PointContainer
 
 protected:
     BasePointTable(PointLayout& layout) : m_metadata(new Metadata()),
-        m_layoutRef(layout)
+        m_layoutRef(layout), m_positionsIndexed(false),
+        m_positionGeneration(0)
     {}
 
 public:
@@ -94,17 +97,46 @@ public:
     MetadataNode privateMetadata(const std::string& name);
     MetadataNode toMetadata() const;
 
+    /// Get a count that changes whenever the X, Y or Z value of a point in
+    /// the table is set after a spatial index of the points has been built.
+    /// Views compare it with the count when their index was built to tell
+    /// whether the index is stale, however the points were changed.
+    /// \return  Position generation of the table.
+    uint64_t positionGeneration() const
+        { return m_positionGeneration.load(std::memory_order_relaxed); }
+
 private:
     // Point data operations.
     virtual PointId addPoint() = 0;
 
+    // Note that a spatial index has been built, so changes to positions
+    // must be counted.  Until then, setting fields costs nothing extra.
+    uint64_t positionsIndexed()
+    {
+        m_positionsIndexed.store(true, std::memory_order_relaxed);
+        return positionGeneration();
+    }
+
 protected:
     virtual char *getPoint(PointId idx) = 0;
 
+    // Called by tables when the values of a dimension are set.
+    void fieldChanged(Dimension::Id::Enum id)
+    {
+        if (m_positionsIndexed.load(std::memory_order_relaxed) &&
+            (id == Dimension::Id::X || id == Dimension::Id::Y ||
+                id == Dimension::Id::Z))
+            m_positionGeneration.fetch_add(1, std::memory_order_relaxed);
+    }
+
 protected:
     MetadataPtr m_metadata;
     std::set<SpatialReference> m_spatialRefs;
     PointLayout& m_layoutRef;
+
+private:
+    std::atomic<bool> m_positionsIndexed;
+    std::atomic<uint64_t> m_positionGeneration;
 };
 typedef BasePointTable& PointTableRef;
 typedef BasePointTable const & ConstPointTableRef;
@@ -125,6 +157,10 @@ private:
         const void *value);
     virtual void getFieldInternal(Dimension::Id::Enum id, PointId idx,
         void *value) const;
+    virtual void setFieldsInternal(Dimension::Id::Enum id,
+        const PointId *ids, point_count_t count, const void *value);
+    virtual void getFieldsInternal(Dimension::Id::Enum id,
+        const PointId *ids, point_count_t count, void *value) const;
 
     // The number of points in each memory block.
     char *getDimension(const Dimension::Detail *d, PointId idx)
@@ -160,7 +196,116 @@ protected:
 private:
     // Point data operations.
     virtual PointId addPoint();
+    virtual void setFieldsInternal(Dimension::Id::Enum id,
+        const PointId *ids, point_count_t count, const void *value);
+    virtual void getFieldsInternal(Dimension::Id::Enum id,
+        const PointId *ids, point_count_t count, void *value) const;
+
+    PointLayout m_layout;
+};
+
+/// A typed view of the contiguous values of a single dimension.
+template<typename T>
+class ColumnSpan
+{
+public:
+    ColumnSpan() : m_data(NULL), m_size(0)
+        {}
+    ColumnSpan(T *data, point_count_t size) : m_data(data), m_size(size)
+        {}
+
+    T *data() const
+        { return m_data; }
+    T *begin() const
+        { return m_data; }
+    T *end() const
+        { return m_data + m_size; }
+    point_count_t size() const
+        { return m_size; }
+    bool empty() const
+        { return m_size == 0; }
+    T& operator[](PointId idx) const
+        { return m_data[idx]; }
+
+private:
+    T *m_data;
+    point_count_t m_size;
+};
+
+/// A point table that stores the values of each dimension in a separate
+/// contiguous array rather than storing complete points one after another.
+/// Algorithms that scan a few dimensions of many points can access a
+/// dimension's values directly with column().
+///
+/// Column spans are indexed by the point ID in the table, not in a view.
+/// Adding points to the table invalidates existing spans.  Since there are
+/// no point records, getPoint() isn't supported.
+class PDAL_DLL ColumnPointTable : public BasePointTable
+{
+public:
+    ColumnPointTable() : BasePointTable(m_layout), m_numPts(0), m_capacity(0)
+        {}
+    virtual bool supportsView() const
+        { return true; }
+    virtual void finalize();
+
+    /// Get the number of points in the table.
+    /// \return  Number of points in the table.
+    point_count_t numPoints() const
+        { return m_numPts; }
+
+    /// Get the values of a dimension.  The type \a T must match the type
+    /// of the dimension in the layout.  Since values may be written through
+    /// the span, getting a span of X, Y or Z makes spatial indices of views
+    /// of the table stale.
+    /// \param id  ID of the dimension.
+    /// \return  Span of the values of the dimension for all points.
+    template<typename T>
+    ColumnSpan<T> column(Dimension::Id::Enum id)
+    {
+        fieldChanged(id);
+        return ColumnSpan<T>((T *)columnData<T>(id), m_numPts);
+    }
+
+    template<typename T>
+    ColumnSpan<const T> column(Dimension::Id::Enum id) const
+    {
+        ColumnPointTable *ncThis = const_cast<ColumnPointTable *>(this);
+        return ColumnSpan<const T>((const T *)ncThis->columnData<T>(id),
+            m_numPts);
+    }
+
+protected:
+    virtual char *getPoint(PointId idx);
+
+private:
+    // Point data operations.
+    virtual PointId addPoint();
+    virtual void setFieldInternal(Dimension::Id::Enum id, PointId idx,
+        const void *value);
+    virtual void getFieldInternal(Dimension::Id::Enum id, PointId idx,
+        void *value) const;
+    virtual void setFieldsInternal(Dimension::Id::Enum id,
+        const PointId *ids, point_count_t count, const void *value);
+    virtual void getFieldsInternal(Dimension::Id::Enum id,
+        const PointId *ids, point_count_t count, void *value) const;
+
+    template<typename T>
+    char *columnData(Dimension::Id::Enum id)
+    {
+        const Dimension::Detail *d = m_layout.dimDetail(id);
+        if (!m_layout.finalized() || d->type() != Dimension::type<T>())
+            throw pdal_error("Column type doesn't match type of "
+                "dimension '" + m_layout.dimName(id) + "'.");
+        return m_columns[m_columnIdx[d->offset()]].data();
+    }
 
+    // Column data, in layout offset order.
+    std::vector<std::vector<char>> m_columns;
+    // Map from a dimension's offset in the layout to its column.
+    std::vector<std::size_t> m_columnIdx;
+    point_count_t m_numPts;
+    point_count_t m_capacity;
     PointLayout m_layout;
 };
 
@@ -185,17 +330,25 @@ public:
     virtual void finalize()
     {}
     /// Called when the contents of StreamPointTable have been consumed and
-    /// the point data will be potentially overwritten.
+    /// the point data will be potentially overwritten.  When the table
+    /// has more than one buffer, this is only called once all points have
+    /// been processed.
     virtual void reset()
     {}
     virtual point_count_t capacity() const = 0;
+    /// Number of buffers of capacity() points held by the table.  Points
+    /// in buffer N have IDs starting at N * capacity().  With more than
+    /// one buffer, streamed stages run concurrently on different buffers.
+    virtual point_count_t numBuffers() const
+        { return 1; }
 };
 
 class PDAL_DLL FixedPointTable : public StreamPointTable
 {
 public:
-    FixedPointTable(point_count_t capacity) : StreamPointTable(m_layout),
-        m_capacity(capacity)
+    FixedPointTable(point_count_t capacity, point_count_t numBuffers = 1) :
+        StreamPointTable(m_layout), m_capacity(capacity),
+        m_numBuffers(std::max(numBuffers, (point_count_t)1))
     {}
 
     virtual void finalize()
@@ -203,12 +356,14 @@ public:
         if (!m_layout.finalized())
         {
             BasePointTable::finalize();
-            m_buf.resize(pointsToBytes(m_capacity + 1));
+            m_buf.resize(pointsToBytes(m_capacity * m_numBuffers + 1));
         }
     }
 
     point_count_t capacity() const
         { return m_capacity; }
+    point_count_t numBuffers() const
+        { return m_numBuffers; }
 protected:
     virtual char *getPoint(PointId idx)
         { return m_buf.data() + pointsToBytes(idx); }
@@ -216,6 +371,7 @@ protected:
 private:
     std::vector<char> m_buf;
     point_count_t m_capacity;
+    point_count_t m_numBuffers;
     PointLayout m_layout;
 };
 
@@ -42,11 +42,12 @@
 #include <pdal/PointTable.hpp>
 #include <pdal/util/Bounds.hpp>
 
+#include <algorithm>
+#include <atomic>
 #include <memory>
 #include <queue>
 #include <set>
 #include <vector>
-#include <deque>
 
 #ifdef PDAL_COMPILER_MSVC
 #  pragma warning(disable: 4244)  // conversion from 'type1' to 'type2', possible loss of data
@@ -60,6 +61,8 @@ namespace plang
 }
 
 struct PointViewLess;
+class KD2Index;
+class KD3Index;
 class PointView;
 class PointViewIter;
 
@@ -70,6 +73,7 @@ class PDAL_DLL PointView : public PointContainer
 {
     friend class plang::BufferedInvocation;
     friend class PointIdxRef;
+    friend class Stage;
     friend struct PointViewLess;
 public:
 	PointView(PointTableRef pointTable);
@@ -93,15 +97,42 @@ public:
     inline void appendPoint(const PointView& buffer, PointId id);
     void append(const PointView& buf)
     {
-        // We use size() instead of the index end because temp points
-        // might have been placed at the end of the buffer.
-        auto thisEnd = m_index.begin() + size();
-        auto bufEnd = buf.m_index.begin() + buf.size();
-        m_index.insert(thisEnd, buf.m_index.begin(), bufEnd);
+        if (m_identity && buf.m_identity &&
+            (m_size == 0 || buf.m_base == m_base + m_size))
+        {
+            if (m_size == 0)
+                m_base = buf.m_base;
+        }
+        else
+        {
+            materializeIndex();
+            // We use size() instead of the index end because temp points
+            // might have been placed at the end of the buffer.
+            auto pos = m_index.insert(m_index.begin() + size(), buf.size(), 0);
+            for (PointId i = 0; i < buf.size(); ++i)
+                *pos++ = buf.tableId(i);
+        }
         m_size += buf.size();
         clearTemps();
+        clearSpatialIndices();
+    }
+
+    /// Reserve index space for \a count points so that a view filled by
+    /// scattered appends doesn't regrow its index.
+    /// \param count  Number of points the view is expected to hold.
+    void reserve(point_count_t count)
+    {
+        materializeIndex();
+        m_index.reserve(count);
     }
 
+    /// Reorder the points of the view.  Only the view's index changes;
+    /// point data isn't moved.
+    /// \param order  Permutation of the indices of the view's points.
+    ///   After the call, point i of the view is the point that was at
+    ///   index order[i].
+    void reorder(const std::vector<PointId>& order);
+
     /// Return a new point view with the same point table as this
     /// point buffer.
     PointViewPtr makeNew() const
@@ -124,6 +155,29 @@ public:
     inline void setField(Dimension::Id::Enum dim, Dimension::Type::Enum type,
         PointId idx, const void *val);
 
+    /// Fill a buffer with the values of a dimension for a range of points,
+    /// converted to type T.  The result is the same as calling getFieldAs()
+    /// for each point, but the dimension is resolved once and point data
+    /// is fetched from the point table in blocks.
+    /// \param dim  Dimension to fetch.
+    /// \param begin  Index of the first point.
+    /// \param end  Index past the last point.
+    /// \param buf  Buffer to fill.  Must have room for (end - begin) values.
+    template<typename T>
+    void getFieldsAs(Dimension::Id::Enum dim, PointId begin, PointId end,
+        T *buf) const;
+
+    /// Set the values of a dimension for a range of existing points from a
+    /// buffer of values of type T.  The result is the same as calling
+    /// setField() for each point.
+    /// \param dim  Dimension to set.
+    /// \param begin  Index of the first point.
+    /// \param end  Index past the last point.
+    /// \param buf  Buffer containing (end - begin) values.
+    template<typename T>
+    void setFields(Dimension::Id::Enum dim, PointId begin, PointId end,
+        const T *buf);
+
     template <typename T>
     bool compare(Dimension::Id::Enum dim, PointId id1, PointId id2)
     {
@@ -245,8 +299,10 @@ public:
 
     /// Provides access to the memory storing the point data.  Though this
     /// function is public, other access methods are safer and preferred.
+    /// Tables without point records, such as ColumnPointTable, throw
+    /// pdal_error.
     char *getPoint(PointId id)
-        { return m_pointTable.getPoint(m_index[id]); }
+        { return m_pointTable.getPoint(tableId(id)); }
 
     // The standard idiom is swapping with a stack-created empty queue, but
     // that invokes the ctor and probably allocates.  We've probably only got
@@ -258,9 +314,29 @@ public:
     }
     MetadataNode toMetadata() const;
 
+    /// Return a 2D KD index of the points of the view, building it if
+    /// necessary.  The index is kept with the view and discarded when
+    /// points are added to the view or reordered, or when X, Y or Z of a
+    /// point in the point table is set through any view or the table, so
+    /// stages run in turn on a view share one index.  Writes through
+    /// getPoint() aren't tracked.
+    /// \param threads  Number of threads used if the index is built.
+    KD2Index& build2dIndex(std::size_t threads = 1);
+
+    /// Return a 3D KD index of the points of the view, building it if
+    /// necessary.  The index is discarded as for build2dIndex().
+    /// \param threads  Number of threads used if the index is built.
+    KD3Index& build3dIndex(std::size_t threads = 1);
+
 protected:
     PointTableRef m_pointTable;
-    std::deque<PointId> m_index;
+    // Map from view index to point table ID.  When m_identity is set, the
+    // view refers to the consecutive table points starting at m_base and
+    // m_index is empty.  The index is made explicit when points are
+    // reordered or when a point that doesn't follow the others is added.
+    std::vector<PointId> m_index;
+    bool m_identity;
+    PointId m_base;
     // The index might be larger than the size to support temporary point
     // references.
     point_count_t m_size;
@@ -268,8 +344,27 @@ protected:
     std::queue<PointId> m_temps;
     SpatialReference m_spatialReference;
 
+    // Spatial indices of the points of the view.  An index refers to the
+    // view it was built for, so copies of a view start without indices.
+    // The indices are stale once the position generation of the table
+    // differs from the one they were built at.
+    struct PDAL_DLL SpatialIndices
+    {
+        SpatialIndices();
+        SpatialIndices(const SpatialIndices&);
+        SpatialIndices& operator=(const SpatialIndices&);
+        ~SpatialIndices();
+
+        void clear();
+
+        std::unique_ptr<KD2Index> m_2d;
+        std::unique_ptr<KD3Index> m_3d;
+        uint64_t m_generation;
+    };
+    SpatialIndices m_spatialIndices;
+
 private:
-    static int m_lastId;
+    static std::atomic<int> m_lastId;
 
     template<typename T_IN, typename T_OUT>
     bool convertAndSet(Dimension::Id::Enum dim, PointId idx, T_IN in);
@@ -278,7 +373,26 @@ private:
         const void *buf);
     virtual void getFieldInternal(Dimension::Id::Enum dim, PointId idx,
         void *buf) const
-    { m_pointTable.getFieldInternal(dim, m_index[idx], buf); }
+    { m_pointTable.getFieldInternal(dim, tableId(idx), buf); }
+
+    PointId tableId(PointId idx) const
+        { return m_identity ? m_base + idx : m_index[idx]; }
+    inline void tableIds(PointId begin, point_count_t count,
+        PointId *ids) const;
+    void setTableId(PointId idx, PointId id)
+    {
+        materializeIndex();
+        m_index[idx] = id;
+        clearSpatialIndices();
+    }
+    void clearSpatialIndices()
+    {
+        if (m_spatialIndices.m_2d || m_spatialIndices.m_3d)
+            m_spatialIndices.clear();
+    }
+    void clearStaleSpatialIndices();
+    inline void appendTableId(PointId id);
+    void materializeIndex();
 
     template<class T>
     T getFieldInternal(Dimension::Id::Enum dim, PointId pointIndex) const;
@@ -514,6 +628,47 @@ void PointView::setField(Dimension::Id::Enum dim, PointId idx, T val)
     }
 }
 
+template<typename T>
+void PointView::getFieldsAs(Dimension::Id::Enum dim, PointId begin,
+    PointId end, T *buf) const
+{
+    if (end > m_size)
+        throw pdal_error("Can't get fields of points that aren't in the "
+            "point view.");
+
+    PointId ids[m_fieldBlockSize];
+    while (begin < end)
+    {
+        point_count_t count =
+            (std::min)(end - begin, (point_count_t)m_fieldBlockSize);
+        tableIds(begin, count, ids);
+        m_pointTable.getTypedFields(dim, ids, count, buf);
+        begin += count;
+        buf += count;
+    }
+}
+
+
+template<typename T>
+void PointView::setFields(Dimension::Id::Enum dim, PointId begin,
+    PointId end, const T *buf)
+{
+    if (end > m_size)
+        throw pdal_error("Can't set fields of points that aren't in the "
+            "point view.");
+
+    PointId ids[m_fieldBlockSize];
+    while (begin < end)
+    {
+        point_count_t count =
+            (std::min)(end - begin, (point_count_t)m_fieldBlockSize);
+        tableIds(begin, count, ids);
+        m_pointTable.setTypedFields(dim, ids, count, buf);
+        begin += count;
+        buf += count;
+    }
+}
+
 /**
 void PointView::setFieldInternal(Dimension::Id::Enum dim, PointId idx,
     const void *value)
@@ -540,19 +695,48 @@ void PointView::setFieldInternal(Dimension::Id::Enum dim, PointId idx,
 }
 **/
 
-inline void PointView::appendPoint(const PointView& buffer, PointId id)
+inline void PointView::tableIds(PointId begin, point_count_t count,
+    PointId *ids) const
 {
-    // Invalid 'id' is a programmer error.
-    PointId rawId = buffer.m_index[id];
-    m_index.push_back(rawId);
+    if (m_identity)
+        for (point_count_t i = 0; i < count; ++i)
+            ids[i] = m_base + begin + i;
+    else
+        std::copy(m_index.begin() + begin, m_index.begin() + begin + count,
+            ids);
+}
+
+
+inline void PointView::appendTableId(PointId id)
+{
+    if (m_identity && (m_size == 0 || id == m_base + m_size))
+    {
+        if (m_size == 0)
+            m_base = id;
+    }
+    else
+    {
+        materializeIndex();
+        m_index.push_back(id);
+    }
     m_size++;
+    clearSpatialIndices();
     assert(m_temps.empty());
 }
 
 
+inline void PointView::appendPoint(const PointView& buffer, PointId id)
+{
+    // Invalid 'id' is a programmer error.
+    appendTableId(buffer.tableId(id));
+}
+
+
 // Make a temporary copy of a point by adding an entry to the index.
 inline PointId PointView::getTemp(PointId id)
 {
+    materializeIndex();
+
     PointId newid;
     if (m_temps.size())
     {
@@ -76,7 +76,7 @@ public:
             m_tmp = true;
         }
         else
-            m_buf->m_index[m_id] = r.m_buf->m_index[r.m_id];
+            m_buf->setTableId(m_id, r.m_buf->tableId(r.m_id));
         return *this;
     }
 
@@ -85,9 +85,9 @@ public:
 
     void swap(PointIdxRef& p)
     {
-        PointId id = m_buf->m_index[m_id];
-        m_buf->m_index[m_id] = p.m_buf->m_index[p.m_id];
-        p.m_buf->m_index[p.m_id] = id;
+        PointId id = m_buf->tableId(m_id);
+        m_buf->setTableId(m_id, p.m_buf->tableId(p.m_id));
+        p.m_buf->setTableId(p.m_id, id);
     }
 };
 
@@ -42,10 +42,13 @@
 
 #include <geos_c.h>
 
+#include <memory>
+
 namespace pdal
 {
 
 namespace geos { class ErrorHandler; }
+class PolygonGrid;
 
 class PDAL_DLL Polygon
 {
@@ -91,6 +94,8 @@ public:
     double area() const;
 
     bool covers(PointRef& ref) const;
+    void covers(const double *x, const double *y, point_count_t count,
+        uint8_t *out) const;
     bool equal(const Polygon& p) const;
 
     bool valid() const;
@@ -111,8 +116,11 @@ private:
 
     SpatialReference m_srs;
     GEOSContextHandle_t m_ctx;
+    std::unique_ptr<PolygonGrid> m_grid;
 
     void prepare();
+    void prepareGrid();
+    bool geosCovers(double x, double y) const;
 
     friend PDAL_DLL std::ostream& operator<<(std::ostream& ostr,
         const Polygon& p);
@@ -113,6 +113,10 @@ public:
       \ref run function of each stage in depth first order.  Each stage is run
       to completion (all points are processed) before the next stages is run.o
 
+      When a stage is thread-safe and the "threads" option is greater than
+      one, the point views provided to the stage are run concurrently.  The
+      set of output views is ordered as if the views were run serially.
+
       \param table  Point table being used for stage pipeline.  This must be
         the same \ref table used in the \ref prepare function.
     */
@@ -122,8 +126,11 @@ public:
       Execute a prepared pipeline (linked set of stages) in streaming mode.
 
       This performs the action associated with the stage by executing the
-      \ref processOne function of each stage in depth first order.  Points
+      \ref processBatch function of each stage in depth first order.  Points
       are processed up to the capacity of the provided StreamPointTable.
+      If the table has more than one buffer, the reader, the filters and
+      the last stage run on separate threads, each working on a different
+      buffer of points.
       Not all stages support streaming mode and an exception will be thrown
       when attempting to \ref execute an unsupported stage.
 
@@ -277,9 +284,23 @@ protected:
 
     void setSpatialReference(MetadataNode& m, SpatialReference const&);
 
+    /**
+      Return the number of threads the stage may use, as set with the
+      "threads" option.  A value of 0 for the option is interpreted as the
+      number of hardware threads.  While views are run concurrently, the
+      threads are divided among the views so that the total stays within
+      the option's value.
+
+      \return  Number of threads to use (at least 1).
+    */
+    std::size_t numThreads() const;
+
 private:
     bool m_debug;
     uint32_t m_verbose;
+    uint32_t m_threads;
+    // Number of views being run concurrently.
+    std::size_t m_viewThreads;
     std::vector<Stage *> m_inputs;
     LogPtr m_log;
     SpatialReference m_spatialReference;
@@ -370,6 +391,24 @@ private:
         throw pdal_error(oss.str());
     }
 
+    /**
+      Process a batch of points (streaming mode).  The default implementation
+      calls \ref processOne for each point that hasn't been skipped.
+      Implement in subclass to process points more efficiently.
+
+      \param point  Reference to the first point of the batch.  Points in
+        the batch have consecutive IDs.  The ID of the reference may be
+        changed by the function.
+      \param count  Number of points in the batch.
+      \param skips  Flags, indexed by point ID, that are set for points
+        filtered-out by previous stages.  Readers can ignore the flags.
+        Filters set the flag of each point that is to be filtered-out.
+      \return  Number of points processed.  Readers return a number less
+        than \a count when no more points are to be read.
+    */
+    virtual point_count_t processBatch(PointRef& point, point_count_t count,
+        std::vector<uint8_t>& skips);
+
     /**
       Process all points in a view.  Implement in subclass.
 
@@ -381,6 +420,17 @@ private:
         return PointViewSet();
     }
 
+    /**
+      Indicate whether \ref run can be called for different views at the
+      same time from multiple threads.  A thread-safe stage must not modify
+      its own state, the stage metadata or the log from \ref run and must
+      not add points to the point table.  Implement in subclass.
+
+      \return  Whether the stage can run views concurrently.
+    */
+    virtual bool threadSafe() const
+        { return false; }
+
     /**
       Called after all point views have been processed.  Implement in subclass.
 
@@ -390,6 +440,8 @@ private:
         {}
 
     void execute(StreamPointTable& table, std::list<Stage *>& stages);
+    void executePipelined(StreamPointTable& table,
+        std::list<Stage *>& stages);
 
     /*
       Test hook.
@@ -51,6 +51,35 @@ namespace pdal
 
 namespace FileUtils
 {
+    /**
+      State of a memory-mapped file.  If the mapping failed, \ref addr
+      returns NULL and \ref what returns an error message.
+    */
+    struct MapContext
+    {
+    public:
+        MapContext() : m_fd(-1), m_addr(nullptr), m_size(0)
+#ifdef _WIN32
+            , m_handle(nullptr)
+#endif
+        {}
+
+        void *addr() const
+            { return m_addr; }
+        uintmax_t size() const
+            { return m_size; }
+        std::string what() const
+            { return m_error; }
+
+        int m_fd;
+        void *m_addr;
+        uintmax_t m_size;
+        std::string m_error;
+#ifdef _WIN32
+        void *m_handle;
+#endif
+    };
+
     /**
       Open an existing file for reading.
 
@@ -243,6 +272,44 @@ namespace FileUtils
       \return  Stem of filename.
     */
     PDAL_DLL std::string stem(const std::string& path);
+
+    /**
+      Return the directory used for temporary files, with a trailing
+      separator.  The directory is taken from the environment (TMPDIR,
+      TMP, TEMP or TEMPDIR) and defaults to /tmp.
+
+      \return  Temporary directory.
+    */
+    PDAL_DLL std::string tempDirectory();
+
+    /**
+      Return the path of a file in the temporary directory whose name
+      starts with the prefix and ends with random characters.  The file
+      isn't created.
+
+      \param prefix  Start of the filename.
+      \return  Path of the temporary file.
+    */
+    PDAL_DLL std::string tempFilename(const std::string& prefix);
+
+    /**
+      Map an entire file into memory for reading.
+
+      \param filename  Filename.
+      \param sequential  Hint that the file will be read sequentially.
+      \return  Context of the mapping.  On failure, the context's address
+        is NULL.
+    */
+    PDAL_DLL MapContext mapFile(const std::string& filename,
+        bool sequential = false);
+
+    /**
+      Unmap a file mapped with \ref mapFile.
+
+      \param ctx  Context of the mapping.
+      \return  Context after unmapping.  On success, the address is NULL.
+    */
+    PDAL_DLL MapContext unmapFile(MapContext ctx);
 }
 
 } // namespace pdal
@@ -0,0 +1,139 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pdal_util_export.hpp"
+
+namespace pdal
+{
+
+/**
+  A fixed-size pool of worker threads.
+
+  Each worker owns a task queue.  Tasks added from outside the pool are
+  distributed round-robin among the workers.  Tasks added by a running task
+  are placed on the front of the current worker's queue.  An idle worker
+  takes work from the front of its own queue and steals from the back of the
+  queues of other workers.
+
+  The number of queued (not yet started) tasks is bounded.  Adding a task
+  from outside the pool blocks while the bound is reached.
+*/
+class PDAL_DLL ThreadPool
+{
+public:
+    typedef std::function<void()> Task;
+
+    /**
+      Create a pool and start its threads.
+
+      \param numThreads  Number of worker threads.  If 0, the number of
+        hardware threads is used.
+      \param queueSize  Maximum number of queued tasks.  If 0, four times
+        the number of threads is used.
+    */
+    ThreadPool(std::size_t numThreads, std::size_t queueSize = 0);
+
+    /**
+      Wait for queued tasks to complete and stop the threads.
+    */
+    ~ThreadPool();
+
+    /**
+      Queue a task for execution.
+
+      \param task  Task to execute.
+    */
+    void add(Task task);
+
+    /**
+      Wait until all queued and running tasks are complete.  If a task
+      threw an exception, the first exception thrown is rethrown here.
+    */
+    void join();
+
+    /**
+      Return the number of worker threads in the pool.
+
+      \return  Number of worker threads.
+    */
+    std::size_t numThreads() const
+        { return m_threads.size(); }
+
+    /**
+      Return the number of threads supported by the hardware, or 1 if that
+      can't be determined.
+
+      \return  Number of hardware threads.
+    */
+    static std::size_t hardwareThreads();
+
+private:
+    struct Queue
+    {
+        std::mutex m_mutex;
+        std::deque<Task> m_tasks;
+    };
+
+    std::vector<std::thread> m_threads;
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::size_t m_queueSize;
+    std::size_t m_next;
+    std::size_t m_queued;
+    std::size_t m_running;
+    bool m_stop;
+    std::exception_ptr m_error;
+    std::mutex m_mutex;
+    std::condition_variable m_workCv;
+    std::condition_variable m_spaceCv;
+    std::condition_variable m_doneCv;
+
+    void work(std::size_t id);
+    bool take(std::size_t id, Task& task);
+
+    ThreadPool& operator=(const ThreadPool&); // not implemented
+    ThreadPool(const ThreadPool&); // not implemented
+};
+
+} // namespace pdal
@@ -1550,30 +1550,42 @@ void DerivativeWriter::write(const PointViewPtr data)
     // need to create the min DEM
     Eigen::MatrixXd tDemData(m_GRID_SIZE_Y, m_GRID_SIZE_X);
     tDemData.setConstant(c_background);
-    for (PointId idx = 0; idx < data->size(); ++idx)
+    auto clamp = [](double t, double min, double max)
     {
-        double x = data->getFieldAs<double>(Dimension::Id::X, idx);
-        double y = data->getFieldAs<double>(Dimension::Id::Y, idx);
-        double z = data->getFieldAs<double>(Dimension::Id::Z, idx);
+        return ((t < min) ? min : ((t > max) ? max : t));
+    };
+
+    const point_count_t blockSize = 4096;
+    std::vector<double> xs(blockSize);
+    std::vector<double> ys(blockSize);
+    std::vector<double> zs(blockSize);
+    for (PointId begin = 0; begin < data->size(); begin += blockSize)
+    {
+        PointId end = (std::min)(begin + blockSize, data->size());
+        data->getFieldsAs(Dimension::Id::X, begin, end, xs.data());
+        data->getFieldsAs(Dimension::Id::Y, begin, end, ys.data());
+        data->getFieldsAs(Dimension::Id::Z, begin, end, zs.data());
 
-        auto clamp = [](double t, double min, double max)
+        for (PointId i = 0; i < end - begin; ++i)
         {
-            return ((t < min) ? min : ((t > max) ? max : t));
-        };
+            double x = xs[i];
+            double y = ys[i];
+            double z = zs[i];
 
-        int xIndex = clamp(static_cast<int>(floor((x - extent.minx) / m_GRID_DIST_X)), 0, m_GRID_SIZE_X-1);
-        int yIndex = clamp(static_cast<int>(floor((yMax - y) / m_GRID_DIST_Y)), 0, m_GRID_SIZE_Y-1);
+            int xIndex = clamp(static_cast<int>(floor((x - extent.minx) / m_GRID_DIST_X)), 0, m_GRID_SIZE_X-1);
+            int yIndex = clamp(static_cast<int>(floor((yMax - y) / m_GRID_DIST_Y)), 0, m_GRID_SIZE_Y-1);
 
-        double tDemValue = tDemData(yIndex, xIndex);
+            double tDemValue = tDemData(yIndex, xIndex);
 
-        if (tDemValue == c_background)
-        {
-            tDemData(yIndex, xIndex) = z;
-        }
-        else
-        {
-            if (z > tDemValue)
+            if (tDemValue == c_background)
+            {
                 tDemData(yIndex, xIndex) = z;
+            }
+            else
+            {
+                if (z > tDemValue)
+                    tDemData(yIndex, xIndex) = z;
+            }
         }
     }
 
@@ -0,0 +1,228 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "LasIndex.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <pdal/util/IStream.hpp>
+#include <pdal/util/OStream.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+const std::string Magic("PDALLIDX");
+const uint32_t Version = 2;
+
+// Aim for about this many points in each cell.
+const point_count_t CellPoints = 4096;
+const uint32_t MaxCells = 1024;
+
+// Ranges of a cell separated by no more than this many records are joined.
+const point_count_t MaxGap = 256;
+
+} // unnamed namespace
+
+
+void LasIndex::start(uint64_t fileSize, int64_t modTime, const BOX2D& bounds,
+    point_count_t numPoints)
+{
+    m_fileSize = fileSize;
+    m_modTime = modTime;
+    m_bounds = bounds;
+    m_numPoints = numPoints;
+    m_next = 0;
+
+    uint32_t side = (uint32_t)std::ceil(std::sqrt((double)numPoints / CellPoints));
+    m_cols = m_rows = (std::min)((std::max)(side, 1u), MaxCells);
+    m_cells.clear();
+    m_cells.resize(m_cols * m_rows);
+}
+
+
+size_t LasIndex::col(double x) const
+{
+    double width = m_bounds.maxx - m_bounds.minx;
+    if (width <= 0)
+        return 0;
+    double c = std::floor((x - m_bounds.minx) / width * m_cols);
+    return (size_t)(std::min)((std::max)(c, 0.0), (double)(m_cols - 1));
+}
+
+
+size_t LasIndex::row(double y) const
+{
+    double height = m_bounds.maxy - m_bounds.miny;
+    if (height <= 0)
+        return 0;
+    double r = std::floor((y - m_bounds.miny) / height * m_rows);
+    return (size_t)(std::min)((std::max)(r, 0.0), (double)(m_rows - 1));
+}
+
+
+void LasIndex::add(double x, double y)
+{
+    RangeList& ranges = m_cells[row(y) * m_cols + col(x)];
+    if (ranges.size() && m_next - ranges.back().second <= MaxGap)
+        ranges.back().second = m_next + 1;
+    else
+        ranges.push_back(Range(m_next, m_next + 1));
+    m_next++;
+}
+
+
+// Points outside the indexed bounds are placed in the edge cells, so
+// the edge cells are searched for bounds outside of the indexed bounds.
+LasIndex::RangeList LasIndex::query(const BOX2D& bounds) const
+{
+    RangeList ranges;
+    if (m_cells.empty())
+        return ranges;
+
+    for (size_t r = row(bounds.miny); r <= row(bounds.maxy); ++r)
+        for (size_t c = col(bounds.minx); c <= col(bounds.maxx); ++c)
+        {
+            const RangeList& cell = m_cells[r * m_cols + c];
+            ranges.insert(ranges.end(), cell.begin(), cell.end());
+        }
+    std::sort(ranges.begin(), ranges.end());
+
+    // Join overlapping and adjacent ranges.
+    RangeList merged;
+    for (const Range& range : ranges)
+    {
+        if (merged.size() && range.first <= merged.back().second)
+            merged.back().second =
+                (std::max)(merged.back().second, range.second);
+        else
+            merged.push_back(range);
+    }
+    return merged;
+}
+
+
+bool LasIndex::matches(uint64_t fileSize, int64_t modTime,
+    const BOX2D& bounds, point_count_t numPoints) const
+{
+    return m_cells.size() && m_fileSize == fileSize &&
+        m_modTime == modTime && m_bounds.equal(bounds) &&
+        m_numPoints == numPoints;
+}
+
+
+bool LasIndex::read(const std::string& filename)
+{
+    ILeStream in(filename);
+    if (!in)
+        return false;
+
+    std::string magic;
+    uint32_t version;
+    in.get(magic, Magic.size());
+    in >> version;
+    if (!in || magic != Magic || version != Version)
+        return false;
+
+    uint64_t numPoints;
+    in >> m_fileSize >> m_modTime >> numPoints >> m_bounds.minx >>
+        m_bounds.miny >> m_bounds.maxx >> m_bounds.maxy >> m_cols >> m_rows;
+    if (!in || m_cols > MaxCells || m_rows > MaxCells ||
+        numPoints > (std::numeric_limits<point_count_t>::max)())
+        return false;
+    m_numPoints = numPoints;
+
+    // A cell can't hold more ranges than there are points, and its ranges
+    // must lie within the points of the file.
+    m_cells.clear();
+    m_cells.resize(m_cols * m_rows);
+    bool valid = true;
+    for (RangeList& ranges : m_cells)
+    {
+        uint32_t count;
+        in >> count;
+        if (!in || count > m_numPoints)
+        {
+            valid = false;
+            break;
+        }
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            uint64_t begin, end;
+            in >> begin >> end;
+            if (!in || begin >= end || end > m_numPoints)
+            {
+                valid = false;
+                break;
+            }
+            ranges.push_back(Range(begin, end));
+        }
+        if (!valid)
+            break;
+    }
+    if (!valid)
+    {
+        m_cells.clear();
+        return false;
+    }
+    return true;
+}
+
+
+bool LasIndex::write(const std::string& filename) const
+{
+    OLeStream out(filename);
+    if (!out)
+        return false;
+
+    out.put(Magic);
+    out << Version << m_fileSize << m_modTime << (uint64_t)m_numPoints <<
+        m_bounds.minx << m_bounds.miny << m_bounds.maxx << m_bounds.maxy <<
+        m_cols << m_rows;
+    for (const RangeList& ranges : m_cells)
+    {
+        out << (uint32_t)ranges.size();
+        for (const Range& range : ranges)
+            out << (uint64_t)range.first << (uint64_t)range.second;
+    }
+    out.flush();
+    return (bool)out;
+}
+
+} // namespace pdal
@@ -0,0 +1,135 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pdal/pdal_internal.hpp>
+#include <pdal/util/Bounds.hpp>
+
+namespace pdal
+{
+
+/**
+  Spatial index of the points of a LAS file.  The XY bounds of the file are
+  divided into a grid of cells.  Each cell holds the ranges of point records
+  that contain its points.  Ranges separated by a small number of records
+  are joined, so a range may also contain points outside of its cell.
+*/
+class PDAL_DLL LasIndex
+{
+public:
+    /// Range of point indices, [first, second).
+    typedef std::pair<point_count_t, point_count_t> Range;
+    typedef std::vector<Range> RangeList;
+
+    LasIndex() : m_fileSize(0), m_modTime(0), m_numPoints(0), m_cols(0),
+        m_rows(0), m_next(0)
+    {}
+
+    /**
+      Start building an index.  Points are added with \ref add.
+
+      \param fileSize  Size of the indexed file, used to detect a stale index.
+      \param modTime  Modification time of the indexed file, used to detect
+        a stale index.
+      \param bounds  XY bounds of the points.
+      \param numPoints  Number of points in the file.
+    */
+    void start(uint64_t fileSize, int64_t modTime, const BOX2D& bounds,
+        point_count_t numPoints);
+
+    /**
+      Add the location of the next point in the file.
+
+      \param x  X coordinate of the point.
+      \param y  Y coordinate of the point.
+    */
+    void add(double x, double y);
+
+    /**
+      Find the point records that may contain points within bounds.
+
+      \param bounds  Bounds to query.
+      \return  Sorted, non-overlapping ranges of point indices.
+    */
+    RangeList query(const BOX2D& bounds) const;
+
+    /**
+      Determine if the index was built for a file.
+
+      \param fileSize  Size of the file.
+      \param modTime  Modification time of the file.
+      \param bounds  XY bounds of the points in the file.
+      \param numPoints  Number of points in the file.
+      \return  Whether the index matches the file.
+    */
+    bool matches(uint64_t fileSize, int64_t modTime, const BOX2D& bounds,
+        point_count_t numPoints) const;
+
+    /**
+      Read an index from a file.
+
+      \param filename  Name of index file.
+      \return  Whether a valid index was read.
+    */
+    bool read(const std::string& filename);
+
+    /**
+      Write the index to a file.
+
+      \param filename  Name of index file.
+      \return  Whether the file was written.
+    */
+    bool write(const std::string& filename) const;
+
+private:
+    uint64_t m_fileSize;
+    int64_t m_modTime;
+    BOX2D m_bounds;
+    point_count_t m_numPoints;
+    uint32_t m_cols;
+    uint32_t m_rows;
+    point_count_t m_next;
+    std::vector<RangeList> m_cells;
+
+    size_t col(double x) const;
+    size_t row(double y) const;
+};
+
+} // namespace pdal
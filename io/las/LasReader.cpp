@@ -34,6 +34,7 @@
 
 #include "LasReader.hpp"
 
+#include <ctime>
 #include <sstream>
 #include <string.h>
 
@@ -44,12 +45,14 @@
 #include <pdal/util/Extractor.hpp>
 #include <pdal/util/FileUtils.hpp>
 #include <pdal/util/IStream.hpp>
+#include <pdal/util/ThreadPool.hpp>
 #include <pdal/pdal_macros.hpp>
 
 #ifdef PDAL_HAVE_LIBGEOTIFF
 #include "GeotiffSupport.hpp"
 #endif
 #include "LasHeader.hpp"
+#include "LasIndex.hpp"
 #include "VariableLengthRecord.hpp"
 #include "ZipPoint.hpp"
 
@@ -66,6 +69,19 @@ public:
         {}
 };
 
+// Modification time of a file in seconds since the epoch, used to detect
+// a stale spatial index.
+int64_t modTime(const std::string& filename)
+{
+    struct tm t;
+    FileUtils::fileTimes(filename, nullptr, &t);
+#ifdef WIN32
+    return (int64_t)_mkgmtime(&t);
+#else
+    return (int64_t)timegm(&t);
+#endif
+}
+
 } // unnamed namespace
 
 void LasReader::processOptions(const Options& options)
@@ -93,6 +109,29 @@ void LasReader::processOptions(const Options& options)
     // Set case-corrected value.
     m_compression = compression;
 
+    m_useMmap = options.getValueOrDefault<bool>("mmap", false);
+    m_useIndex = options.getValueOrDefault<bool>("index", false);
+    m_writeIndex = options.getValueOrDefault<bool>("write_index", false);
+
+    try
+    {
+        m_bounds = options.getValueOrDefault<BOX2D>("bounds");
+    }
+    catch (Option::cant_convert)
+    {
+        try
+        {
+            m_bounds = options.getValueOrDefault<BOX3D>("bounds").to2d();
+        }
+        catch (Option::cant_convert)
+        {
+            std::ostringstream oss;
+            oss << getName() << ": Invalid bounds provided as option.  "
+                "Format: '([xmin,xmax],[ymin,ymax])'.";
+            throw pdal_error(oss.str());
+        }
+    }
+
     m_error.setFilename(m_filename);
 }
 
@@ -135,6 +174,7 @@ void LasReader::initializeLocal(PointTableRef table, MetadataNode& m)
 {
     m_error.setLog(log());
     m_header.setLog(log());
+    m_index = 0;
     createStream();
 
     std::istream *stream(m_streamIf->m_istream);
@@ -173,11 +213,23 @@ void LasReader::initializeLocal(PointTableRef table, MetadataNode& m)
 
 
 void LasReader::ready(PointTableRef table)
+{
+    if (m_useMmap && !m_header.compressed())
+        mapPoints();
+    else
+        readyStream();
+
+    m_useRanges = false;
+    if (!m_bounds.empty() && (m_useIndex || m_writeIndex))
+        readyIndex();
+}
+
+
+void LasReader::readyStream()
 {
     createStream();
     std::istream *stream(m_streamIf->m_istream);
 
-    m_index = 0;
     if (m_header.compressed())
     {
 #ifdef PDAL_HAVE_LASZIP
@@ -225,7 +277,167 @@ void LasReader::ready(PointTableRef table)
 #endif
     }
     else
-        stream->seekg(m_header.pointOffset());
+        stream->seekg(m_header.pointOffset() + m_index * m_header.pointLen());
+}
+
+
+// Load the spatial index for the file and find the point ranges to read.
+// The index is built and written only if asked for, since it's written
+// next to the input file.  Otherwise all points are read when there's no
+// usable index.
+void LasReader::readyIndex()
+{
+    const std::string filename(m_filename + ".idx");
+    const uint64_t fileSize = FileUtils::fileSize(m_filename);
+    const int64_t fileTime = modTime(m_filename);
+    const BOX2D bounds = m_header.getBounds().to2d();
+
+    LasIndex index;
+    if (!index.read(filename) ||
+        !index.matches(fileSize, fileTime, bounds, getNumPoints()))
+    {
+        if (!m_writeIndex)
+        {
+            log()->get(LogLevel::Debug) << getName() << ": No usable "
+                "spatial index '" << filename << "'.  Reading all points." <<
+                std::endl;
+            return;
+        }
+        index.start(fileSize, fileTime, bounds, getNumPoints());
+        if (!buildIndex(index))
+        {
+            log()->get(LogLevel::Warning) << getName() << ": Can't build "
+                "spatial index for compressed file '" << m_filename <<
+                "' without LAZperf.  Reading all points." << std::endl;
+            return;
+        }
+        if (!index.write(filename))
+            log()->get(LogLevel::Warning) << getName() << ": Unable to "
+                "write spatial index '" << filename << "'." << std::endl;
+    }
+    m_ranges = index.query(m_bounds);
+    m_rangeIdx = 0;
+    m_useRanges = true;
+
+    // Decode only the chunks of compressed data that hold the ranges.
+    if (m_header.compressed())
+        openChunks();
+}
+
+
+// Add the location of each point to the index.  Only XY are decoded.
+bool LasReader::buildIndex(LasIndex& index)
+{
+    const size_t pointLen = m_header.pointLen();
+    const LasHeader& h = m_header;
+
+    auto addPoints = [&index, &h, pointLen](const char *buf,
+        point_count_t count)
+    {
+        for (point_count_t i = 0; i < count; ++i)
+        {
+            LeExtractor in(buf, pointLen);
+            int32_t xi, yi;
+            in >> xi >> yi;
+            index.add(xi * h.scaleX() + h.offsetX(),
+                yi * h.scaleY() + h.offsetY());
+            buf += pointLen;
+        }
+    };
+
+    std::unique_ptr<LasStreamIf> streamIf(openStream());
+    std::istream& stream(*streamIf->m_istream);
+    if (!m_header.compressed())
+    {
+        std::vector<char> buf(pointLen * 10000);
+        stream.seekg(m_header.pointOffset());
+        point_count_t remaining = getNumPoints();
+        while (remaining && stream.good())
+        {
+            point_count_t count = std::min<point_count_t>(remaining,
+                buf.size() / pointLen);
+            stream.read(buf.data(), count * pointLen);
+            count = stream.gcount() / pointLen;
+            addPoints(buf.data(), count);
+            remaining -= count;
+        }
+        return true;
+    }
+
+#ifdef PDAL_HAVE_LAZPERF
+    if (m_header.has14Format())
+        return false;
+    VariableLengthRecord *vlr = m_header.findVlr(LASZIP_USER_ID,
+        LASZIP_RECORD_ID);
+    if (!vlr)
+        return false;
+    LazPerfVlrChunkDecompressor chunks(stream, vlr->data(),
+        m_header.pointOffset());
+    if (!chunks.valid() || chunks.pointSize() != pointLen)
+        return false;
+
+    std::vector<unsigned char> data;
+    std::vector<char> points;
+    point_count_t remaining = getNumPoints();
+    for (size_t chunk = 0; chunk < chunks.numChunks() && remaining; ++chunk)
+    {
+        point_count_t count = std::min<point_count_t>(remaining,
+            chunks.chunkSize());
+        chunks.readChunk(stream, chunk, data);
+        points.resize(count * pointLen);
+        chunks.decompress(data, points.data(), count);
+        addPoints(points.data(), count);
+        remaining -= count;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+// Map the file and find the points that it contains, which may be fewer
+// than the header claims if the file is truncated.
+void LasReader::mapPoints()
+{
+    m_map = FileUtils::mapFile(m_filename, true);
+    if (!m_map.addr())
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Unable to map '" << m_filename << "'. " <<
+            m_map.what();
+        throw pdal_error(oss.str());
+    }
+
+    uint64_t start = lasOffset() + m_header.pointOffset();
+    m_mapPos = (const char *)m_map.addr() + start;
+    m_mapPoints = 0;
+    if (start < m_map.size())
+        m_mapPoints = std::min<uint64_t>(getNumPoints(),
+            (m_map.size() - start) / m_header.pointLen());
+}
+
+
+void LasReader::seek(point_count_t idx)
+{
+    if (m_header.compressed())
+        throw pdal_error(getName() + ": Can't seek in compressed file.");
+    if (idx > getNumPoints())
+    {
+        std::ostringstream oss;
+        oss << getName() << ": Can't seek to point " << idx << ".  File '" <<
+            m_filename << "' has " << getNumPoints() << " points.";
+        throw pdal_error(oss.str());
+    }
+
+    // If the reader isn't ready, the position is set when it is.
+    m_index = idx;
+    if (m_streamIf)
+    {
+        std::istream *stream(m_streamIf->m_istream);
+        stream->clear();
+        stream->seekg(m_header.pointOffset() + idx * m_header.pointLen());
+    }
 }
 
 
@@ -235,6 +447,15 @@ Options LasReader::getDefaultOptions()
     options.add("filename", "", "file to read from");
     options.add("extra_dims", "", "Extra dimensions not part of the LAS "
         "point format to be read from each point.");
+    options.add("mmap", false, "Read uncompressed point data from a "
+        "memory-mapped file.");
+    options.add("bounds", BOX2D(), "Only read points within these XY "
+        "bounds.");
+    options.add("index", false, "Use an existing spatial index to read only "
+        "the parts of the file that may hold points within the bounds.");
+    options.add("write_index", false, "Build a spatial index and write it "
+        "next to the input file if it doesn't exist or is stale.  Implies "
+        "'index'.");
     return options;
 }
 
@@ -483,66 +704,290 @@ void LasReader::addDimensions(PointLayoutPtr layout)
 }
 
 
-bool LasReader::processOne(PointRef& point)
+// Read the record of the point at the current index and advance the index.
+// Returns NULL if there are no more points.
+const char *LasReader::readPoint()
 {
     if (m_index >= getNumPoints())
-        return false;
+        return nullptr;
 
     size_t pointLen = m_header.pointLen();
+    const char *buf = nullptr;
 
     if (m_header.compressed())
     {
-#ifdef PDAL_HAVE_LASZIP
-        if (m_compression == "LASZIP")
+#ifdef PDAL_HAVE_LAZPERF
+        if (m_chunks)
+        {
+            buf = chunkPoint(m_index);
+            if (!buf)
+                return nullptr;
+        }
+        else
+#endif
         {
-            if (!m_unzipper->read(m_zipPoint->m_lz_point))
+#ifdef PDAL_HAVE_LASZIP
+            if (m_compression == "LASZIP")
             {
-                std::string error = "Error reading compressed point data: ";
-                const char* err = m_unzipper->get_error();
-                if (!err)
-                    err = "(unknown error)";
-                error += err;
-                throw pdal_error(error);
+                if (!m_unzipper->read(m_zipPoint->m_lz_point))
+                {
+                    std::string error =
+                        "Error reading compressed point data: ";
+                    const char* err = m_unzipper->get_error();
+                    if (!err)
+                        err = "(unknown error)";
+                    error += err;
+                    throw pdal_error(error);
+                }
+                buf = (const char *)m_zipPoint->m_lz_point_data.data();
             }
-            loadPoint(point, (char *)m_zipPoint->m_lz_point_data.data(),
-                pointLen);
-        }
 #endif
 
 #ifdef PDAL_HAVE_LAZPERF
-        if (m_compression == "LAZPERF")
-        {
-            m_decompressor->decompress(m_decompressorBuf.data());
-            loadPoint(point, m_decompressorBuf.data(), pointLen);
-        }
+            if (m_compression == "LAZPERF")
+            {
+                m_decompressor->decompress(m_decompressorBuf.data());
+                buf = m_decompressorBuf.data();
+            }
 #endif
 #if !defined(PDAL_HAVE_LAZPERF) && !defined(PDAL_HAVE_LASZIP)
-        throw pdal_error("Can't read compressed file without LASzip or "
-            "LAZperf decompression library.");
+            throw pdal_error("Can't read compressed file without LASzip or "
+                "LAZperf decompression library.");
 #endif
+        }
     } // compression
+    else if (m_map.addr())
+    {
+        if (m_index >= m_mapPoints)
+            return nullptr;
+        buf = mappedPoint(m_index);
+    }
     else
     {
-        std::vector<char> buf(m_header.pointLen());
-
-        m_streamIf->m_istream->read(buf.data(), pointLen);
-        loadPoint(point, buf.data(), pointLen);
+        m_pointBuf.resize(pointLen);
+        m_streamIf->m_istream->read(m_pointBuf.data(), pointLen);
+        buf = m_pointBuf.data();
     }
     m_index++;
+    return buf;
+}
+
+
+// Set up decoding of compressed points by chunk, so that any point can be
+// read without decoding the points before its chunk.  Once set up, all
+// compressed points are read this way.  Returns false if the chunks can't be
+// decoded independently.
+bool LasReader::openChunks()
+{
+#ifdef PDAL_HAVE_LAZPERF
+    if (m_chunks)
+        return true;
+
+    // LAZperf doesn't support version 1.4 point formats.
+    if (m_header.has14Format())
+        return false;
+
+    VariableLengthRecord *vlr = m_header.findVlr(LASZIP_USER_ID,
+        LASZIP_RECORD_ID);
+    if (!vlr)
+        return false;
+
+    m_chunkStreamIf = openStream();
+    m_chunks.reset(new LazPerfVlrChunkDecompressor(
+        *m_chunkStreamIf->m_istream, vlr->data(), m_header.pointOffset()));
+    m_chunkNum = (std::numeric_limits<size_t>::max)();
+    if (!m_chunks->valid() || m_chunks->pointSize() != m_header.pointLen())
+    {
+        m_chunks.reset();
+        m_chunkStreamIf.reset();
+        return false;
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+
+#ifdef PDAL_HAVE_LAZPERF
+// Find the record of a point in a compressed file, decoding its chunk if
+// it isn't the chunk last decoded.
+const char *LasReader::chunkPoint(point_count_t idx)
+{
+    const size_t pointLen = m_header.pointLen();
+    const point_count_t chunkSize = m_chunks->chunkSize();
+
+    size_t chunk = idx / chunkSize;
+    if (chunk != m_chunkNum)
+    {
+        if (chunk >= m_chunks->numChunks())
+            return nullptr;
+        point_count_t count = std::min<point_count_t>(chunkSize,
+            getNumPoints() - chunk * chunkSize);
+        m_chunks->readChunk(*m_chunkStreamIf->m_istream, chunk, m_chunkData);
+        m_chunkPoints.resize(count * pointLen);
+        m_chunks->decompress(m_chunkData, m_chunkPoints.data(), count);
+        m_chunkNum = chunk;
+    }
+    return m_chunkPoints.data() + (idx % chunkSize) * pointLen;
+}
+#endif
+
+
+// Move to a point, decoding and discarding points if we can't seek.
+void LasReader::skipTo(point_count_t idx)
+{
+    if (!m_header.compressed())
+        seek(idx);
+    else if (m_chunks)
+        m_index = idx;
+    else
+        while (m_index < idx && readPoint())
+            ;
+}
+
+
+bool LasReader::inBounds(const char *buf) const
+{
+    LeExtractor in(buf, m_header.pointLen());
+    int32_t xi, yi;
+    in >> xi >> yi;
+    return m_bounds.contains(xi * m_header.scaleX() + m_header.offsetX(),
+        yi * m_header.scaleY() + m_header.offsetY());
+}
+
+
+// Read the record of the next point within the bounds, skipping the
+// records outside the ranges found with the spatial index.
+const char *LasReader::nextPoint()
+{
+    while (true)
+    {
+        if (m_useRanges)
+        {
+            while (m_rangeIdx < m_ranges.size() &&
+                m_index >= m_ranges[m_rangeIdx].second)
+                m_rangeIdx++;
+            if (m_rangeIdx == m_ranges.size())
+                return nullptr;
+            if (m_index < m_ranges[m_rangeIdx].first)
+                skipTo(m_ranges[m_rangeIdx].first);
+        }
+        const char *buf = readPoint();
+        if (!buf || m_bounds.empty() || inBounds(buf))
+            return buf;
+    }
+}
+
+
+bool LasReader::processOne(PointRef& point)
+{
+    const char *buf = nextPoint();
+    if (!buf)
+        return false;
+    loadPoint(point, buf, m_header.pointLen());
     return true;
 }
 
 
+point_count_t LasReader::processBatch(PointRef& point, point_count_t count,
+    std::vector<uint8_t>& /*skips*/)
+{
+    const PointId begin = point.pointId();
+
+    // Points outside of the bounds are skipped one at a time.
+    if (!m_bounds.empty())
+    {
+        for (PointId idx = begin; idx < begin + count; ++idx)
+        {
+            point.setPointId(idx);
+            if (!processOne(point))
+                return idx - begin;
+        }
+        return count;
+    }
+
+    count = std::min(count, getNumPoints() - m_index);
+
+    // Compressed points are decoded one at a time.
+    if (m_header.compressed())
+    {
+        for (PointId idx = begin; idx < begin + count; ++idx)
+        {
+            point.setPointId(idx);
+            processOne(point);
+        }
+        return count;
+    }
+
+    size_t pointLen = m_header.pointLen();
+
+    // Decode mapped points in place.
+    if (m_map.addr())
+    {
+        count = std::min(count,
+            m_mapPoints - std::min(m_index, m_mapPoints));
+        for (PointId i = 0; i < count; ++i)
+        {
+            point.setPointId(begin + i);
+            loadPoint(point, mappedPoint(m_index + i), pointLen);
+        }
+        m_index += count;
+        return count;
+    }
+
+    // Read the uncompressed points of the batch with a single read.
+    m_batchBuf.resize(count * pointLen);
+    point_count_t numRead = 0;
+    try
+    {
+        numRead = readFileBlock(m_batchBuf, count);
+    }
+    catch (invalid_stream&)
+    {}
+
+    char *pos = m_batchBuf.data();
+    for (PointId i = 0; i < numRead; ++i)
+    {
+        point.setPointId(begin + i);
+        loadPoint(point, pos, pointLen);
+        pos += pointLen;
+    }
+    m_index += numRead;
+    return numRead;
+}
+
+
 point_count_t LasReader::read(PointViewPtr view, point_count_t count)
 {
     size_t pointLen = m_header.pointLen();
+
+    if (!m_bounds.empty())
+    {
+        point_count_t numRead = 0;
+        const char *buf;
+        while (numRead < count && (buf = nextPoint()))
+        {
+            PointId id = view->size();
+            PointRef point = view->point(id);
+            loadPoint(point, buf, pointLen);
+            if (m_cb)
+                m_cb(*view, id);
+            numRead++;
+        }
+        return numRead;
+    }
+
     count = std::min(count, getNumPoints() - m_index);
 
     PointId i = 0;
     if (m_header.compressed())
     {
 #if defined(PDAL_HAVE_LAZPERF) || defined(PDAL_HAVE_LASZIP)
-        if (m_compression == "LASZIP" || m_compression == "LAZPERF")
+        point_count_t numRead;
+        if (numThreads() > 1 && readChunks(view, count, numRead))
+            i = numRead;
+        else if (m_compression == "LASZIP" || m_compression == "LAZPERF")
         {
             for (i = 0; i < count; i++)
             {
@@ -558,6 +1003,19 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
             "LAZperf decompression library.");
 #endif
     }
+    else if (m_map.addr())
+    {
+        count = std::min(count,
+            m_mapPoints - std::min(m_index, m_mapPoints));
+        for (i = 0; i < count; ++i)
+        {
+            PointId id = view->size();
+            PointRef point = view->point(id);
+            loadPoint(point, mappedPoint(m_index + i), pointLen);
+            if (m_cb)
+                m_cb(*view, id);
+        }
+    }
     else
     {
         point_count_t remaining = count;
@@ -595,6 +1053,96 @@ point_count_t LasReader::read(PointViewPtr view, point_count_t count)
 }
 
 
+// Open a stream independent of the one used to read points sequentially.
+std::unique_ptr<LasReader::LasStreamIf> LasReader::openStream()
+{
+    std::unique_ptr<LasStreamIf> save(std::move(m_streamIf));
+    createStream();
+    std::unique_ptr<LasStreamIf> streamIf(std::move(m_streamIf));
+    m_streamIf = std::move(save);
+    return streamIf;
+}
+
+
+// Decompress LAZ chunks concurrently and load the points into the view in
+// order, starting at the current point.  Returns false if the chunks can't be
+// decompressed independently.  Once chunks have been decompressed, later
+// points are read by chunk as well, since the sequential decompressor
+// hasn't advanced.
+bool LasReader::readChunks(PointViewPtr view, point_count_t count,
+    point_count_t& numRead)
+{
+#ifdef PDAL_HAVE_LAZPERF
+    if (!openChunks())
+        return false;
+
+    struct Chunk
+    {
+        std::vector<unsigned char> m_data;
+        std::vector<char> m_points;
+        point_count_t m_count;
+        point_count_t m_skip;
+    };
+
+    const LazPerfVlrChunkDecompressor& chunks(*m_chunks);
+    std::istream& stream(*m_chunkStreamIf->m_istream);
+    const size_t pointLen = m_header.pointLen();
+    const point_count_t chunkSize = chunks.chunkSize();
+
+    // Decompress a group of chunks at a time, reading the compressed data
+    // on this thread, then load their points in order.  The first chunk
+    // may hold points before the current one, which are skipped.
+    ThreadPool pool(numThreads());
+    std::vector<Chunk> group(2 * pool.numThreads());
+    size_t chunkNum = m_index / chunkSize;
+    point_count_t skip = m_index % chunkSize;
+    numRead = 0;
+    while (numRead < count && chunkNum < chunks.numChunks())
+    {
+        size_t groupSize = 0;
+        point_count_t groupCount = numRead;
+        while (groupSize < group.size() && groupCount < count &&
+            chunkNum < chunks.numChunks())
+        {
+            Chunk& c = group[groupSize++];
+            c.m_skip = skip;
+            c.m_count = std::min<point_count_t>(chunkSize - skip,
+                count - groupCount);
+            groupCount += c.m_count;
+            skip = 0;
+            chunks.readChunk(stream, chunkNum++, c.m_data);
+            c.m_points.resize((c.m_skip + c.m_count) * pointLen);
+            pool.add([&chunks, &c]()
+            {
+                chunks.decompress(c.m_data, c.m_points.data(),
+                    c.m_skip + c.m_count);
+            });
+        }
+        pool.join();
+
+        for (size_t j = 0; j < groupSize; ++j)
+        {
+            const Chunk& c = group[j];
+            const char *pos = c.m_points.data() + c.m_skip * pointLen;
+            for (point_count_t k = 0; k < c.m_count; ++k)
+            {
+                PointId id = view->size();
+                PointRef point = view->point(id);
+                loadPoint(point, pos, pointLen);
+                if (m_cb)
+                    m_cb(*view, id);
+                pos += pointLen;
+            }
+            numRead += c.m_count;
+        }
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+
 point_count_t LasReader::readFileBlock(std::vector<char>& buf,
     point_count_t maxpoints)
 {
@@ -619,7 +1167,7 @@ point_count_t LasReader::readFileBlock(std::vector<char>& buf,
 }
 
 
-void LasReader::loadPoint(PointRef& point, char *buf, size_t bufsize)
+void LasReader::loadPoint(PointRef& point, const char *buf, size_t bufsize)
 {
     if (m_header.has14Format())
         loadPointV14(point, buf, bufsize);
@@ -628,7 +1176,7 @@ void LasReader::loadPoint(PointRef& point, char *buf, size_t bufsize)
 }
 
 
-void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
+void LasReader::loadPointV10(PointRef& point, const char *buf, size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
 
@@ -696,7 +1244,7 @@ void LasReader::loadPointV10(PointRef& point, char *buf, size_t bufsize)
 
 }
 
-void LasReader::loadPointV14(PointRef& point, char *buf, size_t bufsize)
+void LasReader::loadPointV14(PointRef& point, const char *buf, size_t bufsize)
 {
     LeExtractor istream(buf, bufsize);
 
@@ -798,6 +1346,15 @@ void LasReader::done(PointTableRef)
     m_unzipper.reset();
 #endif
     m_streamIf.reset();
+    if (m_map.addr())
+        m_map = FileUtils::unmapFile(m_map);
+    m_mapPos = nullptr;
+    m_mapPoints = 0;
+    m_index = 0;
+    m_ranges.clear();
+    m_useRanges = false;
+    m_chunks.reset();
+    m_chunkStreamIf.reset();
 }
 
 } // namespace pdal
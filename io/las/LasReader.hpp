@@ -38,9 +38,11 @@
 #include <pdal/plugin.hpp>
 #include <pdal/Compression.hpp>
 #include <pdal/Reader.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #include "LasError.hpp"
 #include "LasHeader.hpp"
+#include "LasIndex.hpp"
 #include "LasUtils.hpp"
 #include "ZipPoint.hpp"
 
@@ -79,8 +81,15 @@ protected:
 
     friend class NitfReader;
 public:
-    LasReader() : pdal::Reader(), m_index(0)
+    LasReader() : pdal::Reader(), m_index(0), m_useMmap(false),
+        m_mapPos(nullptr), m_mapPoints(0), m_useIndex(false),
+        m_writeIndex(false), m_useRanges(false), m_rangeIdx(0), m_chunkNum(0)
         {}
+    ~LasReader()
+    {
+        if (m_map.addr())
+            FileUtils::unmapFile(m_map);
+    }
 
     static void * create();
     static int32_t destroy(void *);
@@ -92,6 +101,15 @@ public:
     point_count_t getNumPoints() const
         { return m_header.pointCount(); }
 
+    /**
+      Position the reader so that the next point read is the point at the
+      provided index.  Only supported for uncompressed files.  Must be
+      called after the reader has been prepared.
+
+      \param idx  Index of the next point to read.
+    */
+    void seek(point_count_t idx);
+
 protected:
     virtual void createStream()
     {
@@ -107,6 +125,12 @@ protected:
         }
     }
 
+    /**
+      Offset of the LAS data in the file being read.
+    */
+    virtual uint64_t lasOffset() const
+        { return 0; }
+
     std::unique_ptr<LasStreamIf> m_streamIf;
 
 private:
@@ -116,7 +140,24 @@ private:
     std::unique_ptr<LASunzipper> m_unzipper;
     std::unique_ptr<LazPerfVlrDecompressor> m_decompressor;
     std::vector<char> m_decompressorBuf;
+    std::vector<char> m_batchBuf;
+    std::vector<char> m_pointBuf;
     point_count_t m_index;
+    bool m_useMmap;
+    FileUtils::MapContext m_map;
+    const char *m_mapPos;
+    point_count_t m_mapPoints;
+    BOX2D m_bounds;
+    bool m_useIndex;
+    bool m_writeIndex;
+    bool m_useRanges;
+    LasIndex::RangeList m_ranges;
+    size_t m_rangeIdx;
+    std::unique_ptr<LazPerfVlrChunkDecompressor> m_chunks;
+    std::unique_ptr<LasStreamIf> m_chunkStreamIf;
+    std::vector<unsigned char> m_chunkData;
+    std::vector<char> m_chunkPoints;
+    size_t m_chunkNum;
     std::vector<ExtraDim> m_extraDims;
     std::string m_compression;
 
@@ -127,8 +168,13 @@ private:
     virtual void addDimensions(PointLayoutPtr layout);
     virtual QuickInfo inspect();
     virtual void ready(PointTableRef table);
+    void readyStream();
+    void readyIndex();
+    bool buildIndex(LasIndex& index);
     virtual point_count_t read(PointViewPtr view, point_count_t count);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(PointRef& point, point_count_t count,
+        std::vector<uint8_t>& skips);
     virtual void done(PointTableRef table);
     virtual bool eof()
         { return m_index >= getNumPoints(); }
@@ -137,12 +183,24 @@ private:
     void readExtraBytesVlr();
     void extractHeaderMetadata(MetadataNode& forward, MetadataNode& m);
     void extractVlrMetadata(MetadataNode& forward, MetadataNode& m);
-    void loadPoint(PointRef& point, char *buf, size_t bufsize);
-    void loadPointV10(PointRef& point, char *buf, size_t bufsize);
-    void loadPointV14(PointRef& point, char *buf, size_t bufsize);
+    void loadPoint(PointRef& point, const char *buf, size_t bufsize);
+    void loadPointV10(PointRef& point, const char *buf, size_t bufsize);
+    void loadPointV14(PointRef& point, const char *buf, size_t bufsize);
+    void mapPoints();
+    const char *readPoint();
+    bool openChunks();
+    const char *chunkPoint(point_count_t idx);
+    const char *nextPoint();
+    void skipTo(point_count_t idx);
+    bool inBounds(const char *buf) const;
+    const char *mappedPoint(point_count_t idx) const
+        { return m_mapPos + idx * m_header.pointLen(); }
     void loadExtraDims(LeExtractor& istream, PointRef& data);
     point_count_t readFileBlock(std::vector<char>& buf,
         point_count_t maxPoints);
+    bool readChunks(PointViewPtr view, point_count_t count,
+        point_count_t& numRead);
+    std::unique_ptr<LasStreamIf> openStream();
 
     LasReader& operator=(const LasReader&); // not implemented
     LasReader(const LasReader&); // not implemented
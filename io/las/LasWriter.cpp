@@ -686,7 +686,7 @@ void LasWriter::readyLazPerfCompression()
     addVlr(LASZIP_USER_ID, LASZIP_RECORD_ID, "http://laszip.org", data);
 
     m_compressor.reset(new LazPerfVlrCompressor(*m_ostream, schema,
-        zipvlr.chunk_size));
+        zipvlr.chunk_size, numThreads()));
 #endif
 }
 
@@ -727,6 +727,38 @@ bool LasWriter::processOne(PointRef& point)
 }
 
 
+point_count_t LasWriter::processBatch(PointRef& point, point_count_t count,
+    std::vector<uint8_t>& skips)
+{
+    const PointId begin = point.pointId();
+    size_t pointLen = m_lasHeader.pointLen();
+
+    // Fill the point buffer with all points of the batch that aren't
+    // skipped and write them at once.
+    m_pointBuf.resize(std::max(m_pointBuf.size(), count * pointLen));
+    LeInserter ostream(m_pointBuf.data(), m_pointBuf.size());
+    point_count_t filled = 0;
+    for (PointId idx = begin; idx < begin + count; ++idx)
+    {
+        if (skips[idx])
+            continue;
+        point.setPointId(idx);
+        if (fillPointBuf(point, ostream))
+            filled++;
+        else
+            skips[idx] = 1;
+    }
+
+    if (m_compression == LasCompression::LasZip)
+        writeLasZipBuf(m_pointBuf.data(), pointLen, filled);
+    else if (m_compression == LasCompression::LazPerf)
+        writeLazPerfBuf(m_pointBuf.data(), pointLen, filled);
+    else
+        m_ostream->write(m_pointBuf.data(), filled * pointLen);
+    return count;
+}
+
+
 void LasWriter::writeView(const PointViewPtr view)
 {
     Utils::writeProgress(m_progressFd, "READYVIEW",
@@ -132,6 +132,8 @@ private:
         const SpatialReference& srs);
     virtual void writeView(const PointViewPtr view);
     virtual bool processOne(PointRef& point);
+    virtual point_count_t processBatch(PointRef& point, point_count_t count,
+        std::vector<uint8_t>& skips);
     virtual void doneFile();
 
     void fillForwardList(const Options& options);
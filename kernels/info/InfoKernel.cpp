@@ -291,11 +291,12 @@ void InfoKernel::setup(const std::string& filename)
     if (m_showStats)
     {
         m_statsStage = &m_manager.makeFilter("filters.stats", *stage);
+        Options ops;
         if (m_dimensions.size())
-        {
-            Options ops({"dimensions", m_dimensions});
-            m_statsStage->addOptions(ops);
-        }
+            ops.add("dimensions", m_dimensions);
+        ops.add("median", true);
+        ops.add("threads", 0);
+        m_statsStage->addOptions(ops);
         stage = m_statsStage;
     }
     if (m_boundary)
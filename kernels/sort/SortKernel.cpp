@@ -54,7 +54,8 @@ std::string SortKernel::getName() const
 }
 
 
-SortKernel::SortKernel() : m_bCompress(false), m_bForwardMetadata(false)
+SortKernel::SortKernel() : m_bCompress(false), m_bForwardMetadata(false),
+    m_threads(1)
 {}
 
 
@@ -67,6 +68,14 @@ void SortKernel::addSwitches(ProgramArgs& args)
     args.add("metadata,m",
         "Forward metadata (VLRs, header entries, etc) from previous stages",
         m_bForwardMetadata);
+    args.add("dimension",
+        "Dimensions on which to sort, most significant first.  If not "
+        "provided, points are sorted in Morton order.\n"
+        "--dimension \"Classification, GpsTime\"", m_dimensions);
+    args.add("order", "Use with --dimension.  Sort order (ASC or DESC) of "
+        "all dimensions or of each dimension", m_order, "ASC");
+    args.add("threads", "Number of threads used to sort.  0 uses all "
+        "hardware threads", m_threads, 1u);
 }
 
 
@@ -88,7 +97,17 @@ int SortKernel::execute()
     BufferReader bufferReader;
     bufferReader.addView(inView);
 
-    Stage& sortStage = makeFilter("filters.mortonorder", bufferReader);
+    Options sortOptions;
+    sortOptions.add("threads", m_threads);
+    std::string sortName("filters.mortonorder");
+    if (m_dimensions.size())
+    {
+        sortName = "filters.sort";
+        sortOptions.add("dimension", m_dimensions);
+        sortOptions.add("order", m_order);
+    }
+    Stage& sortStage = makeFilter(sortName, bufferReader);
+    sortStage.addOptions(sortOptions);
 
     Stage& writer = makeWriter(m_outputFile, sortStage, "");
     Options writerOptions;
@@ -59,6 +59,9 @@ private:
     std::string m_outputFile;
     bool m_bCompress;
     bool m_bForwardMetadata;
+    std::string m_dimensions;
+    std::string m_order;
+    uint32_t m_threads;
 };
 
 } // namespace pdal
@@ -37,6 +37,18 @@
 #include <buffer/BufferReader.hpp>
 #include <pdal/StageFactory.hpp>
 #include <pdal/pdal_macros.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <splitter/SplitterFilter.hpp>
+#include <streamcallback/StreamCallbackFilter.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <queue>
+#include <unordered_map>
 
 namespace pdal
 {
@@ -64,6 +76,17 @@ void SplitKernel::addSwitches(ProgramArgs& args)
         std::numeric_limits<double>::quiet_NaN());
     args.add("origin_y", "Origin in Y axis for splitter cells", m_yOrigin,
         std::numeric_limits<double>::quiet_NaN());
+    args.add("stream", "Route points to per-cell files as they're read "
+        "instead of loading the whole input", m_stream);
+    args.add("max_open", "Use with --stream.  Maximum number of cell files "
+        "open at once", m_maxOpen, 64u);
+    args.add("buffers", "Use with --stream.  Number of point buffers.  With "
+        "more than one, reading overlaps routing points to cell files",
+        m_buffers, 2u);
+    args.add("strip_points", "Use with --stream and --capacity.  Largest "
+        "number of points chipped at once", m_stripPoints, 1u << 22);
+    args.add("threads", "Number of threads used by the chipper.  0 uses "
+        "all hardware threads", m_threads, 1u);
 }
 
 
@@ -79,6 +102,12 @@ void SplitKernel::validateSwitches(ProgramArgs& args)
         throw pdal_error("Can't specify for length and capacity.");
     if (!m_length && !m_capacity)
         m_capacity = 100000;
+    if (m_maxOpen == 0)
+        throw pdal_error("Option 'max_open' must be greater than 0.");
+    if (m_buffers == 0)
+        throw pdal_error("Option 'buffers' must be greater than 0.");
+    if (m_stripPoints == 0)
+        throw pdal_error("Option 'strip_points' must be greater than 0.");
     if (m_outputFile.back() == pathSeparator)
         m_outputFile += m_inputFile;
 }
@@ -95,11 +124,254 @@ std::string makeFilename(const std::string& s, int i)
     out.insert(pos, std::string("_") + std::to_string(i));
     return out;
 }
+
+
+// Spill files holding the packed points of each splitter cell.  The files
+// are placed in the temporary directory and numbered in the order their
+// cells are first seen.  At most a fixed number
+// of files are open at once; the least recently written file is closed
+// when another must be opened and is reopened for append when needed.
+class CellFiles
+{
+public:
+    CellFiles(uint32_t maxOpen) :
+        m_base(FileUtils::tempFilename("pdal_split_")), m_maxOpen(maxOpen)
+    {}
+
+    ~CellFiles()
+    {
+        for (auto& c : m_cells)
+            FileUtils::deleteFile(c.m_filename);
+    }
+
+    void write(uint64_t key, const char *buf, size_t size)
+    {
+        auto it = m_cellMap.find(key);
+        if (it == m_cellMap.end())
+        {
+            size_t n = m_cells.size();
+            m_cells.emplace_back();
+            m_cells.back().m_filename =
+                m_base + "_" + std::to_string(n + 1) + ".part";
+            it = m_cellMap.insert(std::make_pair(key, n)).first;
+        }
+        Cell& c = m_cells[it->second];
+        if (!c.m_stream.is_open())
+            open(c, it->second);
+        else
+        {
+            m_open.erase(c.m_pos);
+            m_open.push_front(it->second);
+            c.m_pos = m_open.begin();
+        }
+        c.m_stream.write(buf, size);
+        if (!c.m_stream)
+            throw pdal_error("Unable to write to '" + c.m_filename + "'.");
+        c.m_count++;
+    }
+
+    void close()
+    {
+        for (size_t n : m_open)
+            m_cells[n].m_stream.close();
+        m_open.clear();
+    }
+
+    size_t size() const
+        { return m_cells.size(); }
+    const std::string& filename(size_t n) const
+        { return m_cells[n].m_filename; }
+    point_count_t count(size_t n) const
+        { return m_cells[n].m_count; }
+
+private:
+    struct Cell
+    {
+        Cell() : m_count(0)
+        {}
+
+        std::string m_filename;
+        std::ofstream m_stream;
+        point_count_t m_count;
+        std::list<size_t>::iterator m_pos;
+    };
+
+    void open(Cell& c, size_t n)
+    {
+        if (m_open.size() >= m_maxOpen)
+        {
+            m_cells[m_open.back()].m_stream.close();
+            m_open.pop_back();
+        }
+        std::ios::openmode mode = std::ios::out | std::ios::binary |
+            (c.m_count ? std::ios::app : std::ios::trunc);
+        c.m_stream.open(c.m_filename, mode);
+        if (!c.m_stream)
+            throw pdal_error("Unable to open '" + c.m_filename + "'.");
+        m_open.push_front(n);
+        c.m_pos = m_open.begin();
+    }
+
+    std::string m_base;
+    size_t m_maxOpen;
+    std::deque<Cell> m_cells;
+    std::unordered_map<uint64_t, size_t> m_cellMap;
+    // Indices of the cells with open files, most recently written first.
+    std::list<size_t> m_open;
+};
+
+
+// Positions of the points of the input, spilled to files in the temporary
+// directory as sorted runs.  Runs are merged at most a fixed number at a
+// time.
+class PositionRuns
+{
+public:
+    PositionRuns(size_t runSize, uint32_t maxOpen) :
+        m_base(FileUtils::tempFilename("pdal_split_")), m_runSize(runSize),
+        m_maxOpen((std::max)(maxOpen, 2u)), m_numRuns(0)
+    {
+        m_buf.reserve(m_runSize);
+    }
+
+    ~PositionRuns()
+    {
+        for (auto& filename : m_runs)
+            FileUtils::deleteFile(filename);
+    }
+
+    void add(double pos)
+    {
+        m_buf.push_back(pos);
+        if (m_buf.size() == m_runSize)
+            flush();
+    }
+
+    // Return the positions at ranks step, 2 * step, ... in sorted order.
+    std::vector<double> positions(uint64_t step)
+    {
+        flush();
+        while (m_runs.size() > m_maxOpen)
+        {
+            std::list<std::string> group;
+            for (size_t i = 0; i < m_maxOpen; ++i)
+            {
+                group.push_back(m_runs.front());
+                m_runs.pop_front();
+            }
+
+            std::string filename = runFilename();
+            std::ofstream out(filename, std::ios::out | std::ios::binary);
+            m_runs.push_back(filename);
+            merge(group, [&out](double pos)
+                { out.write((const char *)&pos, sizeof(pos)); });
+            if (!out)
+                throw pdal_error("Unable to write to '" + filename + "'.");
+        }
+
+        std::vector<double> positions;
+        uint64_t rank = 0;
+        merge(m_runs, [&positions, &rank, step](double pos)
+        {
+            if (rank && rank % step == 0)
+                positions.push_back(pos);
+            rank++;
+        });
+        m_runs.clear();
+        return positions;
+    }
+
+private:
+    void flush()
+    {
+        if (m_buf.empty())
+            return;
+
+        std::sort(m_buf.begin(), m_buf.end());
+        std::string filename = runFilename();
+        std::ofstream out(filename, std::ios::out | std::ios::binary);
+        m_runs.push_back(filename);
+        out.write((const char *)m_buf.data(), m_buf.size() * sizeof(double));
+        if (!out)
+            throw pdal_error("Unable to write to '" + filename + "'.");
+        m_buf.clear();
+    }
+
+    std::string runFilename()
+        { return m_base + "_" + std::to_string(++m_numRuns) + ".run"; }
+
+    // Merge sorted runs, passing each position in order to the callback,
+    // and delete the run files.
+    template <typename CB>
+    void merge(std::list<std::string>& filenames, CB cb)
+    {
+        struct Run
+        {
+            std::ifstream m_in;
+            std::vector<double> m_buf;
+            size_t m_pos;
+
+            bool next(double& pos)
+            {
+                if (m_pos == m_buf.size())
+                {
+                    m_buf.resize(4096);
+                    m_in.read((char *)m_buf.data(),
+                        m_buf.size() * sizeof(double));
+                    m_buf.resize(m_in.gcount() / sizeof(double));
+                    m_pos = 0;
+                    if (m_buf.empty())
+                        return false;
+                }
+                pos = m_buf[m_pos++];
+                return true;
+            }
+        };
+
+        typedef std::pair<double, size_t> Head;
+        std::vector<std::unique_ptr<Run>> runs;
+        std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+        for (auto& filename : filenames)
+        {
+            std::unique_ptr<Run> run(new Run);
+            run->m_in.open(filename, std::ios::in | std::ios::binary);
+            if (!run->m_in)
+                throw pdal_error("Unable to open '" + filename + "'.");
+            run->m_pos = 0;
+            double pos;
+            if (run->next(pos))
+                heads.push(Head(pos, runs.size()));
+            runs.push_back(std::move(run));
+        }
+        while (!heads.empty())
+        {
+            Head h = heads.top();
+            heads.pop();
+            cb(h.first);
+            double pos;
+            if (runs[h.second]->next(pos))
+                heads.push(Head(pos, h.second));
+        }
+        runs.clear();
+        for (auto& filename : filenames)
+            FileUtils::deleteFile(filename);
+    }
+
+    std::string m_base;
+    size_t m_runSize;
+    size_t m_maxOpen;
+    uint32_t m_numRuns;
+    std::vector<double> m_buf;
+    std::list<std::string> m_runs;
+};
 }
 
 
 int SplitKernel::execute()
 {
+    if (m_stream)
+        return executeStreamed();
+
     PointTable table;
 
     Stage& reader = makeReader(m_inputFile, "");
@@ -110,12 +382,17 @@ int SplitKernel::execute()
     if (m_length)
     {
         filterOpts.add("length", m_length);
-        filterOpts.add("origin_x", m_xOrigin);
-        filterOpts.add("origin_y", m_yOrigin);
+        // NaN doesn't survive conversion to and from an option string, so
+        // leave the origin unset to have the splitter choose it.
+        if (!std::isnan(m_xOrigin))
+            filterOpts.add("origin_x", m_xOrigin);
+        if (!std::isnan(m_yOrigin))
+            filterOpts.add("origin_y", m_yOrigin);
     }
     else
     {
         filterOpts.add("capacity", m_capacity);
+        filterOpts.add("threads", m_threads);
     }
     f.addOptions(filterOpts);
     f.prepare(table);
@@ -136,5 +413,145 @@ int SplitKernel::execute()
     return 0;
 }
 
-} // namespace pdal
 
+// Split a file larger than memory.  Points are streamed from the reader and
+// appended to a spill file for their cell.  Each cell is then loaded and
+// written on its own, so only the points of one cell are held at a time.
+//
+// With a capacity, the cells are strips of the input in the X direction.
+// A first pass over the input spills sorted runs of the X positions, which
+// are merged to find the X values that divide the points into strips of
+// equal size.  Each strip is chipped in memory.
+int SplitKernel::executeStreamed()
+{
+    std::vector<double> cutoffs;
+    if (m_capacity)
+        cutoffs = stripCutoffs();
+
+    FixedPointTable streamTable(10000, m_buffers);
+
+    Stage& reader = makeReader(m_inputFile, "");
+    StreamCallbackFilter f;
+    f.setInput(reader);
+
+    CellFiles cells(m_maxOpen);
+    DimTypeList dims;
+    std::vector<char> buf;
+    double xOrigin = m_xOrigin;
+    double yOrigin = m_yOrigin;
+    auto route = [&](PointRef& point)
+    {
+        double x = point.getFieldAs<double>(Dimension::Id::X);
+        double y = point.getFieldAs<double>(Dimension::Id::Y);
+        point.getPackedData(dims, buf.data());
+
+        uint64_t key;
+        if (m_capacity)
+            key = std::upper_bound(cutoffs.begin(), cutoffs.end(), x) -
+                cutoffs.begin();
+        else
+        {
+            // Use the location of the first point as the origin, unless
+            // specified, as filters.splitter does.
+            if (xOrigin != xOrigin)
+                xOrigin = x;
+            if (yOrigin != yOrigin)
+                yOrigin = y;
+            key = SplitterFilter::cellKey(x, y, xOrigin, yOrigin, m_length);
+        }
+        cells.write(key, buf.data(), buf.size());
+        return true;
+    };
+    f.setCallback(route);
+    f.prepare(streamTable);
+    dims = streamTable.layout()->dimTypes();
+    buf.resize(streamTable.layout()->pointSize());
+    f.execute(streamTable);
+    cells.close();
+
+    SpatialReference srs = reader.getSpatialReference();
+    int filenum = 1;
+    for (size_t n = 0; n < cells.size(); ++n)
+    {
+        PointTable table;
+        PointLayoutPtr layout = table.layout();
+        DimTypeList cellDims;
+        for (auto& dt : dims)
+        {
+            std::string name = streamTable.layout()->dimName(dt.m_id);
+            cellDims.push_back(DimType(
+                layout->registerOrAssignDim(name, dt.m_type), dt.m_type));
+        }
+        table.finalize();
+
+        PointViewPtr view(new PointView(table, srs));
+        std::ifstream in(cells.filename(n), std::ios::in | std::ios::binary);
+        for (PointId idx = 0; idx < cells.count(n); ++idx)
+        {
+            if (!in.read(buf.data(), buf.size()))
+                throw pdal_error("Unable to read '" +
+                    cells.filename(n) + "'.");
+            view->setPackedPoint(cellDims, idx, buf.data());
+        }
+        in.close();
+        FileUtils::deleteFile(cells.filename(n));
+
+        BufferReader bufReader;
+        bufReader.addView(view);
+
+        PointViewSet pvSet;
+        if (m_capacity)
+        {
+            Options chipperOpts;
+            chipperOpts.add("capacity", m_capacity);
+            chipperOpts.add("threads", m_threads);
+            Stage& chipper = makeFilter("filters.chipper", bufReader);
+            chipper.addOptions(chipperOpts);
+            chipper.prepare(table);
+            pvSet = chipper.execute(table);
+        }
+        else
+            pvSet.insert(view);
+
+        for (auto& pvp : pvSet)
+        {
+            BufferReader chipReader;
+            chipReader.addView(pvp);
+
+            std::string filename = makeFilename(m_outputFile, filenum++);
+            Stage& writer = makeWriter(filename, chipReader, "");
+            writer.prepare(table);
+            writer.execute(table);
+        }
+    }
+    return 0;
+}
+
+
+// Find the X values that divide the input into strips of about the same
+// number of points, a multiple of the capacity.  A point whose X value
+// equals a cutoff goes to the strip after it.
+std::vector<double> SplitKernel::stripCutoffs()
+{
+    FixedPointTable streamTable(10000, m_buffers);
+
+    Stage& reader = makeReader(m_inputFile, "");
+    StreamCallbackFilter f;
+    f.setInput(reader);
+
+    PositionRuns runs(1 << 22, m_maxOpen);
+    auto spill = [&runs](PointRef& point)
+    {
+        runs.add(point.getFieldAs<double>(Dimension::Id::X));
+        return true;
+    };
+    f.setCallback(spill);
+    f.prepare(streamTable);
+    f.execute(streamTable);
+
+    uint64_t stripPoints = (std::max)(m_stripPoints / m_capacity, 1u) *
+        (uint64_t)m_capacity;
+    return runs.positions(stripPoints);
+}
+
+} // namespace pdal
@@ -54,6 +54,8 @@ public:
 private:
     void addSwitches(ProgramArgs& args);
     void validateSwitches(ProgramArgs& args);
+    int executeStreamed();
+    std::vector<double> stripCutoffs();
 
     std::string m_inputFile;
     std::string m_outputFile;
@@ -61,6 +63,11 @@ private:
     double m_length;
     double m_xOrigin;
     double m_yOrigin;
+    bool m_stream;
+    uint32_t m_maxOpen;
+    uint32_t m_buffers;
+    uint32_t m_stripPoints;
+    uint32_t m_threads;
 };
 
 } // namespace pdal
@@ -95,6 +95,9 @@ protected:
         m_streamIf.reset(new NitfStreamIf(m_filename, m_offset, m_length));
     }
 
+    virtual uint64_t lasOffset() const
+        { return m_offset; }
+
 private:
     uint64_t m_offset;
     uint64_t m_length;
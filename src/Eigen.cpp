@@ -33,10 +33,13 @@
 ****************************************************************************/
 
 #include <pdal/Eigen.hpp>
+#include <pdal/KDIndex.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include <Eigen/Dense>
 
+#include <algorithm>
 #include <vector>
 
 namespace pdal
@@ -97,4 +100,115 @@ uint8_t computeRank(PointView& view, std::vector<PointId> ids, double threshold)
     return static_cast<uint8_t>(svd.rank());
 }
 
+namespace
+{
+
+// Neighbors are found for a slab of points at a time to limit the memory
+// used by the neighbor lists.  Features of a slab are computed in blocks
+// that are processed concurrently.
+const point_count_t FeatureSlabSize = 1 << 20;
+const point_count_t FeatureBlockSize = 4096;
+
+} // unnamed namespace
+
+void computeFeatures(PointView& view, point_count_t knn, int flags,
+    std::vector<NeighborhoodFeatures>& features, double threshold,
+    std::size_t threads)
+{
+    using namespace Eigen;
+
+    point_count_t np = view.size();
+    features.resize(np);
+    if (!np)
+        return;
+
+    KD3Index& kdi = view.build3dIndex(threads);
+
+    std::vector<double> x(np), y(np), z(np);
+    view.getFieldsAs(Dimension::Id::X, 0, np, x.data());
+    view.getFieldsAs(Dimension::Id::Y, 0, np, y.data());
+    view.getFieldsAs(Dimension::Id::Z, 0, np, z.data());
+
+    std::vector<PointId> neighbors;
+    std::vector<double> sqrDists;
+    point_count_t k;
+
+    // Compute the features of the points in [b, e) of a slab starting at
+    // 'begin'.
+    auto compute = [&](PointId begin, PointId b, PointId e)
+    {
+        for (PointId i = b; i < e; ++i)
+        {
+            // Accumulate the sums of the neighbor coordinates and of their
+            // products, relative to the point to limit cancellation.
+            double sx = 0, sy = 0, sz = 0;
+            double sxx = 0, sxy = 0, sxz = 0, syy = 0, syz = 0, szz = 0;
+            const PointId *ids = neighbors.data() + (i - begin) * k;
+            for (point_count_t j = 0; j < k; ++j)
+            {
+                double dx = x[ids[j]] - x[i];
+                double dy = y[ids[j]] - y[i];
+                double dz = z[ids[j]] - z[i];
+                sx += dx;
+                sy += dy;
+                sz += dz;
+                sxx += dx * dx;
+                sxy += dx * dy;
+                sxz += dx * dz;
+                syy += dy * dy;
+                syz += dy * dz;
+                szz += dz * dz;
+            }
+
+            // Unnormalized covariance, as from computeCovariance().
+            Matrix3d B;
+            B(0, 0) = sxx - sx * sx / k;
+            B(0, 1) = B(1, 0) = sxy - sx * sy / k;
+            B(0, 2) = B(2, 0) = sxz - sx * sz / k;
+            B(1, 1) = syy - sy * sy / k;
+            B(1, 2) = B(2, 1) = syz - sy * sz / k;
+            B(2, 2) = szz - sz * sz / k;
+
+            NeighborhoodFeatures& f = features[i];
+            if (flags & (NeighborhoodFeatures::Eigenvalues |
+                NeighborhoodFeatures::Normal))
+            {
+                SelfAdjointEigenSolver<Matrix3d> solver(B,
+                    (flags & NeighborhoodFeatures::Normal) ?
+                        ComputeEigenvectors : EigenvaluesOnly);
+                if (solver.info() != Success)
+                    throw pdal_error("Cannot perform eigen decomposition.");
+                f.eigenvalues = solver.eigenvalues();
+                if (flags & NeighborhoodFeatures::Normal)
+                    f.normal = solver.eigenvectors().col(0);
+            }
+            if (flags & NeighborhoodFeatures::Rank)
+            {
+                JacobiSVD<Matrix3d> svd(B);
+                svd.setThreshold(threshold);
+                f.rank = static_cast<uint8_t>(svd.rank());
+            }
+        }
+    };
+
+    for (PointId begin = 0; begin < np; begin += FeatureSlabSize)
+    {
+        PointId end = (std::min)(begin + FeatureSlabSize, np);
+        k = kdi.knnSearch(begin, end, knn, neighbors, sqrDists, threads);
+
+        if (threads <= 1)
+        {
+            compute(begin, begin, end);
+            continue;
+        }
+        ThreadPool pool(threads);
+        for (PointId b = begin; b < end; b += FeatureBlockSize)
+        {
+            PointId e = (std::min)(b + FeatureBlockSize, end);
+            pool.add([&compute, begin, b, e](){ compute(begin, b, e); });
+        }
+        pool.join();
+    }
+}
+
 } // namespace pdal
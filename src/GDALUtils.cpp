@@ -36,6 +36,8 @@
 #include <pdal/SpatialReference.hpp>
 #include <pdal/util/Utils.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <functional>
 #include <map>
 #include <mutex>
@@ -213,6 +215,37 @@ public:
         resized as necessary.
     */
     void read(std::vector<uint8_t>& ptData);
+
+    /*
+      Read a single block, converting its values to doubles.  Blocks are
+      always full-sized, so the values of a partial block past the edge of
+      the raster are meaningless.
+
+      \param x  X coordinate of block to read.
+      \param y  Y coordinate of block to read.
+      \param data  Vector into which the block is read (Y major - X varies
+        fastest).  The vector is resized as necessary.
+    */
+    void readBlock(int x, int y, std::vector<double>& data);
+
+    int xBlockSize() const
+        { return m_xBlockSize; }
+    int yBlockSize() const
+        { return m_yBlockSize; }
+
+    /*
+      Determine whether a value is the band's nodata value.
+
+      \param v  Value to test.
+      \return  Whether the band has a nodata value and v is that value.
+    */
+    bool isNoData(double v) const
+    {
+        if (!m_hasNoData)
+            return false;
+        return std::isnan(m_noData) ? std::isnan(v) : v == m_noData;
+    }
+
 private:
     GDALDatasetH m_ds;  /// Dataset handle
     int m_bandNum;  /// Band number.  Band numbers start at 1.
@@ -220,8 +253,11 @@ private:
     int m_xTotalSize, m_yTotalSize;  /// Total size (x and y) of the raster
     int m_xBlockSize, m_yBlockSize;  /// Size (x and y) of blocks
     int m_xBlockCnt, m_yBlockCnt;    /// Number of blocks in each direction
+    GDALDataType m_type;             /// Type of band elements.
     size_t m_eltSize;                /// Size in bytes of each band element.
     std::vector<uint8_t> m_buf;      /// Block read buffer.
+    bool m_hasNoData;                /// Whether the band has a nodata value.
+    double m_noData;                 /// Nodata value of the band.
 
     /*
       Read a block's worth of data.
@@ -256,6 +292,13 @@ BandReader::BandReader(GDALDatasetH ds, int bandNum) : m_ds(ds),
 
     m_xBlockCnt = ((m_xTotalSize - 1) / m_xBlockSize) + 1;
     m_yBlockCnt = ((m_yTotalSize - 1) / m_yBlockSize) + 1;
+
+    m_type = GDALGetRasterDataType(m_band);
+    m_eltSize = GDALGetDataTypeSize(m_type) / CHAR_BIT;
+
+    int hasNoData = 0;
+    m_noData = GDALGetRasterNoDataValue(m_band, &hasNoData);
+    m_hasNoData = (hasNoData != 0);
 }
 
 
@@ -267,8 +310,6 @@ BandReader::BandReader(GDALDatasetH ds, int bandNum) : m_ds(ds),
 */
 void BandReader::read(std::vector<uint8_t>& ptData)
 {
-    GDALDataType t = GDALGetRasterDataType(m_band);
-    m_eltSize = GDALGetDataTypeSize(t) / CHAR_BIT;
     m_buf.resize(m_xBlockSize * m_yBlockSize * m_eltSize);
     ptData.resize(m_xTotalSize * m_yTotalSize * m_eltSize);
 
@@ -324,12 +365,25 @@ void BandReader::readBlock(int x, int y, uint8_t *data)
 }
 
 
+void BandReader::readBlock(int x, int y, std::vector<double>& data)
+{
+    m_buf.resize(m_xBlockSize * m_yBlockSize * m_eltSize);
+    if (GDALReadBlock(m_band, x, y, m_buf.data()) != CPLE_None)
+        throw CantReadBlock();
+
+    data.resize(m_xBlockSize * m_yBlockSize);
+    GDALCopyWords(m_buf.data(), m_type, (int)m_eltSize, data.data(),
+        GDT_Float64, sizeof(double), (int)data.size());
+}
+
+
 Raster::Raster(const std::string& filename)
     : m_filename(filename)
     , m_raster_x_size(0)
     , m_raster_y_size(0)
     , m_band_count(0)
     , m_ds(0)
+    , m_cacheSize(64 * 1024 * 1024)
 {
     m_forward_transform.fill(0);
     m_forward_transform[1] = 1;
@@ -526,28 +580,195 @@ GDALError::Enum Raster::read(double x, double y, std::vector<double>& data)
     int32_t line(0);
     data.resize(m_band_count);
 
-    std::array<double, 2> pix = { {0.0, 0.0} };
-
     // No data at this x,y if we can't compute a pixel/line location
     // for it.
     if (!getPixelAndLinePosition(x, y, pixel, line))
         return GDALError::NoData;
 
-    for (int i=0; i < m_band_count; ++i)
+    GDALError::Enum error = initBandReaders();
+    if (error != GDALError::None)
+        return error;
+
+    try
     {
-        GDALRasterBandH b = GDALGetRasterBand(m_ds, i+1);
-        if (GDALRasterIO(b, GF_Read, pixel, line, 1, 1,
-            &pix[0], 1, 1, GDT_CFloat64, 0, 0) == CE_None)
+        for (int i = 0; i < m_band_count; ++i)
+            data[i] = value(i + 1, pixel, line);
+    }
+    catch (CantReadBlock)
+    {
+        std::ostringstream oss;
+        oss << "Unable to read block for for raster '" << m_filename << "'.";
+        m_errorMsg = oss.str();
+        return GDALError::CantReadBlock;
+    }
+
+    return GDALError::None;
+}
+
+
+GDALError::Enum Raster::read(const double *x, const double *y,
+    point_count_t count, const std::vector<int>& bands,
+    std::vector<double>& data, std::vector<uint8_t>& valid, bool bilinear)
+{
+    if (!m_ds)
+        return GDALError::NotOpen;
+
+    GDALError::Enum error = initBandReaders();
+    if (error != GDALError::None)
+        return error;
+
+    for (int band : bands)
+        if (band < 1 || band > m_band_count)
+        {
+            std::ostringstream oss;
+            oss << "Unable to get band " << band << " from raster '" <<
+                m_filename << "'.";
+            m_errorMsg = oss.str();
+            return GDALError::InvalidBand;
+        }
+
+    size_t numBands = bands.size();
+    data.resize(count * numBands);
+    valid.resize(count);
+
+    try
+    {
+        for (point_count_t i = 0; i < count; ++i)
         {
-            // we read a pixel put its values in our vector
-            data[i] = pix[0];
+            int32_t pixel(0);
+            int32_t line(0);
+            valid[i] = getPixelAndLinePosition(x[i], y[i], pixel, line);
+            if (!valid[i])
+                continue;
+
+            double *d = data.data() + i * numBands;
+            if (!bilinear)
+            {
+                for (size_t b = 0; b < numBands; ++b)
+                    d[b] = value(bands[b], pixel, line);
+                continue;
+            }
+
+            // Position relative to the pixel centers.  Pixels past the
+            // edges of the raster are replaced by the edge pixels.  Nodata
+            // pixels are left out and the others reweighted.  If all the
+            // pixels with weight are nodata, so is the result.
+            double u = m_inverse_transform[0] + m_inverse_transform[1] * x[i] +
+                m_inverse_transform[2] * y[i] - .5;
+            double v = m_inverse_transform[3] + m_inverse_transform[4] * x[i] +
+                m_inverse_transform[5] * y[i] - .5;
+            double p = std::floor(u);
+            double l = std::floor(v);
+            double fu = u - p;
+            double fv = v - l;
+            auto clamp = [](double val, int size)
+                { return (int)(std::min)((std::max)(val, 0.0), size - 1.0); };
+            int p0 = clamp(p, m_raster_x_size);
+            int p1 = clamp(p + 1, m_raster_x_size);
+            int l0 = clamp(l, m_raster_y_size);
+            int l1 = clamp(l + 1, m_raster_y_size);
+            const int pixels[4][2] =
+                { { p0, l0 }, { p1, l0 }, { p0, l1 }, { p1, l1 } };
+            const double weights[4] =
+                { (1 - fu) * (1 - fv), fu * (1 - fv),
+                  (1 - fu) * fv, fu * fv };
+            for (size_t b = 0; b < numBands; ++b)
+            {
+                int band = bands[b];
+                const BandReader& reader = *m_bandReaders[band - 1];
+                double sum = 0;
+                double weight = 0;
+                double noData = 0;
+                for (int n = 0; n < 4; ++n)
+                {
+                    if (weights[n] == 0)
+                        continue;
+                    double val = value(band, pixels[n][0], pixels[n][1]);
+                    if (reader.isNoData(val))
+                    {
+                        noData = val;
+                        continue;
+                    }
+                    sum += weights[n] * val;
+                    weight += weights[n];
+                }
+                d[b] = (weight > 0) ? sum / weight : noData;
+            }
         }
     }
+    catch (CantReadBlock)
+    {
+        std::ostringstream oss;
+        oss << "Unable to read block for for raster '" << m_filename << "'.";
+        m_errorMsg = oss.str();
+        return GDALError::CantReadBlock;
+    }
+    return GDALError::None;
+}
 
+
+GDALError::Enum Raster::initBandReaders()
+{
+    if (m_bandReaders.size())
+        return GDALError::None;
+
+    try
+    {
+        for (int i = 0; i < m_band_count; ++i)
+            m_bandReaders.push_back(std::unique_ptr<BandReader>(
+                new BandReader(m_ds, i + 1)));
+    }
+    catch (InvalidBand)
+    {
+        std::ostringstream oss;
+        oss << "Unable to get band " << (m_bandReaders.size() + 1) <<
+            " from raster '" << m_filename << "'.";
+        m_errorMsg = oss.str();
+        m_bandReaders.clear();
+        return GDALError::InvalidBand;
+    }
     return GDALError::None;
 }
 
 
+// Return the value of a band at a pixel, reading and caching the block
+// that contains the pixel if it isn't cached.  Throws CantReadBlock.
+double Raster::value(int band, int pixel, int line)
+{
+    BandReader& reader = *m_bandReaders[band - 1];
+    int xSize = reader.xBlockSize();
+    int ySize = reader.yBlockSize();
+    uint64_t key = ((uint64_t)band << 48) |
+        ((uint64_t)(line / ySize) << 24) | (uint64_t)(pixel / xSize);
+
+    if (m_blocks.empty() || m_blocks.front().m_key != key)
+    {
+        auto it = m_blockIndex.find(key);
+        if (it != m_blockIndex.end())
+            m_blocks.splice(m_blocks.begin(), m_blocks, it->second);
+        else
+        {
+            // Reuse the storage of the least recently used block if the
+            // cache is full.
+            std::vector<double> data;
+            size_t blockBytes = xSize * ySize * sizeof(double);
+            size_t maxBlocks = (std::max)(m_cacheSize / blockBytes,
+                (size_t)m_band_count);
+            if (m_blocks.size() >= maxBlocks)
+            {
+                m_blockIndex.erase(m_blocks.back().m_key);
+                data.swap(m_blocks.back().m_data);
+                m_blocks.pop_back();
+            }
+            reader.readBlock(pixel / xSize, line / ySize, data);
+            m_blocks.push_front(CachedBlock { key, std::move(data) });
+            m_blockIndex[key] = m_blocks.begin();
+        }
+    }
+    return m_blocks.front().m_data[(line % ySize) * xSize + (pixel % xSize)];
+}
+
+
 SpatialReference Raster::getSpatialRef() const
 {
     SpatialReference srs;
@@ -566,6 +787,9 @@ Raster::~Raster()
 
 void Raster::close()
 {
+    m_blockIndex.clear();
+    m_blocks.clear();
+    m_bandReaders.clear();
     if (m_ds != 0)
     {
         GDALClose(m_ds);
@@ -120,8 +120,14 @@ void PipelineReaderJSON::parsePipeline(Json::Value& tree)
                 options.add("filename", filename);
         }
         // s should be valid at this point.  makeXXX will throw if the stage
-        // couldn't be constructed.
+        // couldn't be constructed.  Options specified for the stage replace
+        // common options, but options given for the stage on the command
+        // line still take precedence.
+        s->removeOptions(options);
         s->addOptions(options);
+        Options& cmdOptions = m_manager.stageOptions(*s);
+        s->removeOptions(cmdOptions);
+        s->addOptions(cmdOptions);
         if (tag.size())
             tags[tag] = s;
     }
@@ -138,6 +144,7 @@ void PipelineReaderJSON::readPipeline(std::istream& input)
     Json::Value& subtree = root["pipeline"];
     if (!subtree)
         throw pdal_error("JSON pipeline: Root element is not a Pipeline");
+    parseThreads(root);
     parsePipeline(subtree);
 }
 
@@ -168,6 +175,24 @@ void PipelineReaderJSON::readPipeline(const std::string& filename)
 }
 
 
+// A "threads" member of the pipeline object sets the number of threads
+// for every stage that doesn't specify its own.
+void PipelineReaderJSON::parseThreads(Json::Value& root)
+{
+    if (!root.isMember("threads"))
+        return;
+
+    Json::Value& val = root["threads"];
+    if (!val.isUInt())
+        throw pdal_error("JSON pipeline: 'threads' must be specified as "
+            "a non-negative integer.");
+
+    Options& common = m_manager.commonOptions();
+    common.remove(Option("threads", 0));
+    common.add("threads", val.asUInt());
+}
+
+
 std::string PipelineReaderJSON::extractType(Json::Value& node)
 {
     std::string type;
@@ -62,6 +62,7 @@ private:
     void readPipeline(const std::string& filename);
     void readPipeline(std::istream& input);
     void parsePipeline(Json::Value&);
+    void parseThreads(Json::Value& root);
     std::string extractType(Json::Value& node);
     std::string extractFilename(Json::Value& node);
     std::string extractTag(Json::Value& node, TagMap& tags);
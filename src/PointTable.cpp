@@ -37,6 +37,10 @@
 namespace pdal
 {
 
+// Definition for uses of the block size that bind it to a reference, such
+// as passing it to std::min.
+const point_count_t PointContainer::m_fieldBlockSize;
+
 MetadataNode BasePointTable::privateMetadata(const std::string& name)
 {
     MetadataNode mp = m_metadata->m_private;
@@ -50,6 +54,7 @@ MetadataNode BasePointTable::privateMetadata(const std::string& name)
 void SimplePointTable::setFieldInternal(Dimension::Id::Enum id, PointId idx,
     const void *value)
 {
+    fieldChanged(id);
     const Dimension::Detail *d = m_layoutRef.dimDetail(id);
     const char *src  = (const char *)value;
     char *dst = getDimension(d, idx);
@@ -67,6 +72,32 @@ void SimplePointTable::getFieldInternal(Dimension::Id::Enum id, PointId idx,
 }
 
 
+void SimplePointTable::setFieldsInternal(Dimension::Id::Enum id,
+    const PointId *ids, point_count_t count, const void *value)
+{
+    fieldChanged(id);
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const std::size_t size = d->size();
+    const char *src = (const char *)value;
+    for (point_count_t i = 0; i < count; ++i, src += size)
+        std::copy(src, src + size, getDimension(d, ids[i]));
+}
+
+
+void SimplePointTable::getFieldsInternal(Dimension::Id::Enum id,
+    const PointId *ids, point_count_t count, void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const std::size_t size = d->size();
+    char *dst = (char *)value;
+    for (point_count_t i = 0; i < count; ++i, dst += size)
+    {
+        const char *src = getDimension(d, ids[i]);
+        std::copy(src, src + size, dst);
+    }
+}
+
+
 PointTable::~PointTable()
 {
     for (auto vi = m_blocks.begin(); vi != m_blocks.end(); ++vi)
@@ -93,6 +124,139 @@ char *PointTable::getPoint(PointId idx)
 }
 
 
+// Find the point data in the blocks directly rather than calling the
+// virtual getPoint() for each point.
+void PointTable::setFieldsInternal(Dimension::Id::Enum id,
+    const PointId *ids, point_count_t count, const void *value)
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const std::size_t size = d->size();
+    const std::size_t pointSize = m_layoutRef.pointSize();
+    const char *src = (const char *)value;
+    for (point_count_t i = 0; i < count; ++i, src += size)
+    {
+        const PointId idx = ids[i];
+        char *dst = m_blocks[idx / m_blockPtCnt] +
+            pointSize * (idx % m_blockPtCnt) + d->offset();
+        std::copy(src, src + size, dst);
+    }
+    fieldChanged(id);
+}
+
+
+void PointTable::getFieldsInternal(Dimension::Id::Enum id,
+    const PointId *ids, point_count_t count, void *value) const
+{
+    const Dimension::Detail *d = m_layoutRef.dimDetail(id);
+    const std::size_t size = d->size();
+    const std::size_t pointSize = m_layoutRef.pointSize();
+    char *dst = (char *)value;
+    for (point_count_t i = 0; i < count; ++i, dst += size)
+    {
+        const PointId idx = ids[i];
+        const char *src = m_blocks[idx / m_blockPtCnt] +
+            pointSize * (idx % m_blockPtCnt) + d->offset();
+        std::copy(src, src + size, dst);
+    }
+}
+
+
+void ColumnPointTable::finalize()
+{
+    if (m_layout.finalized())
+        return;
+
+    BasePointTable::finalize();
+    m_columnIdx.resize(m_layout.pointSize());
+    for (const auto& id : m_layout.dims())
+    {
+        const Dimension::Detail *d = m_layout.dimDetail(id);
+        m_columnIdx[d->offset()] = m_columns.size();
+        m_columns.push_back(std::vector<char>(d->size() * m_capacity));
+    }
+}
+
+
+PointId ColumnPointTable::addPoint()
+{
+    if (!m_layout.finalized())
+        throw pdal_error("Can't add points to a ColumnPointTable before "
+            "its layout is finalized.");
+
+    if (m_numPts == m_capacity)
+    {
+        m_capacity = (std::max)((point_count_t)1024, m_capacity * 2);
+        for (const auto& id : m_layout.dims())
+        {
+            const Dimension::Detail *d = m_layout.dimDetail(id);
+            m_columns[m_columnIdx[d->offset()]].resize(
+                d->size() * m_capacity);
+        }
+    }
+    return m_numPts++;
+}
+
+
+// Columns have no point records to point into.  Packed point access
+// through PointView::getPackedPoint() and setPackedPoint() works
+// dimension by dimension and is supported.
+char *ColumnPointTable::getPoint(PointId /*idx*/)
+{
+    throw pdal_error("ColumnPointTable doesn't support access to "
+        "point records.  Use field or packed point access instead.");
+}
+
+
+void ColumnPointTable::setFieldInternal(Dimension::Id::Enum id, PointId idx,
+    const void *value)
+{
+    fieldChanged(id);
+    const Dimension::Detail *d = m_layout.dimDetail(id);
+    const char *src = (const char *)value;
+    char *dst = m_columns[m_columnIdx[d->offset()]].data() + idx * d->size();
+    std::copy(src, src + d->size(), dst);
+}
+
+
+void ColumnPointTable::getFieldInternal(Dimension::Id::Enum id, PointId idx,
+    void *value) const
+{
+    const Dimension::Detail *d = m_layout.dimDetail(id);
+    const char *src =
+        m_columns[m_columnIdx[d->offset()]].data() + idx * d->size();
+    char *dst = (char *)value;
+    std::copy(src, src + d->size(), dst);
+}
+
+
+void ColumnPointTable::setFieldsInternal(Dimension::Id::Enum id,
+    const PointId *ids, point_count_t count, const void *value)
+{
+    fieldChanged(id);
+    const Dimension::Detail *d = m_layout.dimDetail(id);
+    const std::size_t size = d->size();
+    char *col = m_columns[m_columnIdx[d->offset()]].data();
+    const char *src = (const char *)value;
+    for (point_count_t i = 0; i < count; ++i, src += size)
+        std::copy(src, src + size, col + ids[i] * size);
+}
+
+
+void ColumnPointTable::getFieldsInternal(Dimension::Id::Enum id,
+    const PointId *ids, point_count_t count, void *value) const
+{
+    const Dimension::Detail *d = m_layout.dimDetail(id);
+    const std::size_t size = d->size();
+    const char *col = m_columns[m_columnIdx[d->offset()]].data();
+    char *dst = (char *)value;
+    for (point_count_t i = 0; i < count; ++i, dst += size)
+    {
+        const char *src = col + ids[i] * size;
+        std::copy(src, src + size, dst);
+    }
+}
+
+
 MetadataNode BasePointTable::toMetadata() const
 {
     const PointLayoutPtr l(layout());
@@ -34,22 +34,24 @@
 
 #include <iomanip>
 
+#include <pdal/KDIndex.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/PointViewIter.hpp>
 
 namespace pdal
 {
 
-int PointView::m_lastId = 0;
+std::atomic<int> PointView::m_lastId(0);
 
 PointView::PointView(PointTableRef pointTable) : m_pointTable(pointTable),
-m_size(0), m_id(0)
+m_identity(true), m_base(0), m_size(0), m_id(0)
 {
 	m_id = ++m_lastId;
 }
 
 PointView::PointView(PointTableRef pointTable, const SpatialReference& srs) :
-	m_pointTable(pointTable), m_size(0), m_id(0), m_spatialReference(srs)
+	m_pointTable(pointTable), m_identity(true), m_base(0), m_size(0), m_id(0),
+	m_spatialReference(srs)
 {
 	m_id = ++m_lastId;
 }
@@ -73,9 +75,7 @@ void PointView::setFieldInternal(Dimension::Id::Enum dim, PointId idx,
     if (idx == size())
     {
         rawId = m_pointTable.addPoint();
-        m_index.push_back(rawId);
-        m_size++;
-        assert(m_temps.empty());
+        appendTableId(rawId);
     }
     else if (idx > size())
     {
@@ -85,12 +85,106 @@ void PointView::setFieldInternal(Dimension::Id::Enum dim, PointId idx,
     }
     else
     {
-        rawId = m_index[idx];
+        rawId = tableId(idx);
     }
     m_pointTable.setFieldInternal(dim, rawId, buf);
 }
 
 
+// Discard the spatial indices if X, Y or Z of a point of the table has been
+// set since they were built.
+void PointView::clearStaleSpatialIndices()
+{
+    if (m_spatialIndices.m_generation != m_pointTable.positionGeneration())
+        clearSpatialIndices();
+}
+
+
+KD2Index& PointView::build2dIndex(std::size_t threads)
+{
+    clearStaleSpatialIndices();
+    std::unique_ptr<KD2Index>& index = m_spatialIndices.m_2d;
+    if (!index)
+    {
+        // Positions set while the index is built would make it stale as
+        // well, so the generation is taken first.
+        m_spatialIndices.m_generation = m_pointTable.positionsIndexed();
+        std::unique_ptr<KD2Index> newIndex(new KD2Index(*this));
+        newIndex->build(threads);
+        index = std::move(newIndex);
+    }
+    return *index;
+}
+
+
+KD3Index& PointView::build3dIndex(std::size_t threads)
+{
+    clearStaleSpatialIndices();
+    std::unique_ptr<KD3Index>& index = m_spatialIndices.m_3d;
+    if (!index)
+    {
+        m_spatialIndices.m_generation = m_pointTable.positionsIndexed();
+        std::unique_ptr<KD3Index> newIndex(new KD3Index(*this));
+        newIndex->build(threads);
+        index = std::move(newIndex);
+    }
+    return *index;
+}
+
+
+PointView::SpatialIndices::SpatialIndices() : m_generation(0)
+{}
+
+
+PointView::SpatialIndices::SpatialIndices(const SpatialIndices&) :
+    m_generation(0)
+{}
+
+
+PointView::SpatialIndices& PointView::SpatialIndices::operator=(
+    const SpatialIndices&)
+{
+    clear();
+    return *this;
+}
+
+
+PointView::SpatialIndices::~SpatialIndices()
+{}
+
+
+void PointView::SpatialIndices::clear()
+{
+    m_2d.reset();
+    m_3d.reset();
+}
+
+
+void PointView::materializeIndex()
+{
+    if (!m_identity)
+        return;
+
+    m_index.resize(m_size);
+    for (PointId i = 0; i < m_size; ++i)
+        m_index[i] = m_base + i;
+    m_identity = false;
+}
+
+
+void PointView::reorder(const std::vector<PointId>& order)
+{
+    assert(order.size() == m_size);
+
+    materializeIndex();
+    std::vector<PointId> ids(m_size);
+    for (PointId i = 0; i < m_size; ++i)
+        ids[i] = m_index[order[i]];
+    std::copy(ids.begin(), ids.end(), m_index.begin());
+    clearSpatialIndices();
+}
+
+
 void PointView::calculateBounds(BOX2D& output) const
 {
     for (PointId idx = 0; idx < size(); idx++)
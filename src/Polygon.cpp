@@ -35,6 +35,8 @@
 #include <pdal/Polygon.hpp>
 #include "cpl_string.h"
 
+#include "PolygonGrid.hpp"
+
 #include <ogr_geometry.h>
 
 namespace pdal
@@ -123,7 +125,49 @@ void Polygon::prepare()
         m_prepGeom = GEOSPrepare_r(m_ctx, m_geom);
         if (!m_prepGeom)
             throw pdal_error("unable to prepare geometry for index-accelerated access");
+        prepareGrid();
+    }
+}
+
+
+// Build the native index used to test whether points are covered.  Only
+// polygons and multipolygons are indexed.  Other geometries are tested
+// with GEOS.
+void Polygon::prepareGrid()
+{
+    m_grid.reset();
+    int gtype = GEOSGeomTypeId_r(m_ctx, m_geom);
+    if (gtype != GEOS_POLYGON && gtype != GEOS_MULTIPOLYGON)
+        return;
+
+    std::unique_ptr<PolygonGrid> grid(new PolygonGrid);
+    auto addRing = [this, &grid](const GEOSGeometry *ring)
+    {
+        const GEOSCoordSequence *coords = GEOSGeom_getCoordSeq_r(m_ctx, ring);
+        uint32_t count(0);
+        GEOSCoordSeq_getSize_r(m_ctx, coords, &count);
+
+        std::vector<double> x(count);
+        std::vector<double> y(count);
+        for (unsigned i = 0; i < count; ++i)
+        {
+            GEOSCoordSeq_getX_r(m_ctx, coords, i, &x[i]);
+            GEOSCoordSeq_getY_r(m_ctx, coords, i, &y[i]);
+        }
+        grid->addRing(x, y);
+    };
+
+    int numPolys = GEOSGetNumGeometries_r(m_ctx, m_geom);
+    for (int i = 0; i < numPolys; ++i)
+    {
+        const GEOSGeometry *poly = GEOSGetGeometryN_r(m_ctx, m_geom, i);
+        addRing(GEOSGetExteriorRing_r(m_ctx, poly));
+        int numHoles = GEOSGetNumInteriorRings_r(m_ctx, poly);
+        for (int j = 0; j < numHoles; ++j)
+            addRing(GEOSGetInteriorRingN_r(m_ctx, poly, j));
     }
+    grid->build();
+    m_grid = std::move(grid);
 }
 
 Polygon& Polygon::operator=(const Polygon& input)
@@ -347,20 +391,36 @@ double Polygon::area() const
 
 bool Polygon::covers(PointRef& ref) const
 {
-    GEOSCoordSequence* coords = GEOSCoordSeq_create_r(m_ctx, 1, 3);
-    if (!coords)
-        throw pdal_error("Unable to allocate coordinate sequence");
-
     const double x = ref.getFieldAs<double>(Dimension::Id::X);
     const double y = ref.getFieldAs<double>(Dimension::Id::Y);
-    const double z = ref.getFieldAs<double>(Dimension::Id::Z);
+
+    if (m_grid)
+        return m_grid->covers(x, y);
+    return geosCovers(x, y);
+}
+
+
+void Polygon::covers(const double *x, const double *y, point_count_t count,
+    uint8_t *out) const
+{
+    if (m_grid)
+        m_grid->covers(x, y, count, out);
+    else
+        for (point_count_t i = 0; i < count; ++i)
+            out[i] = geosCovers(x[i], y[i]);
+}
+
+
+bool Polygon::geosCovers(double x, double y) const
+{
+    GEOSCoordSequence* coords = GEOSCoordSeq_create_r(m_ctx, 1, 2);
+    if (!coords)
+        throw pdal_error("Unable to allocate coordinate sequence");
 
     if (!GEOSCoordSeq_setX_r(m_ctx, coords, 0, x))
         throw pdal_error("unable to set x for coordinate sequence");
     if (!GEOSCoordSeq_setY_r(m_ctx, coords, 0, y))
         throw pdal_error("unable to set y for coordinate sequence");
-    if (!GEOSCoordSeq_setZ_r(m_ctx, coords, 0, z))
-        throw pdal_error("unable to set z for coordinate sequence");
     GEOSGeometry* p = GEOSGeom_createPoint_r(m_ctx, coords);
     if (!p)
         throw pdal_error("unable to allocate candidate test point");
@@ -0,0 +1,269 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include "PolygonGrid.hpp"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace pdal
+{
+
+namespace
+{
+
+// Number of grid cells per edge, and the limits on the size of the grid.
+const size_t CellsPerEdge = 16;
+const size_t MinCells = 16;
+const size_t MaxCells = 1 << 22;
+
+} // unnamed namespace
+
+
+void PolygonGrid::addRing(const std::vector<double>& x,
+    const std::vector<double>& y)
+{
+    size_t n = x.size();
+    for (size_t i = 0; i < n; ++i)
+    {
+        size_t j = (i + 1) % n;
+        if (x[i] == x[j] && y[i] == y[j])
+            continue;
+        m_edges.push_back(Edge { x[i], y[i], x[j], y[j] });
+    }
+}
+
+
+void PolygonGrid::build()
+{
+    if (m_edges.empty())
+        return;
+
+    m_minx = m_maxx = m_edges[0].x0;
+    m_miny = m_maxy = m_edges[0].y0;
+    for (const Edge& e : m_edges)
+    {
+        m_minx = (std::min)(m_minx, (std::min)(e.x0, e.x1));
+        m_maxx = (std::max)(m_maxx, (std::max)(e.x0, e.x1));
+        m_miny = (std::min)(m_miny, (std::min)(e.y0, e.y1));
+        m_maxy = (std::max)(m_maxy, (std::max)(e.y0, e.y1));
+    }
+    double width = m_maxx - m_minx;
+    double height = m_maxy - m_miny;
+
+    // Size the grid so cells are roughly square.
+    size_t target = (std::min)((std::max)(m_edges.size() * CellsPerEdge,
+        MinCells), MaxCells);
+    double aspect = (width > 0 && height > 0) ? std::sqrt(height / width) : 1;
+    double side = std::sqrt((double)target);
+    m_rows = (std::max)((size_t)(side * aspect), (size_t)1);
+    m_cols = (std::max)((size_t)(side / aspect), (size_t)1);
+    if (height == 0)
+        m_rows = 1;
+    if (width == 0)
+        m_cols = 1;
+    m_cellWidth = (width > 0) ? width / m_cols : 1;
+    m_cellHeight = (height > 0) ? height / m_rows : 1;
+
+    // Bucket the edges into the rows they span.  The rows are found with
+    // row(), as for query points, so a point whose Y is in the range of an
+    // edge is always in one of its rows.
+    m_rowOffsets.assign(m_rows + 1, 0);
+    for (const Edge& e : m_edges)
+        for (size_t r = row((std::min)(e.y0, e.y1));
+                r <= row((std::max)(e.y0, e.y1)); ++r)
+            m_rowOffsets[r + 1]++;
+    for (size_t r = 0; r < m_rows; ++r)
+        m_rowOffsets[r + 1] += m_rowOffsets[r];
+
+    size_t total = m_rowOffsets[m_rows];
+    m_ex0.resize(total);
+    m_ey0.resize(total);
+    m_ex1.resize(total);
+    m_ey1.resize(total);
+    m_rowMaxx.resize(total);
+
+    // The edges of a row are sorted by their maximum X, so the crossing
+    // test can skip the edges left of a point.
+    std::sort(m_edges.begin(), m_edges.end(),
+        [](const Edge& a, const Edge& b)
+        { return (std::max)(a.x0, a.x1) < (std::max)(b.x0, b.x1); });
+    std::vector<size_t> pos(m_rowOffsets.begin(), m_rowOffsets.end() - 1);
+    for (const Edge& e : m_edges)
+        for (size_t r = row((std::min)(e.y0, e.y1));
+                r <= row((std::max)(e.y0, e.y1)); ++r)
+        {
+            size_t p = pos[r]++;
+            m_ex0[p] = e.x0;
+            m_ey0[p] = e.y0;
+            m_ex1[p] = e.x1;
+            m_ey1[p] = e.y1;
+            m_rowMaxx[p] = (std::max)(e.x0, e.x1);
+        }
+
+    // Mark the cells that edges pass through, with a margin that covers
+    // rounding in the clipping of the edges to the rows.
+    m_cells.assign(m_rows * m_cols, Outside);
+    double xtol = m_cellWidth * 1e-3 +
+        4 * DBL_EPSILON * (std::max)(std::fabs(m_minx), std::fabs(m_maxx));
+    double ytol = m_cellHeight * 1e-3 +
+        4 * DBL_EPSILON * (std::max)(std::fabs(m_miny), std::fabs(m_maxy));
+    for (size_t r = 0; r < m_rows; ++r)
+    {
+        double lo = m_miny + r * m_cellHeight - ytol;
+        double hi = m_miny + (r + 1) * m_cellHeight + ytol;
+        for (size_t i = m_rowOffsets[r]; i < m_rowOffsets[r + 1]; ++i)
+        {
+            double x0 = m_ex0[i];
+            double y0 = m_ey0[i];
+            double x1 = m_ex1[i];
+            double y1 = m_ey1[i];
+            double xa, xb;
+            if (y0 == y1)
+            {
+                xa = x0;
+                xb = x1;
+            }
+            else
+            {
+                double ya = (std::min)((std::max)(lo, (std::min)(y0, y1)),
+                    (std::max)(y0, y1));
+                double yb = (std::min)((std::max)(hi, (std::min)(y0, y1)),
+                    (std::max)(y0, y1));
+                xa = x0 + (ya - y0) * (x1 - x0) / (y1 - y0);
+                xb = x0 + (yb - y0) * (x1 - x0) / (y1 - y0);
+            }
+            if (xa > xb)
+                std::swap(xa, xb);
+            size_t c0 = col(xa - xtol);
+            size_t c1 = col(xb + xtol);
+            for (size_t c = c0; c <= c1; ++c)
+                m_cells[r * m_cols + c] = Boundary;
+        }
+
+        // Cells without edges are inside if their centers are, which is
+        // determined by the parity of the edge crossings to the right of
+        // each center.
+        double cy = m_miny + (r + 0.5) * m_cellHeight;
+        std::vector<double> xs;
+        for (size_t i = m_rowOffsets[r]; i < m_rowOffsets[r + 1]; ++i)
+            if ((m_ey0[i] > cy) != (m_ey1[i] > cy))
+                xs.push_back(m_ex0[i] + (cy - m_ey0[i]) *
+                    (m_ex1[i] - m_ex0[i]) / (m_ey1[i] - m_ey0[i]));
+        std::sort(xs.begin(), xs.end());
+        size_t left = 0;
+        for (size_t c = 0; c < m_cols; ++c)
+        {
+            double cx = m_minx + (c + 0.5) * m_cellWidth;
+            while (left < xs.size() && xs[left] <= cx)
+                left++;
+            uint8_t& cell = m_cells[r * m_cols + c];
+            if (cell != Boundary && (xs.size() - left) % 2)
+                cell = Inside;
+        }
+    }
+    m_edges.clear();
+}
+
+
+size_t PolygonGrid::row(double y) const
+{
+    double r = std::floor((y - m_miny) / m_cellHeight);
+    return (size_t)(std::min)((std::max)(r, 0.0), (double)(m_rows - 1));
+}
+
+
+size_t PolygonGrid::col(double x) const
+{
+    double c = std::floor((x - m_minx) / m_cellWidth);
+    return (size_t)(std::min)((std::max)(c, 0.0), (double)(m_cols - 1));
+}
+
+
+// Test a point against the edges of its row.  The point is covered if it
+// is on an edge or if an odd number of edges cross the ray from the point
+// in the +X direction.  Only edges whose maximum X isn't less than that of
+// the point can do either.  The loop is branch-free so that it vectorizes.
+bool PolygonGrid::rowCovers(size_t r, double x, double y) const
+{
+    const double *maxx = m_rowMaxx.data();
+    size_t begin = std::lower_bound(maxx + m_rowOffsets[r],
+        maxx + m_rowOffsets[r + 1], x) - maxx;
+    size_t n = m_rowOffsets[r + 1] - begin;
+    const double *x0 = m_ex0.data() + begin;
+    const double *y0 = m_ey0.data() + begin;
+    const double *x1 = m_ex1.data() + begin;
+    const double *y1 = m_ey1.data() + begin;
+
+    int crossings = 0;
+    int on = 0;
+    for (size_t i = 0; i < n; ++i)
+    {
+        // cross is positive if the point is left of the edge going up.
+        double cross = (x1[i] - x0[i]) * (y - y0[i]) -
+            (y1[i] - y0[i]) * (x - x0[i]);
+        int straddles = (y0[i] > y) != (y1[i] > y);
+        int right = (cross > 0) == (y1[i] > y0[i]);
+        crossings ^= straddles & right & (cross != 0);
+        on |= (cross == 0) &
+            (x >= (std::min)(x0[i], x1[i])) & (x <= (std::max)(x0[i], x1[i])) &
+            (y >= (std::min)(y0[i], y1[i])) & (y <= (std::max)(y0[i], y1[i]));
+    }
+    return crossings || on;
+}
+
+
+bool PolygonGrid::covers(double x, double y) const
+{
+    if (!m_rows || x < m_minx || x > m_maxx || y < m_miny || y > m_maxy)
+        return false;
+
+    size_t r = row(y);
+    uint8_t cell = m_cells[r * m_cols + col(x)];
+    if (cell == Boundary)
+        return rowCovers(r, x, y);
+    return cell == Inside;
+}
+
+
+void PolygonGrid::covers(const double *x, const double *y,
+    point_count_t count, uint8_t *out) const
+{
+    for (point_count_t i = 0; i < count; ++i)
+        out[i] = covers(x[i], y[i]);
+}
+
+} // namespace pdal
@@ -0,0 +1,115 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#pragma once
+
+#include <pdal/pdal_internal.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace pdal
+{
+
+// A native index of the rings of a polygon or multipolygon for testing
+// whether points are covered by it (inside or on the boundary).
+//
+// The bounds of the rings are split into a grid.  Edges are bucketed into
+// the rows of the grid that they span, so the crossing test for a point
+// only considers the edges of its row.  Cells that no edge passes through
+// are entirely inside or outside, which is recorded when the index is
+// built, so only points in cells containing edges need a crossing test.
+class PolygonGrid
+{
+public:
+    PolygonGrid() : m_rows(0), m_cols(0)
+    {}
+
+    // Add a ring.  The rings of all polygons, including holes, are added
+    // and combined with the even-odd rule.  The last point of the ring may
+    // repeat the first.
+    void addRing(const std::vector<double>& x, const std::vector<double>& y);
+
+    // Build the grid once all rings have been added.
+    void build();
+
+    bool covers(double x, double y) const;
+    void covers(const double *x, const double *y, point_count_t count,
+        uint8_t *out) const;
+
+private:
+    enum CellState : uint8_t
+    {
+        Outside,
+        Inside,
+        Boundary
+    };
+
+    struct Edge
+    {
+        double x0;
+        double y0;
+        double x1;
+        double y1;
+    };
+
+    std::vector<Edge> m_edges;
+
+    double m_minx;
+    double m_miny;
+    double m_maxx;
+    double m_maxy;
+    double m_cellWidth;
+    double m_cellHeight;
+    size_t m_rows;
+    size_t m_cols;
+    std::vector<uint8_t> m_cells;
+
+    // Edges of row r are at [m_rowOffsets[r], m_rowOffsets[r + 1]) of the
+    // coordinate arrays, which are kept separate so the crossing test
+    // vectorizes.
+    std::vector<size_t> m_rowOffsets;
+    std::vector<double> m_ex0;
+    std::vector<double> m_ey0;
+    std::vector<double> m_ex1;
+    std::vector<double> m_ey1;
+    std::vector<double> m_rowMaxx;
+
+    size_t row(double y) const;
+    size_t col(double x) const;
+    bool rowCovers(size_t row, double x, double y) const;
+};
+
+} // namespace pdal
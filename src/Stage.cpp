@@ -38,15 +38,78 @@
 #include <pdal/Stage.hpp>
 #include <pdal/SpatialReference.hpp>
 #include <pdal/PDALUtils.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 #include "StageRunner.hpp"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <iterator>
 #include <memory>
+#include <mutex>
 
 namespace pdal
 {
 
+namespace
+{
+
+// A batch of streamed points in one of the buffers of a StreamPointTable.
+struct Batch
+{
+    PointId m_begin;
+    point_count_t m_count;
+    bool m_last;
+};
+
+// Queue of batches passed from one streaming thread to the next.  The
+// number of batches in flight is limited by the number of table buffers.
+class BatchQueue
+{
+public:
+    BatchQueue() : m_abort(false)
+    {}
+
+    void push(const Batch& batch)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_batches.push_back(batch);
+        }
+        m_cv.notify_one();
+    }
+
+    // Returns false if processing has been aborted.
+    bool pop(Batch& batch)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [this](){ return m_abort || !m_batches.empty(); });
+        if (m_abort)
+            return false;
+        batch = m_batches.front();
+        m_batches.pop_front();
+        return true;
+    }
+
+    void abort()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_abort = true;
+        }
+        m_cv.notify_all();
+    }
+
+private:
+    std::deque<Batch> m_batches;
+    bool m_abort;
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+};
+
+} // unnamed namespace
+
 Stage::Stage() : m_progressFd(-1)
 {
     Construct();
@@ -65,6 +128,8 @@ void Stage::Construct()
 {
     m_debug = false;
     m_verbose = 0;
+    m_threads = 1;
+    m_viewThreads = 1;
 }
 
 
@@ -148,24 +213,57 @@ PointViewSet Stage::execute(PointTableRef table)
         table.addSpatialReference(it->spatialReference());
     gdal::ErrorHandler::getGlobalErrorHandler().set(m_log, m_debug);
 
+    // Views are only run concurrently if the stage says that's safe and
+    // there's more than one view to run.
+    std::unique_ptr<ThreadPool> pool;
+    std::size_t threads = std::min<std::size_t>(numThreads(), views.size());
+    if (threads > 1 && threadSafe())
+        pool.reset(new ThreadPool(threads));
+    const int lastId = PointView::m_lastId;
+
     // Do the ready operation and then start running all the views
     // through the stage.
     ready(table);
+    if (pool)
+        m_viewThreads = threads;
     for (auto const& it : views)
     {
         StageRunnerPtr runner(new StageRunner(this, it));
         runners.push_back(runner);
-        runner->run();
+        if (pool)
+            runner->run(*pool);
+        else
+            runner->run();
+    }
+    if (pool)
+    {
+        pool->join();
+        m_viewThreads = 1;
     }
 
-    // As the stages complete (synchronously at this time), propagate the
-    // spatial reference and merge the output views.
+    // As the stages complete, propagate the spatial reference and merge the
+    // output views.
     srs = getSpatialReference();
     for (auto const& it : runners)
     {
         StageRunnerPtr runner(it);
         PointViewSet temp = runner->wait();
 
+        // Views created by concurrent runs are numbered in whatever order
+        // the threads happened to create them.  Renumber them in runner
+        // order so that the output is ordered as it would be by a serial run.
+        if (pool)
+        {
+            std::vector<PointViewPtr> ordered(temp.begin(), temp.end());
+            temp.clear();
+            for (PointViewPtr v : ordered)
+            {
+                if (v->m_id > lastId)
+                    v->m_id = ++PointView::m_lastId;
+                temp.insert(v);
+            }
+        }
+
         // If our stage has a spatial reference, the view takes it on once
         // the stage has been run.
         if (!srs.empty())
@@ -227,7 +325,13 @@ void Stage::execute(StreamPointTable& table)
 
 void Stage::execute(StreamPointTable& table, std::list<Stage *>& stages)
 {
-    std::vector<bool> skips(table.capacity());
+    if (table.numBuffers() > 1 && stages.size() > 1)
+    {
+        executePipelined(table, stages);
+        return;
+    }
+
+    std::vector<uint8_t> skips(table.capacity());
     std::list<Stage *> filters;
     SpatialReference srs;
 
@@ -256,45 +360,31 @@ void Stage::execute(StreamPointTable& table, std::list<Stage *>& stages)
     {
         // Clear the spatial reference when processing starts.
         table.clearSpatialReferences();
-        PointId idx = 0;
-        PointRef point(table, idx);
+        PointRef point(table, 0);
         point_count_t pointLimit = table.capacity();
 
-        // When we get false back from a reader, we're done, so set
-        // the point limit to the number of points processed in this loop
-        // of the table.
-        for (PointId idx = 0; idx < pointLimit; idx++)
-        {
-            point.setPointId(idx);
-            finished = !reader->processOne(point);
-            if (finished)
-                pointLimit = idx;
-        }
+        // When we get fewer points back from a reader than we asked for,
+        // we're done, so set the point limit to the number of points
+        // processed in this loop of the table.
+        point_count_t count = reader->processBatch(point, pointLimit, skips);
+        finished = (count < pointLimit);
+        pointLimit = count;
         srs = reader->getSpatialReference();
         if (!srs.empty())
             table.setSpatialReference(srs);
 
-        // When we get a false back from a filter, we're filtering out a
-        // point, so add it to the list of skips so that it doesn't get
-        // processed by subsequent filters.
+        // Filters set the skip flag of points that are filtered out so
+        // that they don't get processed by subsequent filters.
         for (Stage *s : filters)
         {
-            for (PointId idx = 0; idx < pointLimit; idx++)
-            {
-                if (skips[idx])
-                    continue;
-                point.setPointId(idx);
-                if (!s->processOne(point))
-                    skips[idx] = true;
-            }
+            point.setPointId(0);
+            s->processBatch(point, pointLimit, skips);
             srs = s->getSpatialReference();
             if (!srs.empty())
                 table.setSpatialReference(srs);
         }
 
-        // Yes, vector<bool> is terrible.  Can do something better later.
-        for (size_t i = 0; i < skips.size(); ++i)
-            skips[i] = false;
+        std::fill(skips.begin(), skips.end(), 0);
         table.reset();
     }
 
@@ -303,6 +393,148 @@ void Stage::execute(StreamPointTable& table, std::list<Stage *>& stages)
 }
 
 
+// Run the reader, the filters and the last stage of the list on separate
+// threads.  Each thread takes a batch of points in one of the table
+// buffers from its queue, processes it and passes it to the queue of the
+// next thread.  The last thread returns the buffer to the reader.  Batches
+// are handled in order by each thread, so points reach each stage in
+// the same order as with a single buffer.
+void Stage::executePipelined(StreamPointTable& table,
+    std::list<Stage *>& stages)
+{
+    typedef std::list<Stage *> StageList;
+
+    const point_count_t capacity = table.capacity();
+    const point_count_t numBuffers = table.numBuffers();
+
+    // Skip flags for all buffers.  Each thread only touches the flags of
+    // the buffer it's working on.
+    std::vector<uint8_t> skips(capacity * numBuffers);
+
+    // The spatial reference is set once since the table is shared by
+    // all threads.
+    for (Stage *s : stages)
+    {
+        s->ready(table);
+        SpatialReference srs = s->getSpatialReference();
+        if (!srs.empty())
+            table.setSpatialReference(srs);
+    }
+
+    // Split the stages into the reader, the filters and the last stage.
+    std::vector<StageList> groups;
+    auto it = stages.begin();
+    groups.push_back(StageList(1, *it++));
+    auto last = std::prev(stages.end());
+    if (it != last)
+        groups.push_back(StageList(it, last));
+    groups.push_back(StageList(1, *last));
+
+    // Queue i feeds group i.  All buffers start out free for the reader.
+    std::vector<BatchQueue> queues(groups.size());
+    for (point_count_t i = 0; i < numBuffers; ++i)
+        queues[0].push(Batch{ i * capacity, capacity, false });
+
+    auto abort = [&queues]()
+    {
+        for (BatchQueue& q : queues)
+            q.abort();
+    };
+
+    auto readBatches = [&]()
+    {
+        Stage *reader = groups[0].front();
+        PointRef point(table, 0);
+        Batch batch;
+        while (queues[0].pop(batch))
+        {
+            std::fill(skips.begin() + batch.m_begin,
+                skips.begin() + batch.m_begin + capacity, 0);
+            point.setPointId(batch.m_begin);
+            batch.m_count = reader->processBatch(point, capacity, skips);
+            batch.m_last = (batch.m_count < capacity);
+            queues[1].push(batch);
+            if (batch.m_last)
+                break;
+        }
+    };
+
+    auto filterBatches = [&](size_t group)
+    {
+        PointRef point(table, 0);
+        BatchQueue& out = queues[(group + 1) % queues.size()];
+        Batch batch;
+        while (queues[group].pop(batch))
+        {
+            if (batch.m_count)
+                for (Stage *s : groups[group])
+                {
+                    point.setPointId(batch.m_begin);
+                    s->processBatch(point, batch.m_count, skips);
+                }
+            out.push(batch);
+            if (batch.m_last)
+                break;
+        }
+    };
+
+    ThreadPool pool(groups.size());
+    for (size_t group = 0; group < groups.size(); ++group)
+    {
+        pool.add([&, group]()
+        {
+            try
+            {
+                if (group == 0)
+                    readBatches();
+                else
+                    filterBatches(group);
+            }
+            catch (...)
+            {
+                abort();
+                throw;
+            }
+        });
+    }
+    pool.join();
+    table.reset();
+
+    for (Stage *s : stages)
+        s->done(table);
+}
+
+
+point_count_t Stage::processBatch(PointRef& point, point_count_t count,
+    std::vector<uint8_t>& skips)
+{
+    const PointId begin = point.pointId();
+    const PointId end = begin + count;
+
+    // A stage without inputs is a reader.
+    if (m_inputs.empty())
+    {
+        for (PointId idx = begin; idx < end; ++idx)
+        {
+            point.setPointId(idx);
+            if (!processOne(point))
+                return idx - begin;
+        }
+        return count;
+    }
+
+    for (PointId idx = begin; idx < end; ++idx)
+    {
+        if (skips[idx])
+            continue;
+        point.setPointId(idx);
+        if (!processOne(point))
+            skips[idx] = 1;
+    }
+    return count;
+}
+
+
 void Stage::l_initialize(PointTableRef table)
 {
     m_metadata = table.metadata().add(getName());
@@ -315,6 +547,7 @@ void Stage::l_processOptions(const Options& options)
     m_verbose = options.getValueOrDefault<uint32_t>("verbose", 0);
     if (m_debug && !m_verbose)
         m_verbose = 1;
+    m_threads = options.getValueOrDefault<uint32_t>("threads", 1);
 
     if (m_inputs.empty())
     {
@@ -359,6 +592,15 @@ void Stage::l_processOptions(const Options& options)
 }
 
 
+std::size_t Stage::numThreads() const
+{
+    std::size_t threads = m_threads ? m_threads :
+        ThreadPool::hardwareThreads();
+    // Views running concurrently share the threads.
+    return (std::max)(threads / m_viewThreads, (std::size_t)1);
+}
+
+
 const SpatialReference& Stage::getSpatialReference() const
 {
     return m_spatialReference;
@@ -37,6 +37,7 @@
 #include <memory>
 
 #include <pdal/Stage.hpp>
+#include <pdal/util/ThreadPool.hpp>
 
 namespace pdal
 {
@@ -48,10 +49,15 @@ public:
         m_stage(s), m_view(view)
     {}
 
-    // For now this is all synchronous
+    // Run the stage on the view in the calling thread.
     void run()
         { m_viewSet = m_stage->run(m_view); }
 
+    // Queue the stage run on a thread pool.  The pool must be joined
+    // before calling wait().
+    void run(ThreadPool& pool)
+        { pool.add([this](){ run(); }); }
+
     PointViewSet wait()
         { return m_viewSet; }
 
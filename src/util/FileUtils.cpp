@@ -33,7 +33,18 @@
 ****************************************************************************/
 
 #include <sys/stat.h>
+#include <fcntl.h>
 
+#ifdef _WIN32
+#include <io.h>
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
 #include <iostream>
 #include <sstream>
 
@@ -373,6 +384,22 @@ string stem(const string& path)
 }
 
 
+string tempDirectory()
+{
+    string dir = arbiter::fs::getTempPath();
+    if (dir.size() && dir.back() != '/' && dir.back() != '\\')
+        dir += '/';
+    return dir;
+}
+
+
+string tempFilename(const string& prefix)
+{
+    return tempDirectory() + prefix +
+        pdalboost::filesystem::unique_path("%%%%-%%%%-%%%%-%%%%").string();
+}
+
+
 // Determine if the path represents a directory.
 bool isDirectory(const std::string& path)
 {
@@ -417,6 +444,86 @@ std::string extension(const std::string& filename)
     return filename.substr(idx);
 }
 
+
+MapContext mapFile(const std::string& filename, bool sequential)
+{
+    MapContext ctx;
+
+#ifdef _WIN32
+    ctx.m_fd = ::_open(filename.c_str(), O_RDONLY | O_BINARY);
+#else
+    ctx.m_fd = ::open(filename.c_str(), O_RDONLY);
+#endif
+    if (ctx.m_fd == -1)
+    {
+        ctx.m_error = "Unable to open file: " +
+            std::string(strerror(errno)) + ".";
+        return ctx;
+    }
+
+    ctx.m_size = fileSize(filename);
+    if (ctx.m_size == 0)
+    {
+        ctx.m_error = "Can't map empty file.";
+        ctx = unmapFile(ctx);
+        return ctx;
+    }
+
+#ifdef _WIN32
+    HANDLE h = (HANDLE)::_get_osfhandle(ctx.m_fd);
+    ctx.m_handle = ::CreateFileMapping(h, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (ctx.m_handle)
+        ctx.m_addr = ::MapViewOfFile(ctx.m_handle, FILE_MAP_READ, 0, 0,
+            ctx.m_size);
+    if (!ctx.m_addr)
+    {
+        ctx.m_error = "Unable to map file.";
+        ctx = unmapFile(ctx);
+        return ctx;
+    }
+    (void)sequential;
+#else
+    void *addr = ::mmap(0, ctx.m_size, PROT_READ, MAP_SHARED, ctx.m_fd, 0);
+    if (addr == MAP_FAILED)
+    {
+        ctx.m_error = "Unable to map file: " +
+            std::string(strerror(errno)) + ".";
+        ctx = unmapFile(ctx);
+        return ctx;
+    }
+    ctx.m_addr = addr;
+    if (sequential)
+        ::madvise(ctx.m_addr, ctx.m_size, MADV_SEQUENTIAL);
+#endif
+    return ctx;
+}
+
+
+MapContext unmapFile(MapContext ctx)
+{
+#ifdef _WIN32
+    if (ctx.m_addr && !::UnmapViewOfFile(ctx.m_addr))
+        ctx.m_error = "Unable to unmap file.";
+    else
+        ctx.m_addr = nullptr;
+    if (ctx.m_handle)
+        ::CloseHandle(ctx.m_handle);
+    ctx.m_handle = nullptr;
+    if (ctx.m_fd != -1)
+        ::_close(ctx.m_fd);
+#else
+    if (ctx.m_addr && ::munmap(ctx.m_addr, ctx.m_size) == -1)
+        ctx.m_error = "Unable to unmap file: " +
+            std::string(strerror(errno)) + ".";
+    else
+        ctx.m_addr = nullptr;
+    if (ctx.m_fd != -1)
+        ::close(ctx.m_fd);
+#endif
+    ctx.m_fd = -1;
+    return ctx;
+}
+
 } // namespace FileUtils
 
 } // namespace pdal
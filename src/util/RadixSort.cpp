@@ -0,0 +1,182 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/util/RadixSort.hpp>
+#include <pdal/util/ThreadPool.hpp>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
+
+namespace pdal
+{
+namespace Utils
+{
+
+namespace
+{
+
+const int DigitBits = 8;
+const std::size_t NumBuckets = 1 << DigitBits;
+const int NumDigits = 64 / DigitBits;
+
+// Below this many keys per thread, splitting the work isn't worth it.
+const std::size_t MinChunk = 1 << 16;
+
+typedef std::array<std::size_t, NumBuckets> Histogram;
+
+inline std::size_t digit(uint64_t key, int d)
+{
+    return (key >> (d * DigitBits)) & (NumBuckets - 1);
+}
+
+} // unnamed namespace
+
+
+void radixSort(std::vector<uint64_t>& keys, std::vector<uint64_t>& values,
+    std::size_t threads)
+{
+    const std::size_t n = keys.size();
+    threads = (std::max)(std::size_t(1), (std::min)(threads, n / MinChunk));
+    const std::size_t chunk = (n + threads - 1) / threads;
+
+    std::unique_ptr<ThreadPool> pool;
+    if (threads > 1)
+        pool.reset(new ThreadPool(threads));
+
+    // Run a function on each chunk of the keys.
+    auto forEachChunk = [&](std::function<void(std::size_t, std::size_t,
+        std::size_t)> f)
+    {
+        for (std::size_t t = 0; t < threads; ++t)
+        {
+            std::size_t begin = (std::min)(t * chunk, n);
+            std::size_t end = (std::min)(begin + chunk, n);
+            if (pool)
+                pool->add([&f, t, begin, end](){ f(t, begin, end); });
+            else
+                f(t, begin, end);
+        }
+        if (pool)
+            pool->join();
+    };
+
+    // Find the digits for which all keys fall in the same bucket.  Those
+    // digits don't need to be sorted.
+    std::vector<std::array<uint64_t, 2>> ranges(threads,
+        std::array<uint64_t, 2>{ {~uint64_t(0), 0} });
+    forEachChunk([&](std::size_t t, std::size_t begin, std::size_t end)
+    {
+        uint64_t andBits = ~uint64_t(0);
+        uint64_t orBits = 0;
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            andBits &= keys[i];
+            orBits |= keys[i];
+        }
+        ranges[t] = { {andBits, orBits} };
+    });
+    uint64_t andBits = ~uint64_t(0);
+    uint64_t orBits = 0;
+    for (auto& r : ranges)
+    {
+        andBits &= r[0];
+        orBits |= r[1];
+    }
+    // Bits that are set in some keys but not in others.
+    const uint64_t differ = andBits ^ orBits;
+
+    std::vector<uint64_t> tmpKeys(n);
+    std::vector<uint64_t> tmpValues(n);
+    std::vector<uint64_t> *srcKeys = &keys;
+    std::vector<uint64_t> *srcValues = &values;
+    std::vector<uint64_t> *dstKeys = &tmpKeys;
+    std::vector<uint64_t> *dstValues = &tmpValues;
+    std::vector<Histogram> offsets(threads);
+
+    for (int d = 0; d < NumDigits; ++d)
+    {
+        if (digit(differ, d) == 0)
+            continue;
+
+        // Count the keys of each chunk in each bucket.
+        forEachChunk([&](std::size_t t, std::size_t begin, std::size_t end)
+        {
+            Histogram& h = offsets[t];
+            h.fill(0);
+            const std::vector<uint64_t>& k = *srcKeys;
+            for (std::size_t i = begin; i < end; ++i)
+                h[digit(k[i], d)]++;
+        });
+
+        // Turn the counts into the position at which each chunk writes
+        // its first key of each bucket.  Chunks write in order within a
+        // bucket, which keeps the sort stable.
+        std::size_t pos = 0;
+        for (std::size_t b = 0; b < NumBuckets; ++b)
+            for (std::size_t t = 0; t < threads; ++t)
+            {
+                std::size_t count = offsets[t][b];
+                offsets[t][b] = pos;
+                pos += count;
+            }
+
+        forEachChunk([&](std::size_t t, std::size_t begin, std::size_t end)
+        {
+            Histogram& h = offsets[t];
+            const std::vector<uint64_t>& sk = *srcKeys;
+            const std::vector<uint64_t>& sv = *srcValues;
+            std::vector<uint64_t>& dk = *dstKeys;
+            std::vector<uint64_t>& dv = *dstValues;
+            for (std::size_t i = begin; i < end; ++i)
+            {
+                std::size_t dst = h[digit(sk[i], d)]++;
+                dk[dst] = sk[i];
+                dv[dst] = sv[i];
+            }
+        });
+        std::swap(srcKeys, dstKeys);
+        std::swap(srcValues, dstValues);
+    }
+
+    if (srcKeys != &keys)
+    {
+        keys.swap(tmpKeys);
+        values.swap(tmpValues);
+    }
+}
+
+} // namespace Utils
+} // namespace pdal
@@ -0,0 +1,194 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/util/ThreadPool.hpp>
+
+namespace pdal
+{
+
+namespace
+{
+
+// The pool and queue index of the worker running on this thread, if any.
+thread_local ThreadPool *t_pool = nullptr;
+thread_local std::size_t t_worker = 0;
+
+} // unnamed namespace
+
+
+ThreadPool::ThreadPool(std::size_t numThreads, std::size_t queueSize) :
+    m_queueSize(queueSize), m_next(0), m_queued(0), m_running(0),
+    m_stop(false)
+{
+    if (numThreads == 0)
+        numThreads = hardwareThreads();
+    if (m_queueSize == 0)
+        m_queueSize = 4 * numThreads;
+
+    for (std::size_t i = 0; i < numThreads; ++i)
+        m_queues.push_back(std::unique_ptr<Queue>(new Queue));
+    for (std::size_t i = 0; i < numThreads; ++i)
+        m_threads.push_back(std::thread(&ThreadPool::work, this, i));
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_workCv.notify_all();
+    for (std::thread& t : m_threads)
+        t.join();
+}
+
+
+std::size_t ThreadPool::hardwareThreads()
+{
+    std::size_t cnt = std::thread::hardware_concurrency();
+    return cnt ? cnt : 1;
+}
+
+
+void ThreadPool::add(Task task)
+{
+    // A worker adding a task pushes it on its own queue so that it's likely
+    // to be run next by the same thread.  Workers are never blocked by the
+    // queue bound, since all workers could then wait on each other.
+    const bool fromWorker = (t_pool == this);
+
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        if (!fromWorker)
+            m_spaceCv.wait(lock, [this](){ return m_queued < m_queueSize; });
+
+        Queue& q = fromWorker ? *m_queues[t_worker] :
+            *m_queues[m_next++ % m_queues.size()];
+        {
+            std::lock_guard<std::mutex> qlock(q.m_mutex);
+            if (fromWorker)
+                q.m_tasks.push_front(std::move(task));
+            else
+                q.m_tasks.push_back(std::move(task));
+        }
+        m_queued++;
+    }
+    m_workCv.notify_one();
+}
+
+
+void ThreadPool::join()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_doneCv.wait(lock, [this](){ return !m_queued && !m_running; });
+    if (m_error)
+    {
+        std::exception_ptr e(m_error);
+        m_error = nullptr;
+        std::rethrow_exception(e);
+    }
+}
+
+
+// Take a task from the front of our own queue or steal one from the back
+// of another worker's queue.
+bool ThreadPool::take(std::size_t id, Task& task)
+{
+    const std::size_t cnt = m_queues.size();
+    for (std::size_t i = 0; i < cnt; ++i)
+    {
+        Queue& q = *m_queues[(id + i) % cnt];
+        std::lock_guard<std::mutex> qlock(q.m_mutex);
+        if (q.m_tasks.empty())
+            continue;
+        if (i == 0)
+        {
+            task = std::move(q.m_tasks.front());
+            q.m_tasks.pop_front();
+        }
+        else
+        {
+            task = std::move(q.m_tasks.back());
+            q.m_tasks.pop_back();
+        }
+        return true;
+    }
+    return false;
+}
+
+
+void ThreadPool::work(std::size_t id)
+{
+    t_pool = this;
+    t_worker = id;
+
+    while (true)
+    {
+        // Claim one of the queued tasks.  Tasks are placed on a queue before
+        // they're counted, so a claimed task is always found below.
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_workCv.wait(lock, [this](){ return m_queued || m_stop; });
+            if (!m_queued)
+                break;
+            m_queued--;
+            m_running++;
+        }
+        m_spaceCv.notify_one();
+
+        Task task;
+        while (!take(id, task))
+            std::this_thread::yield();
+
+        try
+        {
+            task();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error)
+                m_error = std::current_exception();
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running--;
+        if (!m_queued && !m_running)
+            m_doneCv.notify_all();
+    }
+    t_pool = nullptr;
+}
+
+} // namespace pdal
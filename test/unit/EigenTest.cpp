@@ -0,0 +1,147 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of its contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <cmath>
+#include <random>
+
+#include <Eigen/Dense>
+
+#include <pdal/Eigen.hpp>
+#include <pdal/KDIndex.hpp>
+#include <pdal/PointView.hpp>
+
+using namespace pdal;
+
+// Features of the neighborhoods of points on a plane, on a line and in a
+// volume match those computed from computeCovariance() and computeRank()
+// for the same neighbors, whether computed serially or concurrently.
+TEST(EigenTest, computeFeatures)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> u(0, 10);
+
+    // Enough points that the features are computed in several blocks.
+    const PointId count = 3000;
+    PointViewPtr view(new PointView(table));
+    PointId id = 0;
+
+    // Plane z = 0.
+    for (PointId i = 0; i < count; ++i, ++id)
+    {
+        view->setField(Dimension::Id::X, id, u(gen));
+        view->setField(Dimension::Id::Y, id, u(gen));
+        view->setField(Dimension::Id::Z, id, 0.0);
+    }
+
+    // Line y = z = 0.
+    for (PointId i = 0; i < count; ++i, ++id)
+    {
+        view->setField(Dimension::Id::X, id, 20 + u(gen));
+        view->setField(Dimension::Id::Y, id, 0.0);
+        view->setField(Dimension::Id::Z, id, 0.0);
+    }
+
+    // Volume.
+    for (PointId i = 0; i < count; ++i, ++id)
+    {
+        view->setField(Dimension::Id::X, id, 40 + u(gen));
+        view->setField(Dimension::Id::Y, id, u(gen));
+        view->setField(Dimension::Id::Z, id, u(gen));
+    }
+    ASSERT_EQ(view->size(), 3 * count);
+
+    const point_count_t knn = 8;
+    const double threshold = 0.01;
+    const int flags = NeighborhoodFeatures::Eigenvalues |
+        NeighborhoodFeatures::Normal | NeighborhoodFeatures::Rank;
+
+    KD3Index index(*view);
+    index.build();
+
+    for (std::size_t threads : { 1u, 4u })
+    {
+        std::vector<NeighborhoodFeatures> features;
+        computeFeatures(*view, knn, flags, features, threshold, threads);
+        ASSERT_EQ(features.size(), view->size());
+
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            const NeighborhoodFeatures& f = features[i];
+            std::vector<PointId> ids = index.neighbors(
+                view->getFieldAs<double>(Dimension::Id::X, i),
+                view->getFieldAs<double>(Dimension::Id::Y, i),
+                view->getFieldAs<double>(Dimension::Id::Z, i), knn);
+
+            Eigen::Matrix3f cov = computeCovariance(*view, ids);
+            Eigen::SelfAdjointEigenSolver<Eigen::Matrix3f> solver(cov);
+            Eigen::Vector3f values = solver.eigenvalues();
+            double tolerance = 1e-4 * (std::max)(1.0f, values[2]);
+            for (int j = 0; j < 3; ++j)
+                EXPECT_NEAR(f.eigenvalues[j], values[j], tolerance) << i;
+
+            // The normal is only defined up to its sign, and only when the
+            // smallest eigenvalue is distinct.
+            if (values[1] - values[0] > 1e-3 * values[2])
+            {
+                Eigen::Vector3d normal =
+                    solver.eigenvectors().col(0).cast<double>();
+                EXPECT_NEAR(std::fabs(f.normal.dot(normal)), 1.0, 1e-4) << i;
+            }
+
+            EXPECT_EQ(f.rank, computeRank(*view, ids, threshold)) << i;
+
+            // Known features of each part of the cloud.  A few random
+            // neighborhoods are thin enough to have a lower rank.
+            if (i < count)
+            {
+                EXPECT_LE(f.rank, 2u);
+                EXPECT_NEAR(f.eigenvalues[0], 0.0, 1e-9);
+                EXPECT_NEAR(std::fabs(f.normal[2]), 1.0, 1e-6);
+            }
+            else if (i < 2 * count)
+            {
+                EXPECT_EQ(f.rank, 1u);
+                EXPECT_NEAR(f.eigenvalues[1], 0.0, 1e-9);
+            }
+            else
+                EXPECT_GT(f.eigenvalues[0], 0.0);
+        }
+    }
+}
@@ -202,3 +202,15 @@ TEST(FileUtilsTest, stem)
     EXPECT_EQ(FileUtils::stem("."), ".");
     EXPECT_EQ(FileUtils::stem(".."), "..");
 }
+
+TEST(FileUtilsTest, tempFilename)
+{
+    std::string dir = FileUtils::tempDirectory();
+    EXPECT_TRUE(FileUtils::directoryExists(dir));
+
+    std::string f1 = FileUtils::tempFilename("pdal_test_");
+    std::string f2 = FileUtils::tempFilename("pdal_test_");
+    EXPECT_NE(f1, f2);
+    EXPECT_EQ(f1.find(dir + "pdal_test_"), 0u);
+    EXPECT_FALSE(FileUtils::fileExists(f1));
+}
@@ -288,3 +288,124 @@ TEST(KDIndex, radius3D)
     EXPECT_EQ(ids[4], 4u);
 }
 
+
+// Batch queries run on several threads must match single point queries.
+TEST(KDIndex, batch)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    // Points on a jittered grid, so that neighbor distances are distinct.
+    PointId id = 0;
+    for (int i = 0; i < 30; ++i)
+        for (int j = 0; j < 30; ++j)
+            for (int k = 0; k < 10; ++k)
+            {
+                view.setField(Dimension::Id::X, id, i + .013 * (id % 7));
+                view.setField(Dimension::Id::Y, id, j + .017 * (id % 11));
+                view.setField(Dimension::Id::Z, id, k + .019 * (id % 13));
+                id++;
+            }
+
+    KD3Index index(view);
+    index.build();
+
+    const point_count_t k = 8;
+    std::vector<PointId> indices;
+    std::vector<double> sqrDists;
+    EXPECT_EQ(index.knnSearch(100, view.size(), k, indices, sqrDists, 4), k);
+    ASSERT_EQ(indices.size(), (view.size() - 100) * k);
+    for (PointId i = 100; i < view.size(); i += 37)
+    {
+        std::vector<PointId> ids = index.neighbors(
+            view.getFieldAs<double>(Dimension::Id::X, i),
+            view.getFieldAs<double>(Dimension::Id::Y, i),
+            view.getFieldAs<double>(Dimension::Id::Z, i), k);
+        std::vector<PointId> batch(indices.begin() + (i - 100) * k,
+            indices.begin() + (i - 99) * k);
+        EXPECT_EQ(ids, batch);
+        EXPECT_EQ(batch[0], i);
+    }
+
+    std::vector<point_count_t> offsets;
+    index.radius(0, view.size(), 1.5, offsets, indices, 4);
+    ASSERT_EQ(offsets.size(), view.size() + 1);
+    EXPECT_EQ(offsets.back(), indices.size());
+    for (PointId i = 0; i < view.size(); i += 37)
+    {
+        std::vector<PointId> ids = index.radius(
+            view.getFieldAs<double>(Dimension::Id::X, i),
+            view.getFieldAs<double>(Dimension::Id::Y, i),
+            view.getFieldAs<double>(Dimension::Id::Z, i), 1.5);
+        std::vector<PointId> batch(indices.begin() + offsets[i],
+            indices.begin() + offsets[i + 1]);
+        EXPECT_EQ(ids, batch);
+    }
+}
+
+// An index built on several threads must find the same neighbors as a
+// search of every point.
+TEST(KDIndex, parallelBuild)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    PointView view(table);
+
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+
+    for (PointId i = 0; i < 20000; ++i)
+    {
+        view.setField(Dimension::Id::X, i, (i * 7919) % 1000 + .001 * i);
+        view.setField(Dimension::Id::Y, i, (i * 104729) % 997);
+        view.setField(Dimension::Id::Z, i, (i * 1299709) % 991);
+    }
+
+    KD3Index index(view);
+    index.build(4);
+
+    for (PointId i = 0; i < view.size(); i += 997)
+    {
+        double x = view.getFieldAs<double>(Dimension::Id::X, i);
+        double y = view.getFieldAs<double>(Dimension::Id::Y, i) + .5;
+        double z = view.getFieldAs<double>(Dimension::Id::Z, i);
+
+        PointId nearest = 0;
+        double nearestDist = (std::numeric_limits<double>::max)();
+        for (PointId j = 0; j < view.size(); ++j)
+        {
+            double dx = x - view.getFieldAs<double>(Dimension::Id::X, j);
+            double dy = y - view.getFieldAs<double>(Dimension::Id::Y, j);
+            double dz = z - view.getFieldAs<double>(Dimension::Id::Z, j);
+            double dist = dx * dx + dy * dy + dz * dz;
+            if (dist < nearestDist)
+            {
+                nearest = j;
+                nearestDist = dist;
+            }
+        }
+        EXPECT_EQ(index.neighbor(x, y, z), nearest);
+    }
+
+    // Trees built with one and several threads give the same neighbors.
+    KD3Index serial(view);
+    serial.build(1);
+    std::vector<PointId> ids1, ids4;
+    std::vector<double> dists1, dists4;
+    serial.knnSearch(0, view.size(), 8, ids1, dists1);
+    index.knnSearch(0, view.size(), 8, ids4, dists4, 4);
+    EXPECT_EQ(ids1, ids4);
+    EXPECT_EQ(dists1, dists4);
+
+    std::vector<point_count_t> offsets1, offsets4;
+    serial.radius(0, view.size(), 20, offsets1, ids1);
+    index.radius(0, view.size(), 20, offsets4, ids4, 4);
+    EXPECT_EQ(offsets1, offsets4);
+    EXPECT_EQ(ids1, ids4);
+}
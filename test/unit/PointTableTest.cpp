@@ -178,3 +178,44 @@ TEST(PointTable, userView)
     EXPECT_TRUE(called);
 }
 
+
+TEST(PointTable, column)
+{
+    using namespace Dimension;
+
+    Options opts;
+    opts.add("filename", Support::datapath("las/simple.las"));
+
+    LasReader rowReader;
+    rowReader.setOptions(opts);
+    PointTable rowTable;
+    rowReader.prepare(rowTable);
+    PointViewPtr rowView = *rowReader.execute(rowTable).begin();
+
+    LasReader colReader;
+    colReader.setOptions(opts);
+    ColumnPointTable colTable;
+    colReader.prepare(colTable);
+    PointViewPtr colView = *colReader.execute(colTable).begin();
+
+    ASSERT_EQ(rowView->size(), colView->size());
+    ASSERT_EQ(colTable.numPoints(), colView->size());
+    for (PointId i = 0; i < rowView->size(); ++i)
+        for (auto id : colTable.layout()->dims())
+            EXPECT_EQ(rowView->getFieldAs<double>(id, i),
+                colView->getFieldAs<double>(id, i));
+
+    ColumnSpan<double> x = colTable.column<double>(Id::X);
+    ColumnSpan<uint16_t> intensity = colTable.column<uint16_t>(Id::Intensity);
+    EXPECT_EQ(x.size(), colView->size());
+    for (PointId i = 0; i < colView->size(); ++i)
+    {
+        EXPECT_EQ(x[i], colView->getFieldAs<double>(Id::X, i));
+        EXPECT_EQ(intensity[i],
+            colView->getFieldAs<uint16_t>(Id::Intensity, i));
+    }
+
+    x[0] = 1.5;
+    EXPECT_EQ(colView->getFieldAs<double>(Id::X, 0), 1.5);
+    EXPECT_THROW(colTable.column<float>(Id::X), pdal_error);
+}
@@ -35,8 +35,10 @@
 #include <pdal/pdal_test_main.hpp>
 
 #include <array>
+#include <cstring>
 #include <random>
 
+#include <pdal/KDIndex.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/PointViewIter.hpp>
 #include <pdal/PDALUtils.hpp>
@@ -161,6 +163,187 @@ TEST(PointViewTest, getFloat)
 }
 
 
+void checkFields(PointTableRef table)
+{
+    const point_count_t cnt = 3000;
+
+    PointLayoutPtr layout(table.layout());
+    layout->registerDim(Dimension::Id::Classification);
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    table.finalize();
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < cnt; i++)
+    {
+        view->setField(Dimension::Id::Classification, i, (uint8_t)(i + 1));
+        view->setField(Dimension::Id::X, i, (int32_t)(i * 10));
+        view->setField(Dimension::Id::Y, i, i * 100.0);
+    }
+
+    // Reverse the points so that the view's index isn't the identity.
+    PointViewPtr rev = view->makeNew();
+    for (PointId i = 0; i < cnt; ++i)
+        rev->appendPoint(*view, cnt - i - 1);
+
+    std::vector<double> xs(cnt);
+    std::vector<uint8_t> classes(cnt);
+    rev->getFieldsAs(Dimension::Id::X, 0, cnt, xs.data());
+    rev->getFieldsAs(Dimension::Id::Classification, 0, cnt, classes.data());
+    for (PointId i = 0; i < cnt; ++i)
+    {
+        EXPECT_EQ(xs[i], rev->getFieldAs<double>(Dimension::Id::X, i));
+        EXPECT_EQ(classes[i],
+            rev->getFieldAs<uint8_t>(Dimension::Id::Classification, i));
+    }
+
+    std::vector<uint8_t> small(cnt);
+    EXPECT_THROW(rev->getFieldsAs(Dimension::Id::Y, 0, cnt, small.data()),
+        pdal_error);
+
+    std::vector<double> ys(cnt - 10);
+    for (PointId i = 0; i < ys.size(); ++i)
+        ys[i] = i * 2.0;
+    rev->setFields(Dimension::Id::X, 10, cnt, ys.data());
+    for (PointId i = 0; i < ys.size(); ++i)
+        EXPECT_EQ(rev->getFieldAs<int32_t>(Dimension::Id::X, i + 10),
+            (int32_t)(i * 2));
+    EXPECT_EQ(view->getFieldAs<int32_t>(Dimension::Id::X, 0),
+        (int32_t)((cnt - 11) * 2));
+    EXPECT_EQ(view->getFieldAs<int32_t>(Dimension::Id::X, cnt - 1),
+        (int32_t)((cnt - 1) * 10));
+
+    ys[0] = 1000;
+    EXPECT_THROW(rev->setFields(Dimension::Id::Classification, 0, 1,
+        ys.data()),
+        pdal_error);
+    EXPECT_THROW(rev->setFields(Dimension::Id::X, 0, cnt + 1, ys.data()),
+        pdal_error);
+    std::vector<double> big(cnt + 1);
+    EXPECT_THROW(rev->getFieldsAs(Dimension::Id::X, 0, cnt + 1, big.data()),
+        pdal_error);
+}
+
+TEST(PointViewTest, getSetFields)
+{
+    PointTable table;
+    checkFields(table);
+
+    ColumnPointTable columnTable;
+    checkFields(columnTable);
+}
+
+
+// Packed points are read and written dimension by dimension, so they work
+// with tables that have no point records.
+TEST(PointViewTest, packedPoints)
+{
+    PointTable table;
+    ColumnPointTable columnTable;
+    std::vector<char> expected;
+    for (BasePointTable *t : { (BasePointTable *)&table,
+        (BasePointTable *)&columnTable })
+    {
+        PointLayoutPtr layout = t->layout();
+        layout->registerDim(Dimension::Id::X, Dimension::Type::Double);
+        layout->registerDim(Dimension::Id::Intensity,
+            Dimension::Type::Unsigned16);
+        t->finalize();
+        PointView view(*t);
+
+        DimTypeList dims = view.dimTypes();
+        const size_t pointSize = view.pointSize();
+        std::vector<char> buf(pointSize);
+        for (PointId i = 0; i < 10; ++i)
+        {
+            double x = i * 1.5;
+            uint16_t intensity = (uint16_t)(i * 100);
+            char *pos = buf.data();
+            for (auto const& dt : dims)
+            {
+                if (dt.m_id == Dimension::Id::X)
+                    std::memcpy(pos, &x, sizeof(x));
+                else
+                    std::memcpy(pos, &intensity, sizeof(intensity));
+                pos += Dimension::size(dt.m_type);
+            }
+            view.setPackedPoint(dims, i, buf.data());
+        }
+        ASSERT_EQ(view.size(), 10u);
+        EXPECT_EQ(view.getFieldAs<double>(Dimension::Id::X, 3), 4.5);
+        EXPECT_EQ(view.getFieldAs<int>(Dimension::Id::Intensity, 3), 300);
+
+        std::vector<char> packed(pointSize * view.size());
+        for (PointId i = 0; i < view.size(); ++i)
+            view.getPackedPoint(dims, i, packed.data() + i * pointSize);
+        if (expected.empty())
+            expected = packed;
+        else
+            EXPECT_EQ(packed, expected);
+    }
+
+    // Column tables have no point records to point into.
+    PointView columnView(columnTable);
+    columnView.setField(Dimension::Id::X, 0, 1.0);
+    EXPECT_THROW(columnView.getPoint(0), pdal_error);
+}
+
+
+TEST(PointViewTest, index)
+{
+    PointTable table;
+    PointViewPtr view = makeTestView(table, 10);
+
+    // Consecutive points.
+    PointViewPtr tail = view->makeNew();
+    for (PointId i = 5; i < 10; ++i)
+        tail->appendPoint(*view, i);
+
+    // Non-consecutive points.
+    PointViewPtr odd = view->makeNew();
+    for (PointId i = 1; i < 10; i += 2)
+        odd->appendPoint(*view, i);
+
+    PointViewPtr all = view->makeNew();
+    all->append(*tail);
+    all->append(*odd);
+    all->append(*tail);
+
+    ASSERT_EQ(tail->size(), 5u);
+    ASSERT_EQ(odd->size(), 5u);
+    ASSERT_EQ(all->size(), 15u);
+    for (PointId i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(tail->getFieldAs<int>(Dimension::Id::X, i),
+            (int)(i + 5) * 10);
+        EXPECT_EQ(odd->getFieldAs<int>(Dimension::Id::X, i),
+            (int)(i * 2 + 1) * 10);
+        EXPECT_EQ(all->getFieldAs<int>(Dimension::Id::X, i),
+            (int)(i + 5) * 10);
+        EXPECT_EQ(all->getFieldAs<int>(Dimension::Id::X, i + 5),
+            (int)(i * 2 + 1) * 10);
+        EXPECT_EQ(all->getFieldAs<int>(Dimension::Id::X, i + 10),
+            (int)(i + 5) * 10);
+    }
+
+    // Reorder the points in a view and make sure other views are unchanged.
+    std::reverse(tail->begin(), tail->end());
+    for (PointId i = 0; i < 5; ++i)
+    {
+        EXPECT_EQ(tail->getFieldAs<int>(Dimension::Id::X, i),
+            (int)(9 - i) * 10);
+        EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::X, i + 5),
+            (int)(i + 5) * 10);
+    }
+
+    // Adding a point to a view that has been reordered.
+    tail->setField(Dimension::Id::X, 5, 1000);
+    EXPECT_EQ(tail->size(), 6u);
+    EXPECT_EQ(tail->getFieldAs<int>(Dimension::Id::X, 5), 1000);
+    EXPECT_EQ(tail->getFieldAs<int>(Dimension::Id::X, 4), 50);
+}
+
+
 TEST(PointViewTest, copy)
 {
     PointTable table;
@@ -342,6 +525,125 @@ TEST(PointViewTest, kdindex)
 **/
 
 
+TEST(PointViewTest, cachedIndex)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+    PointView view(table);
+
+    for (PointId i = 0; i < 10; ++i)
+    {
+        view.setField(Dimension::Id::X, i, i);
+        view.setField(Dimension::Id::Y, i, i);
+        view.setField(Dimension::Id::Z, i, i);
+    }
+
+    // The index is built once and kept.
+    KD3Index *index = &view.build3dIndex();
+    EXPECT_EQ(index, &view.build3dIndex());
+    EXPECT_EQ(index->neighbor(9.9, 9.9, 9.9), 9u);
+
+    // Setting another dimension keeps the index.
+    layout->registerDim(Dimension::Id::Intensity);
+    view.setField(Dimension::Id::Intensity, 0, 5);
+    EXPECT_EQ(index, &view.build3dIndex());
+
+    // Moving a point replaces the index.
+    view.setField(Dimension::Id::X, 0, 20);
+    view.setField(Dimension::Id::Y, 0, 20);
+    view.setField(Dimension::Id::Z, 0, 20);
+    EXPECT_EQ(view.build3dIndex().neighbor(19.9, 19.9, 19.9), 0u);
+
+    // Adding a point replaces the index.
+    view.setField(Dimension::Id::X, 10, 30);
+    view.setField(Dimension::Id::Y, 10, 30);
+    view.setField(Dimension::Id::Z, 10, 30);
+    EXPECT_EQ(view.build3dIndex().neighbor(29.9, 29.9, 29.9), 10u);
+    EXPECT_EQ(view.build2dIndex().neighbor(29.9, 29.9), 10u);
+
+    // Reordering the points replaces the index.
+    std::sort(view.begin(), view.end(),
+        [](const PointIdxRef& p1, const PointIdxRef& p2)
+            { return p2.compare(Dimension::Id::X, p1); });
+    EXPECT_EQ(view.build3dIndex().neighbor(29.9, 29.9, 29.9), 0u);
+    EXPECT_EQ(view.build2dIndex().neighbor(29.9, 29.9), 0u);
+
+    // A copy of the view builds its own index.
+    PointView copy(view);
+    EXPECT_NE(&copy.build3dIndex(), &view.build3dIndex());
+    EXPECT_EQ(copy.build3dIndex().neighbor(0, 0, 0), 10u);
+}
+
+
+// Points moved through another view of the table or through the table
+// itself make the index stale.
+TEST(PointViewTest, cachedIndexShared)
+{
+    PointTable table;
+    PointLayoutPtr layout = table.layout();
+    layout->registerDim(Dimension::Id::X);
+    layout->registerDim(Dimension::Id::Y);
+    layout->registerDim(Dimension::Id::Z);
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 10; ++i)
+    {
+        view->setField(Dimension::Id::X, i, i);
+        view->setField(Dimension::Id::Y, i, i);
+        view->setField(Dimension::Id::Z, i, i);
+    }
+    EXPECT_EQ(view->build2dIndex().neighbor(9.9, 9.9), 9u);
+
+    PointViewPtr other = view->makeNew();
+    other->appendPoint(*view, 0);
+    other->setField(Dimension::Id::X, 0, 20);
+    other->setField(Dimension::Id::Y, 0, 20);
+    EXPECT_EQ(view->build2dIndex().neighbor(19.9, 19.9), 0u);
+
+    // Moving a point through a PointRef is seen as well.
+    PointRef point(table, 1);
+    point.setField(Dimension::Id::X, 30);
+    point.setField(Dimension::Id::Y, 30);
+    EXPECT_EQ(view->build2dIndex().neighbor(29.9, 29.9), 1u);
+
+    // So is moving points with a bulk set.
+    KD3Index *index3d = &view->build3dIndex();
+    EXPECT_EQ(index3d, &view->build3dIndex());
+    double xs[] = { 50, 51 };
+    view->setFields(Dimension::Id::X, 2, 4, xs);
+    EXPECT_EQ(view->build3dIndex().neighbor(50.9, 3, 3), 3u);
+
+    ColumnPointTable columnTable;
+    layout = columnTable.layout();
+    layout->registerDim(Dimension::Id::X, Dimension::Type::Double);
+    layout->registerDim(Dimension::Id::Y, Dimension::Type::Double);
+    layout->registerDim(Dimension::Id::Z, Dimension::Type::Double);
+    columnTable.finalize();
+    PointView colView(columnTable);
+    for (PointId i = 0; i < 10; ++i)
+    {
+        colView.setField(Dimension::Id::X, i, i);
+        colView.setField(Dimension::Id::Y, i, i);
+        colView.setField(Dimension::Id::Z, i, i);
+    }
+    KD3Index *index = &colView.build3dIndex();
+    EXPECT_EQ(index, &colView.build3dIndex());
+
+    // A read-only column keeps the index.
+    const ColumnPointTable& constTable(columnTable);
+    EXPECT_EQ(constTable.column<double>(Dimension::Id::X)[5], 5);
+    EXPECT_EQ(index, &colView.build3dIndex());
+
+    ColumnSpan<double> x = columnTable.column<double>(Dimension::Id::X);
+    ColumnSpan<double> y = columnTable.column<double>(Dimension::Id::Y);
+    ColumnSpan<double> z = columnTable.column<double>(Dimension::Id::Z);
+    x[5] = y[5] = z[5] = 40;
+    EXPECT_EQ(colView.build3dIndex().neighbor(39.9, 39.9, 39.9), 5u);
+}
+
+
 static void check_bounds(const BOX3D& box,
                          double minx, double maxx,
                          double miny, double maxy,
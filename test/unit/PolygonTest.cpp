@@ -43,6 +43,8 @@
 #include <pdal/Polygon.hpp>
 #include "Support.hpp"
 
+#include <random>
+
 
 
 namespace pdal
@@ -142,6 +144,57 @@ TEST(PolygonTest, covers)
     EXPECT_EQ(covered, true);
 }
 
+// Compare the native batch test against a GEOS prepared geometry.
+TEST(PolygonTest, coversBatch)
+{
+    std::vector<std::string> wkts { getWKT(),
+        "MULTIPOLYGON (((0 0, 10 0, 10 10, 0 10, 0 0), "
+            "(2 2, 2 8, 8 8, 8 2, 2 2)), ((20 0, 30 5, 20 10, 20 0)))" };
+
+    GEOSContextHandle_t ctx = geos::ErrorHandler::get().ctx();
+    for (const std::string& wkt : wkts)
+    {
+        pdal::Polygon p(wkt);
+        BOX3D b = p.bounds();
+
+        // Random points around the polygon and points on the grid lines
+        // through its bounds, many of which are on edges.
+        std::vector<double> x, y;
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<double> dx(b.minx - 1, b.maxx + 1);
+        std::uniform_real_distribution<double> dy(b.miny - 1, b.maxy + 1);
+        for (int i = 0; i < 10000; ++i)
+        {
+            x.push_back(dx(gen));
+            y.push_back(dy(gen));
+        }
+        for (int i = 0; i <= 30; ++i)
+            for (int j = 0; j <= 30; ++j)
+            {
+                x.push_back(b.minx + i * (b.maxx - b.minx) / 30);
+                y.push_back(b.miny + j * (b.maxy - b.miny) / 30);
+            }
+
+        std::vector<uint8_t> covers(x.size());
+        p.covers(x.data(), y.data(), x.size(), covers.data());
+
+        GEOSGeometry *g = GEOSGeomFromWKT_r(ctx, wkt.c_str());
+        const GEOSPreparedGeometry *pg = GEOSPrepare_r(ctx, g);
+        for (size_t i = 0; i < x.size(); ++i)
+        {
+            GEOSCoordSequence *seq = GEOSCoordSeq_create_r(ctx, 1, 2);
+            GEOSCoordSeq_setX_r(ctx, seq, 0, x[i]);
+            GEOSCoordSeq_setY_r(ctx, seq, 0, y[i]);
+            GEOSGeometry *pt = GEOSGeom_createPoint_r(ctx, seq);
+            bool expected = GEOSPreparedCovers_r(ctx, pg, pt);
+            GEOSGeom_destroy_r(ctx, pt);
+            EXPECT_EQ(expected, (bool)covers[i]) << x[i] << ", " << y[i];
+        }
+        GEOSPreparedGeom_destroy_r(ctx, pg);
+        GEOSGeom_destroy_r(ctx, g);
+    }
+}
+
 TEST(PolygonTest, valid)
 {
     pdal::Polygon p(getWKT());
@@ -0,0 +1,99 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include <pdal/util/RadixSort.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Sort with the radix sort and with std::stable_sort and compare.
+void check(std::vector<uint64_t> keys, std::size_t threads)
+{
+    std::vector<uint64_t> values(keys.size());
+    std::vector<std::pair<uint64_t, uint64_t>> expected;
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        values[i] = i;
+        expected.push_back(std::make_pair(keys[i], i));
+    }
+    std::stable_sort(expected.begin(), expected.end(),
+        [](const std::pair<uint64_t, uint64_t>& p1,
+            const std::pair<uint64_t, uint64_t>& p2)
+        { return p1.first < p2.first; });
+
+    Utils::radixSort(keys, values, threads);
+    ASSERT_EQ(keys.size(), expected.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        EXPECT_EQ(keys[i], expected[i].first);
+        EXPECT_EQ(values[i], expected[i].second);
+    }
+}
+
+} // unnamed namespace
+
+TEST(RadixSortTest, random)
+{
+    std::mt19937_64 gen(1);
+    for (std::size_t threads : { 1, 4 })
+    {
+        std::vector<uint64_t> keys(300000);
+        for (uint64_t& k : keys)
+            k = gen();
+        check(keys, threads);
+    }
+}
+
+// Keys with few distinct values and with bits that are the same in all
+// keys, which skip some digits.
+TEST(RadixSortTest, sparse)
+{
+    std::mt19937_64 gen(2);
+    for (std::size_t threads : { 1, 4 })
+    {
+        std::vector<uint64_t> keys(300000);
+        for (uint64_t& k : keys)
+            k = ((gen() % 100) << 40) | 0xFF00;
+        check(keys, threads);
+    }
+    check(std::vector<uint64_t>(1000, 5), 1);
+    check(std::vector<uint64_t>(), 1);
+}
@@ -38,6 +38,7 @@
 #include <pdal/PointTable.hpp>
 #include <FauxReader.hpp>
 #include <MergeFilter.hpp>
+#include <RangeFilter.hpp>
 #include <StreamCallbackFilter.hpp>
 #include "Support.hpp"
 
@@ -106,3 +107,93 @@ TEST(Streaming, filter)
     f.execute(t);
     EXPECT_EQ(cnt, 400);
 }
+
+// Points that are filtered out by a stage that processes batches shouldn't
+// be passed to later stages, and a partially filled table should be
+// processed at the end of input.
+TEST(Streaming, batch)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 104, 104, 104));
+    ro.add("mode", "ramp");
+    ro.add("count", 105);
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options rangeOps;
+    rangeOps.add("limits", "X[10:49], X[95:104]");
+    RangeFilter range;
+    range.setOptions(rangeOps);
+    range.setInput(r);
+
+    StreamCallbackFilter f;
+    std::vector<int> xs;
+    auto cb = [&xs](PointRef& point)
+    {
+        xs.push_back(point.getFieldAs<int>(Dimension::Id::X));
+        return true;
+    };
+    f.setCallback(cb);
+    f.setInput(range);
+
+    FixedPointTable t(20);
+    f.prepare(t);
+    f.execute(t);
+
+    ASSERT_EQ(xs.size(), 50u);
+    for (int i = 0; i < 40; ++i)
+        EXPECT_EQ(xs[i], i + 10);
+    for (int i = 40; i < 50; ++i)
+        EXPECT_EQ(xs[i], i + 55);
+}
+
+// With more than one table buffer, the reader, filters and final stage
+// run concurrently, but points must reach each stage in order.
+TEST(Streaming, pipelined)
+{
+    Options ro;
+    ro.add("bounds", BOX3D(0, 0, 0, 999, 999, 999));
+    ro.add("mode", "ramp");
+    ro.add("count", 1000);
+    FauxReader r;
+    r.setOptions(ro);
+
+    Options rangeOps;
+    rangeOps.add("limits", "X[100:899]");
+    RangeFilter range;
+    range.setOptions(rangeOps);
+    range.setInput(r);
+
+    StreamCallbackFilter f;
+    std::vector<int> xs;
+    auto cb = [&xs](PointRef& point)
+    {
+        xs.push_back(point.getFieldAs<int>(Dimension::Id::X));
+        return true;
+    };
+    f.setCallback(cb);
+    f.setInput(range);
+
+    FixedPointTable t(7, 3);
+    f.prepare(t);
+    f.execute(t);
+
+    ASSERT_EQ(xs.size(), 800u);
+    for (int i = 0; i < 800; ++i)
+        EXPECT_EQ(xs[i], i + 100);
+
+    // Reader and final stage only.
+    StreamCallbackFilter f2;
+    int cnt = 0;
+    f2.setCallback([&cnt](PointRef& point)
+    {
+        EXPECT_EQ(point.getFieldAs<int>(Dimension::Id::X), cnt++);
+        return true;
+    });
+    f2.setInput(r);
+
+    FixedPointTable t2(64, 2);
+    f2.prepare(t2);
+    f2.execute(t2);
+    EXPECT_EQ(cnt, 1000);
+}
@@ -0,0 +1,91 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <atomic>
+#include <stdexcept>
+
+#include <pdal/util/ThreadPool.hpp>
+
+using namespace pdal;
+
+TEST(ThreadPoolTest, run)
+{
+    ThreadPool pool(4, 2);
+    std::atomic<int> cnt(0);
+
+    for (int i = 0; i < 1000; ++i)
+        pool.add([&cnt](){ cnt++; });
+    pool.join();
+    EXPECT_EQ(cnt, 1000);
+
+    // The pool can be reused after a join.
+    for (int i = 0; i < 10; ++i)
+        pool.add([&cnt](){ cnt++; });
+    pool.join();
+    EXPECT_EQ(cnt, 1010);
+}
+
+TEST(ThreadPoolTest, nested)
+{
+    ThreadPool pool(3, 1);
+    std::atomic<int> cnt(0);
+
+    // Tasks that add tasks mustn't deadlock even when the queue is full.
+    for (int i = 0; i < 20; ++i)
+        pool.add([&pool, &cnt]()
+        {
+            for (int j = 0; j < 10; ++j)
+                pool.add([&cnt](){ cnt++; });
+        });
+    pool.join();
+    EXPECT_EQ(cnt, 200);
+}
+
+TEST(ThreadPoolTest, exception)
+{
+    ThreadPool pool(2);
+    std::atomic<int> cnt(0);
+
+    pool.add([](){ throw std::runtime_error("Task failed."); });
+    for (int i = 0; i < 10; ++i)
+        pool.add([&cnt](){ cnt++; });
+    EXPECT_THROW(pool.join(), std::runtime_error);
+    EXPECT_EQ(cnt, 10);
+
+    // The error is cleared once reported.
+    pool.add([&cnt](){ cnt++; });
+    EXPECT_NO_THROW(pool.join());
+}
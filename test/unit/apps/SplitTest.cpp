@@ -0,0 +1,180 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. nor the names of contributors
+*       may be used to endorse or promote products derived from this
+*       software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <pdal/pdal_test_main.hpp>
+#include <pdal/util/FileUtils.hpp>
+#include <pdal/util/Utils.hpp>
+#include <LasReader.hpp>
+
+#include "Support.hpp"
+
+using namespace pdal;
+
+namespace
+{
+
+typedef std::vector<std::vector<double>> FileList;
+
+std::string appName()
+{
+    return Support::binpath("pdal split");
+}
+
+std::string outName(const std::string& base, int i)
+{
+    return Support::temppath(base + "_" + std::to_string(i) + ".las");
+}
+
+// Run the split command and return the X, Y and Z values of the points of
+// each output file in order.
+FileList split(const std::string& base, const std::string& args)
+{
+    for (int i = 1; FileUtils::fileExists(outName(base, i)); ++i)
+        FileUtils::deleteFile(outName(base, i));
+
+    const std::string cmd = appName() + " " + args + " " +
+        Support::datapath("las/1.2-with-color.las") + " " +
+        Support::temppath(base + ".las");
+    std::string output;
+    Utils::run_shell_command(cmd, output);
+
+    FileList files;
+    for (int i = 1; FileUtils::fileExists(outName(base, i)); ++i)
+    {
+        Options o;
+        o.add("filename", outName(base, i));
+
+        PointTable t;
+        LasReader r;
+        r.setOptions(o);
+        r.prepare(t);
+        PointViewSet s = r.execute(t);
+        EXPECT_EQ(s.size(), 1u);
+        PointViewPtr v = *s.begin();
+
+        files.emplace_back();
+        for (PointId idx = 0; idx < v->size(); ++idx)
+        {
+            files.back().push_back(
+                v->getFieldAs<double>(Dimension::Id::X, idx));
+            files.back().push_back(
+                v->getFieldAs<double>(Dimension::Id::Y, idx));
+            files.back().push_back(
+                v->getFieldAs<double>(Dimension::Id::Z, idx));
+        }
+        FileUtils::deleteFile(outName(base, i));
+    }
+    return files;
+}
+
+// Sorted X, Y and Z values of all the points in a list of files.
+std::vector<std::vector<double>> allPoints(const FileList& files)
+{
+    std::vector<std::vector<double>> points;
+    for (auto& f : files)
+        for (size_t i = 0; i < f.size(); i += 3)
+            points.push_back({ f[i], f[i + 1], f[i + 2] });
+    std::sort(points.begin(), points.end());
+    return points;
+}
+
+}
+
+TEST(Split, stream_length)
+{
+    FileList mem = split("split_mem", "--length 1000");
+    FileList stream = split("split_stream", "--length 1000 --stream");
+    EXPECT_EQ(mem.size(), 15u);
+    EXPECT_TRUE(mem == stream);
+
+    // Closing and reopening cell files mustn't change the output.
+    stream = split("split_stream", "--length 1000 --stream --max_open 2");
+    EXPECT_TRUE(mem == stream);
+}
+
+TEST(Split, stream_capacity)
+{
+    FileList mem = split("split_mem", "--capacity 100");
+    FileList stream = split("split_stream", "--capacity 100 --stream");
+    EXPECT_EQ(mem.size(), 11u);
+    EXPECT_TRUE(mem == stream);
+}
+
+// Streamed splits overlap reading and routing when given more than one
+// buffer.  The output must be the same as with a single buffer.
+TEST(Split, stream_buffers)
+{
+    FileList mem = split("split_mem", "--length 1000");
+    FileList stream = split("split_stream",
+        "--length 1000 --stream --buffers 1");
+    EXPECT_TRUE(mem == stream);
+    stream = split("split_stream", "--length 1000 --stream --buffers 4");
+    EXPECT_TRUE(mem == stream);
+
+    mem = split("split_mem", "--capacity 100");
+    stream = split("split_stream", "--capacity 100 --stream --buffers 4");
+    EXPECT_TRUE(mem == stream);
+}
+
+// An input larger than a strip is chipped one strip at a time.  The chips
+// differ from the in-memory split, but each holds no more than the capacity
+// and every point is written once.
+TEST(Split, stream_strips)
+{
+    FileList mem = split("split_mem", "--capacity 100");
+    FileList stream = split("split_stream",
+        "--capacity 100 --stream --strip_points 300");
+    EXPECT_FALSE(mem == stream);
+    EXPECT_GE(stream.size(), 11u);
+    for (auto& f : stream)
+    {
+        EXPECT_LE(f.size(), 300u);
+        EXPECT_GT(f.size(), 0u);
+    }
+    EXPECT_TRUE(allPoints(mem) == allPoints(stream));
+
+    size_t count = 0;
+    for (auto& f : stream)
+        count += f.size() / 3;
+    EXPECT_EQ(count, 1065u);
+
+    // With a single strip the output matches the in-memory split.
+    stream = split("split_stream",
+        "--capacity 100 --stream --strip_points 2000");
+    EXPECT_TRUE(mem == stream);
+}
@@ -120,6 +120,59 @@ TEST(ChipperTest, empty_buffer)
     EXPECT_EQ(viewSet.size(), 0u);
 }
 
+// Chips must be the same, and in the same order, whatever the number of
+// threads.
+TEST(ChipperTest, threads)
+{
+    auto chip = [](uint32_t threads)
+    {
+        PointTable table;
+
+        Options ops;
+        ops.add("capacity", 1000);
+        ops.add("threads", threads);
+
+        ChipperFilter chipper;
+        chipper.setOptions(ops);
+        chipper.prepare(table);
+        table.layout()->registerDim(Dimension::Id::X);
+        table.layout()->registerDim(Dimension::Id::Y);
+        table.layout()->registerDim(Dimension::Id::PointSourceId,
+            Dimension::Type::Unsigned32);
+
+        PointViewPtr view(new PointView(table));
+        uint32_t seed = 1;
+        for (PointId i = 0; i < 200000; ++i)
+        {
+            seed = seed * 1103515245 + 12345;
+            view->setField(Dimension::Id::X, i, (seed >> 8) % 100000);
+            seed = seed * 1103515245 + 12345;
+            view->setField(Dimension::Id::Y, i, (seed >> 8) % 50000);
+            view->setField(Dimension::Id::PointSourceId, i, i);
+        }
+
+        StageWrapper::ready(chipper, table);
+        PointViewSet viewSet = StageWrapper::run(chipper, view);
+        StageWrapper::done(chipper, table);
+
+        std::vector<std::vector<uint32_t>> chips;
+        for (auto& v : viewSet)
+        {
+            chips.emplace_back();
+            for (PointId i = 0; i < v->size(); ++i)
+                chips.back().push_back(v->getFieldAs<uint32_t>(
+                    Dimension::Id::PointSourceId, i));
+        }
+        return chips;
+    };
+
+    std::vector<std::vector<uint32_t>> chips = chip(1);
+    EXPECT_EQ(chips.size(), 200u);
+    for (auto& c : chips)
+        EXPECT_EQ(c.size(), 1000u);
+    EXPECT_TRUE(chips == chip(4));
+}
+
 //ABELL
 /**
 TEST(ChipperTest, test_ordering)
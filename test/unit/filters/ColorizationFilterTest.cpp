@@ -34,10 +34,15 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <gdal.h>
+
+#include <BufferReader.hpp>
 #include <LasReader.hpp>
 #include <ColorizationFilter.hpp>
 #include <StreamCallbackFilter.hpp>
+#include <pdal/GDALUtils.hpp>
 #include <pdal/PointView.hpp>
+#include <pdal/util/FileUtils.hpp>
 
 #include "Support.hpp"
 
@@ -159,6 +164,23 @@ TEST(ColorizationFilterTest, test2)
     testFile(options, dims, 210, 205, 185);
 }
 
+// Make sure band numbers are honored when they aren't in order.
+TEST(ColorizationFilterTest, bandOrder)
+{
+    Options options;
+
+    options.add("dimensions", "Red:3, Green:2, Blue:1");
+    options.add("raster", Support::datapath("autzen/autzen.jpg"),
+        "raster to read");
+
+    StringList dims;
+    dims.push_back("Red");
+    dims.push_back("Green");
+    dims.push_back("Blue");
+    testFile(options, dims, 185, 205, 210);
+    testFileStreamed(options, dims, 185, 205, 210);
+}
+
 // Check that dimension creation works.
 TEST(ColorizationFilterTest, test3)
 {
@@ -191,4 +213,62 @@ TEST(ColorizationFilterTest, test4)
     EXPECT_THROW(testFile(options, dims, 210, 205, 47175), pdal_error);
 }
 
+// Nodata pixels are left out of the bilinear interpolation.
+TEST(ColorizationFilterTest, bilinear)
+{
+    // A 2x2 raster covering (0, 0) to (2, 2).  The lower right pixel is
+    // nodata.
+    std::string filename = Support::temppath("bilinear.tif");
+    FileUtils::deleteFile(filename);
+    gdal::registerDrivers();
+    GDALDatasetH ds = GDALCreate(GDALGetDriverByName("GTiff"),
+        filename.c_str(), 2, 2, 1, GDT_Byte, NULL);
+    ASSERT_TRUE(ds != NULL);
+    double transform[6] = { 0, 1, 0, 2, 0, -1 };
+    GDALSetGeoTransform(ds, transform);
+    GDALRasterBandH band = GDALGetRasterBand(ds, 1);
+    GDALSetRasterNoDataValue(band, 255);
+    uint8_t pixels[4] = { 10, 20, 30, 255 };
+    EXPECT_EQ(GDALRasterIO(band, GF_Write, 0, 0, 2, 2, pixels, 2, 2,
+        GDT_Byte, 0, 0), CE_None);
+    GDALClose(ds);
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    BufferReader reader;
+
+    Options options;
+    options.add("dimensions", "Red:1");
+    options.add("raster", filename);
+    options.add("bilinear", true);
+    ColorizationFilter filter;
+    filter.setOptions(options);
+    filter.setInput(reader);
+    filter.prepare(table);
+
+    // The center of the raster, the center of a valid pixel and the
+    // center of the nodata pixel.
+    PointViewPtr view(new PointView(table));
+    view->setField(Dimension::Id::X, 0, 1.0);
+    view->setField(Dimension::Id::Y, 0, 1.0);
+    view->setField(Dimension::Id::X, 1, .5);
+    view->setField(Dimension::Id::Y, 1, 1.5);
+    view->setField(Dimension::Id::X, 2, 1.5);
+    view->setField(Dimension::Id::Y, 2, .5);
+    for (PointId i = 0; i < view->size(); ++i)
+        view->setField(Dimension::Id::Z, i, 0);
+    reader.addView(view);
 
+    PointViewSet viewSet = filter.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    view = *viewSet.begin();
+
+    EXPECT_EQ(view->getFieldAs<uint16_t>(Dimension::Id::Red, 0), 20u);
+    EXPECT_EQ(view->getFieldAs<uint16_t>(Dimension::Id::Red, 1), 10u);
+    EXPECT_EQ(view->getFieldAs<uint16_t>(Dimension::Id::Red, 2), 255u);
+
+    FileUtils::deleteFile(filename);
+}
@@ -34,7 +34,10 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <atomic>
+
 #include <FauxReader.hpp>
+#include <DecimationFilter.hpp>
 #include <DividerFilter.hpp>
 
 using namespace pdal;
@@ -202,3 +205,122 @@ TEST(DividerFilterTest, round_robin_capacity)
     }
 }
 
+
+// Views are run concurrently by a thread-safe stage, but output views must
+// be ordered as they would be by a serial run.
+TEST(DividerFilterTest, threaded_downstream)
+{
+    point_count_t count = 1000;
+
+    Options readerOps;
+    readerOps.add("bounds", BOX3D(1, 1, 1, count, count, count));
+    readerOps.add("mode", "ramp");
+    readerOps.add("num_points", count);
+
+    FauxReader r;
+    r.setOptions(readerOps);
+
+    Options filterOps;
+    filterOps.add("count", 10);
+    DividerFilter f;
+    f.setInput(r);
+    f.setOptions(filterOps);
+
+    Options decimationOps;
+    decimationOps.add("step", 2);
+    decimationOps.add("threads", 4);
+    DecimationFilter d;
+    d.setInput(f);
+    d.setOptions(decimationOps);
+
+    PointTable t;
+    d.prepare(t);
+    PointViewSet s = d.execute(t);
+
+    EXPECT_EQ(s.size(), 10u);
+
+    PointId i = 0;
+    for (PointViewPtr v : s)
+    {
+        EXPECT_EQ(v->size(), 50u);
+        for (PointId p = 0; p < v->size(); ++p)
+        {
+            EXPECT_DOUBLE_EQ((double)(2 * i + 1),
+                v->getFieldAs<double>(Dimension::Id::X, p));
+            i++;
+        }
+    }
+}
+
+
+namespace
+{
+
+// Thread-safe filter that records the number of threads it may use.
+class ThreadCountFilter : public Filter
+{
+public:
+    std::string getName() const
+        { return "filters.threadcount"; }
+
+    std::atomic<std::size_t> m_maxThreads;
+
+private:
+    virtual bool threadSafe() const
+        { return true; }
+
+    virtual PointViewSet run(PointViewPtr view)
+    {
+        std::size_t threads = numThreads();
+        std::size_t prev = m_maxThreads;
+        while (threads > prev &&
+                !m_maxThreads.compare_exchange_weak(prev, threads))
+            ;
+
+        PointViewSet viewSet;
+        viewSet.insert(view);
+        return viewSet;
+    }
+};
+
+}
+
+// Views run concurrently share the stage's thread budget.
+TEST(DividerFilterTest, thread_budget)
+{
+    auto maxThreads = [](uint32_t views)
+    {
+        Options readerOps;
+        readerOps.add("bounds", BOX3D(1, 1, 1, 100, 100, 100));
+        readerOps.add("mode", "ramp");
+        readerOps.add("num_points", 100);
+
+        FauxReader r;
+        r.setOptions(readerOps);
+
+        Options filterOps;
+        filterOps.add("count", views);
+        DividerFilter f;
+        f.setInput(r);
+        f.setOptions(filterOps);
+
+        Options threadOps;
+        threadOps.add("threads", 8);
+        ThreadCountFilter t;
+        t.m_maxThreads = 0;
+        if (views > 1)
+            t.setInput(f);
+        else
+            t.setInput(r);
+        t.setOptions(threadOps);
+
+        PointTable table;
+        t.prepare(table);
+        t.execute(table);
+        return (std::size_t)t.m_maxThreads;
+    };
+
+    EXPECT_EQ(maxThreads(1), 8u);
+    EXPECT_EQ(maxThreads(4), 2u);
+    EXPECT_EQ(maxThreads(16), 1u);
+}
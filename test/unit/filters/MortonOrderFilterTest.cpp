@@ -0,0 +1,130 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc.
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include <pdal/PointView.hpp>
+#include <BufferReader.hpp>
+#include <MortonOrderFilter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Sort a 16 x 16 grid of points, added in random order.
+PointViewPtr sortGrid(PointTable& table, const std::string& curve)
+{
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+
+    BufferReader reader;
+    Options opts;
+    opts.add("curve", curve);
+    opts.add("dimension", "Key");
+    MortonOrderFilter filter;
+    filter.setOptions(opts);
+    filter.setInput(reader);
+    filter.prepare(table);
+
+    std::vector<int> cells(256);
+    for (int i = 0; i < 256; ++i)
+        cells[i] = i;
+    std::shuffle(cells.begin(), cells.end(), std::mt19937(1));
+    PointViewPtr view(new PointView(table));
+    for (PointId id = 0; id < cells.size(); ++id)
+    {
+        view->setField(Dimension::Id::X, id, cells[id] / 16);
+        view->setField(Dimension::Id::Y, id, cells[id] % 16);
+    }
+    reader.addView(view);
+
+    PointViewSet viewSet = filter.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    return *viewSet.begin();
+}
+
+} // unnamed namespace
+
+TEST(MortonOrderFilterTest, morton)
+{
+    PointTable table;
+    PointViewPtr view = sortGrid(table, "morton");
+    ASSERT_EQ(view->size(), 256u);
+
+    // The position along the Z-order curve of a cell of the grid.
+    auto zorder = [](int x, int y)
+    {
+        int pos = 0;
+        for (int bit = 3; bit >= 0; --bit)
+            pos = (pos << 2) | (((x >> bit) & 1) << 1) | ((y >> bit) & 1);
+        return pos;
+    };
+
+    Dimension::Id::Enum key = view->layout()->findDim("Key");
+    for (PointId id = 0; id < view->size(); ++id)
+    {
+        int x = view->getFieldAs<int>(Dimension::Id::X, id);
+        int y = view->getFieldAs<int>(Dimension::Id::Y, id);
+        EXPECT_EQ(zorder(x, y), (int)id);
+        if (id)
+            EXPECT_LT(view->getFieldAs<uint64_t>(key, id - 1),
+                view->getFieldAs<uint64_t>(key, id));
+    }
+    // The key is truncated to 52 bits.
+    EXPECT_EQ(view->getFieldAs<uint64_t>(key, 255), (1ULL << 52) - 1);
+}
+
+TEST(MortonOrderFilterTest, hilbert)
+{
+    PointTable table;
+    PointViewPtr view = sortGrid(table, "hilbert");
+    ASSERT_EQ(view->size(), 256u);
+
+    // Consecutive points along the Hilbert curve are neighbors.
+    EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::X, 0), 0);
+    EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::Y, 0), 0);
+    for (PointId id = 1; id < view->size(); ++id)
+    {
+        double dx = view->getFieldAs<double>(Dimension::Id::X, id) -
+            view->getFieldAs<double>(Dimension::Id::X, id - 1);
+        double dy = view->getFieldAs<double>(Dimension::Id::Y, id) -
+            view->getFieldAs<double>(Dimension::Id::Y, id - 1);
+        EXPECT_EQ(std::abs(dx) + std::abs(dy), 1.0);
+    }
+}
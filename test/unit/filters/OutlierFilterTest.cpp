@@ -0,0 +1,121 @@
+/******************************************************************************
+* Copyright (c) 2016, Hobu Inc. (info@hobu.co)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <algorithm>
+#include <random>
+
+#include <pdal/PointView.hpp>
+#include <BufferReader.hpp>
+#include <OutlierFilter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+// Run the outlier filter on a fixed random cloud: a thin layer of points
+// with a few points scattered well above it.  Returns the classification
+// of each point.
+std::vector<int> classify(Options opts)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    BufferReader reader;
+
+    opts.add("classify", true);
+    OutlierFilter filter;
+    filter.setOptions(opts);
+    filter.setInput(reader);
+    filter.prepare(table);
+
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<double> xy(0, 50);
+    std::uniform_real_distribution<double> z(0, 1);
+    std::uniform_real_distribution<double> high(10, 30);
+
+    PointViewPtr view(new PointView(table));
+    for (PointId i = 0; i < 5000; ++i)
+    {
+        view->setField(Dimension::Id::X, i, xy(gen));
+        view->setField(Dimension::Id::Y, i, xy(gen));
+        view->setField(Dimension::Id::Z, i, i % 200 ? z(gen) : high(gen));
+    }
+    reader.addView(view);
+
+    PointViewSet viewSet = filter.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    PointViewPtr out = *viewSet.begin();
+
+    std::vector<int> classes;
+    for (PointId i = 0; i < out->size(); ++i)
+        classes.push_back(
+            out->getFieldAs<int>(Dimension::Id::Classification, i));
+    return classes;
+}
+
+} // unnamed namespace
+
+// Searching in tiles, serially or concurrently, finds the same outliers
+// as searching all the points together.
+TEST(OutlierFilterTest, tiles)
+{
+    for (std::string method : { "radius", "statistical" })
+    {
+        Options opts;
+        opts.add("method", method);
+        opts.add("radius", 2.0);
+        opts.add("min_k", 4);
+        opts.add("mean_k", 8);
+
+        std::vector<int> untiled = classify(opts);
+        ASSERT_EQ(untiled.size(), 5000u);
+        EXPECT_GT(std::count(untiled.begin(), untiled.end(), 18), 0)
+            << method;
+
+        for (int threads : { 1, 4 })
+        {
+            Options tileOpts(opts);
+            tileOpts.add("tile_size", 7.0);
+            tileOpts.add("threads", threads);
+            EXPECT_EQ(classify(tileOpts), untiled) << method << " " <<
+                threads;
+        }
+    }
+}
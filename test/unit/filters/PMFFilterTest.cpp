@@ -0,0 +1,124 @@
+/******************************************************************************
+* Copyright (c) 2015, Bradley J Chambers (brad.chambers@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <pdal/PointView.hpp>
+#include <BufferReader.hpp>
+#include <PMFFilter.hpp>
+
+using namespace pdal;
+
+// A block on flat ground is removed from the ground by both the exact and
+// the raster algorithms.
+TEST(PMFFilterTest, block)
+{
+    for (bool approximate : { false, true })
+    {
+        PointTable table;
+        table.layout()->registerDim(Dimension::Id::X);
+        table.layout()->registerDim(Dimension::Id::Y);
+        table.layout()->registerDim(Dimension::Id::Z);
+
+        BufferReader reader;
+
+        Options opts;
+        opts.add("max_window_size", 16);
+        opts.add("approximate", approximate);
+        opts.add("extract", true);
+        PMFFilter filter;
+        filter.setOptions(opts);
+        filter.setInput(reader);
+
+        // The filter adds Classification, so the layout is only complete
+        // once it's prepared.
+        filter.prepare(table);
+
+        // A 40m square of ground with a 6m square, 10m high block in the
+        // middle.  Points are 1m apart.
+        PointViewPtr view(new PointView(table));
+        PointId id = 0;
+        for (int x = 0; x < 40; ++x)
+            for (int y = 0; y < 40; ++y)
+            {
+                bool block = (x >= 17 && x < 23 && y >= 17 && y < 23);
+                view->setField(Dimension::Id::X, id, x + .5);
+                view->setField(Dimension::Id::Y, id, y + .5);
+                view->setField(Dimension::Id::Z, id, block ? 10.0 : 0.0);
+                id++;
+            }
+        reader.addView(view);
+
+        PointViewSet viewSet = filter.execute(table);
+        ASSERT_EQ(viewSet.size(), 1u);
+        PointViewPtr ground = *viewSet.begin();
+
+        EXPECT_EQ(ground->size(), 40u * 40u - 6u * 6u);
+        for (PointId i = 0; i < ground->size(); ++i)
+            EXPECT_EQ(ground->getFieldAs<double>(Dimension::Id::Z, i), 0.0);
+    }
+}
+
+// A raster too large for the approximate algorithm is an error rather than
+// a huge allocation.
+TEST(PMFFilterTest, rasterLimit)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    BufferReader reader;
+
+    Options opts;
+    opts.add("approximate", true);
+    opts.add("cell_size", .001);
+    PMFFilter filter;
+    filter.setOptions(opts);
+    filter.setInput(reader);
+    filter.prepare(table);
+
+    PointViewPtr view(new PointView(table));
+    view->setField(Dimension::Id::X, 0, 0);
+    view->setField(Dimension::Id::Y, 0, 0);
+    view->setField(Dimension::Id::Z, 0, 0);
+    view->setField(Dimension::Id::X, 1, 100000);
+    view->setField(Dimension::Id::Y, 1, 100000);
+    view->setField(Dimension::Id::Z, 1, 0);
+    reader.addView(view);
+
+    EXPECT_THROW(filter.execute(table), pdal_error);
+}
@@ -56,6 +56,61 @@ void getPoint(const PointView& data, double& x, double& y, double& z)
 }
 #endif
 
+// Reproject a file to geographic coordinates using a number of threads,
+// in standard or stream mode.  Returns the coordinates of the points.
+std::vector<double> reproject(int threads, bool stream)
+{
+    Options readerOps;
+    readerOps.add("filename", Support::datapath("las/1.2-with-color.las"));
+    readerOps.add("spatialreference",
+        Support::datapath("autzen/autzen-srs.wkt"));
+    LasReader reader;
+    reader.setOptions(readerOps);
+
+    Options options;
+    options.add("out_srs", "EPSG:4326");
+    options.add("threads", threads);
+    ReprojectionFilter filter;
+    filter.setOptions(options);
+    filter.setInput(reader);
+
+    std::vector<double> coords;
+    if (stream)
+    {
+        auto cb = [&coords](PointRef& point)
+        {
+            coords.push_back(point.getFieldAs<double>(Dimension::Id::X));
+            coords.push_back(point.getFieldAs<double>(Dimension::Id::Y));
+            coords.push_back(point.getFieldAs<double>(Dimension::Id::Z));
+            return true;
+        };
+
+        StreamCallbackFilter callback;
+        callback.setCallback(cb);
+        callback.setInput(filter);
+
+        // Batches large enough to be split among the threads.
+        FixedPointTable table(4096);
+        callback.prepare(table);
+        callback.execute(table);
+    }
+    else
+    {
+        PointTable table;
+        filter.prepare(table);
+        PointViewSet viewSet = filter.execute(table);
+        EXPECT_EQ(viewSet.size(), 1u);
+        PointViewPtr view = *viewSet.begin();
+        for (PointId i = 0; i < view->size(); ++i)
+        {
+            coords.push_back(view->getFieldAs<double>(Dimension::Id::X, i));
+            coords.push_back(view->getFieldAs<double>(Dimension::Id::Y, i));
+            coords.push_back(view->getFieldAs<double>(Dimension::Id::Z, i));
+        }
+    }
+    return coords;
+}
+
 } // unnamed namespace
 
 
@@ -152,3 +207,15 @@ TEST(ReprojectionFilterTest, stream_test_1)
 }
 #endif
 
+
+// Reprojecting with several threads gives the same points as reprojecting
+// with one, in both standard and stream modes.
+TEST(ReprojectionFilterTest, threads)
+{
+    for (bool stream : { false, true })
+    {
+        std::vector<double> serial = reproject(1, stream);
+        EXPECT_EQ(serial.size(), 1065u * 3);
+        EXPECT_EQ(reproject(4, stream), serial) << stream;
+    }
+}
@@ -0,0 +1,191 @@
+/******************************************************************************
+* Copyright (c) 2016, Bradley J Chambers (brad.chambers@gmail.com)
+*
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following
+* conditions are met:
+*
+*     * Redistributions of source code must retain the above copyright
+*       notice, this list of conditions and the following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright
+*       notice, this list of conditions and the following disclaimer in
+*       the documentation and/or other materials provided
+*       with the distribution.
+*     * Neither the name of Hobu, Inc. or Flaxen Geo Consulting nor the
+*       names of its contributors may be used to endorse or promote
+*       products derived from this software without specific prior
+*       written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+* OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+* OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+* OF SUCH DAMAGE.
+****************************************************************************/
+
+
+#include <pdal/pdal_test_main.hpp>
+
+#include <random>
+
+#include <pdal/PointView.hpp>
+#include <pdal/StageFactory.hpp>
+#include <BufferReader.hpp>
+#include <FauxReader.hpp>
+#include <SampleFilter.hpp>
+#include <StreamCallbackFilter.hpp>
+
+using namespace pdal;
+
+namespace
+{
+
+struct Xyz
+{
+    double x;
+    double y;
+    double z;
+};
+
+// Check that no two points are closer than radius.
+void checkSpacing(const std::vector<Xyz>& points, double radius)
+{
+    for (size_t i = 0; i < points.size(); ++i)
+        for (size_t j = i + 1; j < points.size(); ++j)
+        {
+            double dx = points[i].x - points[j].x;
+            double dy = points[i].y - points[j].y;
+            double dz = points[i].z - points[j].z;
+            EXPECT_GE(dx * dx + dy * dy + dz * dz, radius * radius);
+        }
+}
+
+// Sample a fixed cloud of points randomly spread through a 10m cube.
+std::vector<Xyz> sample(uint32_t seed)
+{
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+    table.layout()->registerDim(Dimension::Id::Z);
+
+    BufferReader reader;
+
+    Options filterOps;
+    filterOps.add("radius", 1.5);
+    filterOps.add("seed", seed);
+    SampleFilter filter;
+    filter.setOptions(filterOps);
+    filter.setInput(reader);
+    filter.prepare(table);
+
+    std::mt19937 gen(1234);
+    std::uniform_real_distribution<double> u(0, 10);
+    PointViewPtr input(new PointView(table));
+    for (PointId i = 0; i < 2000; ++i)
+    {
+        input->setField(Dimension::Id::X, i, u(gen));
+        input->setField(Dimension::Id::Y, i, u(gen));
+        input->setField(Dimension::Id::Z, i, u(gen));
+    }
+    reader.addView(input);
+
+    PointViewSet viewSet = filter.execute(table);
+    EXPECT_EQ(viewSet.size(), 1u);
+    PointViewPtr view = *viewSet.begin();
+
+    std::vector<Xyz> points;
+    for (PointId i = 0; i < view->size(); ++i)
+        points.push_back(Xyz { view->getFieldAs<double>(Dimension::Id::X, i),
+            view->getFieldAs<double>(Dimension::Id::Y, i),
+            view->getFieldAs<double>(Dimension::Id::Z, i) });
+    return points;
+}
+
+} // unnamed namespace
+
+TEST(SampleFilterTest, create)
+{
+    StageFactory f;
+    Stage* filter(f.createStage("filters.sample"));
+    EXPECT_TRUE(filter);
+}
+
+TEST(SampleFilterTest, badRadius)
+{
+    for (double radius : { 0.0, -1.0 })
+    {
+        Options opts;
+        opts.add("radius", radius);
+        SampleFilter filter;
+        filter.setOptions(opts);
+
+        PointTable table;
+        EXPECT_THROW(filter.prepare(table), pdal_error);
+    }
+}
+
+TEST(SampleFilterTest, spacing)
+{
+    std::vector<Xyz> points = sample(5);
+    EXPECT_GT(points.size(), 5u);
+    EXPECT_LT(points.size(), 2000u);
+    checkSpacing(points, 1.5);
+}
+
+TEST(SampleFilterTest, seed)
+{
+    std::vector<Xyz> a = sample(5);
+    std::vector<Xyz> b = sample(5);
+    ASSERT_EQ(a.size(), b.size());
+    for (size_t i = 0; i < a.size(); ++i)
+    {
+        EXPECT_EQ(a[i].x, b[i].x);
+        EXPECT_EQ(a[i].y, b[i].y);
+        EXPECT_EQ(a[i].z, b[i].z);
+    }
+}
+
+TEST(SampleFilterTest, stream)
+{
+    Options readerOps;
+    readerOps.add("bounds", BOX3D(0, 0, 0, 10, 10, 10));
+    readerOps.add("mode", "uniform");
+    readerOps.add("num_points", 2000);
+    FauxReader reader;
+    reader.setOptions(readerOps);
+
+    Options filterOps;
+    filterOps.add("radius", 1.5);
+    SampleFilter sample;
+    sample.setOptions(filterOps);
+    sample.setInput(reader);
+
+    std::vector<Xyz> points;
+    auto cb = [&points](PointRef& point)
+    {
+        points.push_back(Xyz { point.getFieldAs<double>(Dimension::Id::X),
+            point.getFieldAs<double>(Dimension::Id::Y),
+            point.getFieldAs<double>(Dimension::Id::Z) });
+        return true;
+    };
+    StreamCallbackFilter filter;
+    filter.setCallback(cb);
+    filter.setInput(sample);
+
+    FixedPointTable t(100);
+    filter.prepare(t);
+    filter.execute(t);
+
+    EXPECT_GT(points.size(), 5u);
+    EXPECT_LT(points.size(), 2000u);
+    checkSpacing(points, 1.5);
+}
@@ -89,6 +89,60 @@ TEST(SortFilterTest, simple)
         doSort(count);
 }
 
+// Sort on two dimensions of different types in both orders, with enough
+// points to use several threads.
+TEST(SortFilterTest, multiKey)
+{
+    Options opts;
+    opts.add("dimension", "Classification, GpsTime");
+    opts.add("order", "DESC, ASC");
+    opts.add("threads", 4);
+
+    SortFilter filter;
+    filter.setOptions(opts);
+
+    PointTable table;
+    table.layout()->registerDim(Dimension::Id::Classification);
+    table.layout()->registerDim(Dimension::Id::GpsTime);
+    table.layout()->registerDim(Dimension::Id::PointSourceId);
+    PointViewPtr view(new PointView(table));
+
+    const point_count_t count = 200000;
+    std::default_random_engine generator;
+    std::uniform_int_distribution<int> classes(0, 9);
+    std::uniform_real_distribution<double> times(-1000.0, 1000.0);
+    for (PointId i = 0; i < count; ++i)
+    {
+        view->setField(Dimension::Id::Classification, i, classes(generator));
+        view->setField(Dimension::Id::GpsTime, i, times(generator));
+        view->setField(Dimension::Id::PointSourceId, i, 0);
+    }
+    // Points with equal keys keep their order.
+    view->setField(Dimension::Id::Classification, 1000, 20);
+    view->setField(Dimension::Id::GpsTime, 1000, 5.0);
+    view->setField(Dimension::Id::PointSourceId, 1000, 1);
+    view->setField(Dimension::Id::Classification, 2000, 20);
+    view->setField(Dimension::Id::GpsTime, 2000, 5.0);
+    view->setField(Dimension::Id::PointSourceId, 2000, 2);
+
+    filter.prepare(table);
+    FilterWrapper::ready(filter, table);
+    FilterWrapper::filter(filter, *view.get());
+    FilterWrapper::done(filter, table);
+
+    EXPECT_EQ(count, view->size());
+    EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::PointSourceId, 0), 1);
+    EXPECT_EQ(view->getFieldAs<int>(Dimension::Id::PointSourceId, 1), 2);
+    for (PointId i = 1; i < count; ++i)
+    {
+        int c1 = view->getFieldAs<int>(Dimension::Id::Classification, i - 1);
+        int c2 = view->getFieldAs<int>(Dimension::Id::Classification, i);
+        double t1 = view->getFieldAs<double>(Dimension::Id::GpsTime, i - 1);
+        double t2 = view->getFieldAs<double>(Dimension::Id::GpsTime, i);
+        EXPECT_TRUE(c1 > c2 || (c1 == c2 && t1 <= t2));
+    }
+}
+
 TEST(SortFilterTest, pipelineXML)
 {
     PipelineManager mgr;
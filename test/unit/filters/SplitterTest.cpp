@@ -101,3 +101,47 @@ TEST(SplitterTest, test_tile_filter)
         EXPECT_EQ(view->size(), counts[i]);
     }
 }
+
+TEST(SplitterTest, explicit_origin)
+{
+    Options o;
+    o.add("length", 10.0);
+    o.add("origin_x", 0.0);
+    o.add("origin_y", 0.0);
+
+    SplitterFilter s;
+    s.setOptions(o);
+
+    PointTable table;
+    s.prepare(table);
+    table.layout()->registerDim(Dimension::Id::X);
+    table.layout()->registerDim(Dimension::Id::Y);
+
+    // Points alternate between three cells so that each output view is
+    // filled out of order.
+    PointViewPtr view(new PointView(table));
+    double xs[] = { 1, 25, 3, 22, 35, 8, 29, 31 };
+    double ys[] = { 1, 5, 9, 2, 5, 4, 8, 1 };
+    for (PointId i = 0; i < 8; ++i)
+    {
+        view->setField(Dimension::Id::X, i, xs[i]);
+        view->setField(Dimension::Id::Y, i, ys[i]);
+    }
+
+    StageWrapper::ready(s, table);
+    PointViewSet viewSet = StageWrapper::run(s, view);
+    StageWrapper::done(s, table);
+
+    // Views are created in the order their cells are first seen.
+    ASSERT_EQ(viewSet.size(), 3u);
+    std::vector<PointViewPtr> views(viewSet.begin(), viewSet.end());
+    double expected[][3] = { { 1, 3, 8 }, { 25, 22, 29 }, { 35, 31, 0 } };
+    size_t counts[] = { 3, 3, 2 };
+    for (size_t v = 0; v < views.size(); ++v)
+    {
+        ASSERT_EQ(views[v]->size(), counts[v]);
+        for (PointId i = 0; i < views[v]->size(); ++i)
+            EXPECT_EQ(views[v]->getFieldAs<double>(Dimension::Id::X, i),
+                expected[v][i]);
+    }
+}
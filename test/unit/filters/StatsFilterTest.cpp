@@ -34,6 +34,8 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <cmath>
+
 #include <pdal/PDALUtils.hpp>
 #include <pdal/StageFactory.hpp>
 #include <FauxReader.hpp>
@@ -271,3 +273,80 @@ TEST(Stats, enum)
         d += (100.0 / 9);
     }
 }
+
+
+// Merging summaries should give the same results as inserting all of the
+// values into one.
+TEST(Stats, merge)
+{
+    stats::Summary all("all", stats::Summary::Count, true);
+    stats::Summary a("a", stats::Summary::Count, true);
+    stats::Summary b("b", stats::Summary::Count, true);
+
+    for (int i = 0; i < 10000; ++i)
+    {
+        double v = std::pow(i % 97, 1.5) + i / 1000;
+        all.insert(v);
+        if (i < 3000)
+            a.insert(v);
+        else
+            b.insert(v);
+    }
+    a.merge(b);
+
+    EXPECT_EQ(a.count(), all.count());
+    EXPECT_DOUBLE_EQ(a.minimum(), all.minimum());
+    EXPECT_DOUBLE_EQ(a.maximum(), all.maximum());
+    EXPECT_NEAR(a.average(), all.average(), 1e-9);
+    EXPECT_NEAR(a.variance(), all.variance(), 1e-6);
+    EXPECT_NEAR(a.skewness(), all.skewness(), 1e-9);
+    EXPECT_NEAR(a.kurtosis(), all.kurtosis(), 1e-9);
+    EXPECT_EQ(a.values(), all.values());
+    EXPECT_NEAR(a.median(), all.median(), 20);
+}
+
+
+TEST(Stats, quantiles)
+{
+    BOX3D bounds(0.0, 0.0, 0.0, 99999.0, 99999.0, 99999.0);
+    Options ops;
+    ops.add("bounds", bounds);
+    ops.add("count", 100000);
+    ops.add("mode", "ramp");
+
+    FauxReader reader;
+    reader.setOptions(ops);
+
+    Options filterOps;
+    filterOps.add("dimensions", "X");
+    filterOps.add("median", true);
+    filterOps.add("quantiles", "0.1, 0.9");
+    filterOps.add("bins", 10);
+    filterOps.add("threads", 4);
+
+    StatsFilter filter;
+    filter.setInput(reader);
+    filter.setOptions(filterOps);
+
+    PointTable table;
+    filter.prepare(table);
+    filter.execute(table);
+
+    const stats::Summary& statsX = filter.getStats(Dimension::Id::X);
+    EXPECT_EQ(statsX.count(), 100000u);
+    EXPECT_NEAR(statsX.average(), 49999.5, 1e-6);
+    EXPECT_NEAR(statsX.variance(), 100000.0 * 100001.0 / 12, 1);
+    EXPECT_NEAR(statsX.median(), 50000, 1000);
+    EXPECT_NEAR(statsX.quantile(.1), 10000, 1000);
+    EXPECT_NEAR(statsX.quantile(.9), 90000, 1000);
+
+    std::vector<point_count_t> hist = statsX.histogram(10);
+    EXPECT_EQ(hist.size(), 10u);
+    for (point_count_t c : hist)
+        EXPECT_NEAR((double)c, 10000.0, 1000.0);
+
+    MetadataNode m = filter.getMetadata().findChild("statistic");
+    EXPECT_NEAR(m.findChild("median").value<double>(), 50000, 1000);
+    EXPECT_EQ(m.children("quantiles").size(), 2u);
+    EXPECT_EQ(m.children("histogram").size(), 10u);
+}
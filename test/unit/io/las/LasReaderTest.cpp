@@ -34,9 +34,12 @@
 
 #include <pdal/pdal_test_main.hpp>
 
+#include <fstream>
+
 #include <pdal/Filter.hpp>
 #include <pdal/PointView.hpp>
 #include <pdal/StageFactory.hpp>
+#include <pdal/StageWrapper.hpp>
 #include <LasReader.hpp>
 #include "Support.hpp"
 
@@ -409,35 +412,41 @@ TEST(LasReaderTest, lazperf)
     PointViewPtr view1 = *pbSet.begin();
     EXPECT_EQ(view1->size(), (point_count_t)110000);
 
-    Options ops2;
-    ops2.add("filename", Support::datapath("las/autzen_trim.las"));
-
-    LasReader lasReader;
-    lasReader.setOptions(ops2);
-
-    PointTable t2;
-    lasReader.prepare(t2);
-    pbSet = lasReader.execute(t2);
-    EXPECT_EQ(pbSet.size(), 1UL);
-    PointViewPtr view2 = *pbSet.begin();
-    EXPECT_EQ(view2->size(), (point_count_t)110000);
-
-    DimTypeList dims = view1->dimTypes();
-    size_t pointSize = view1->pointSize();
-    EXPECT_EQ(view1->pointSize(), view2->pointSize());
-    // Validate some point data.
-    std::unique_ptr<char> buf1(new char[pointSize]);
-    std::unique_ptr<char> buf2(new char[pointSize]);
-    for (PointId i = 0; i < 110000; i += 100)
+    for (bool useMmap : { false, true })
     {
-       view1->getPackedPoint(dims, i, buf1.get());
-       view2->getPackedPoint(dims, i, buf2.get());
-       EXPECT_EQ(memcmp(buf1.get(), buf2.get(), pointSize), 0);
+        Options ops2;
+        ops2.add("filename", Support::datapath("las/autzen_trim.las"));
+        ops2.add("mmap", useMmap);
+
+        LasReader lasReader;
+        lasReader.setOptions(ops2);
+
+        PointTable t2;
+        lasReader.prepare(t2);
+        pbSet = lasReader.execute(t2);
+        EXPECT_EQ(pbSet.size(), 1UL);
+        PointViewPtr view2 = *pbSet.begin();
+        EXPECT_EQ(view2->size(), (point_count_t)110000);
+
+        DimTypeList dims = view1->dimTypes();
+        size_t pointSize = view1->pointSize();
+        EXPECT_EQ(view1->pointSize(), view2->pointSize());
+        // Validate some point data.
+        std::unique_ptr<char> buf1(new char[pointSize]);
+        std::unique_ptr<char> buf2(new char[pointSize]);
+        for (PointId i = 0; i < 110000; i += 100)
+        {
+           view1->getPackedPoint(dims, i, buf1.get());
+           view2->getPackedPoint(dims, i, buf2.get());
+           EXPECT_EQ(memcmp(buf1.get(), buf2.get(), pointSize), 0) <<
+               useMmap;
+        }
     }
 }
 #endif
 
-void streamTest(const std::string src, const std::string compression)
+void streamTest(const std::string src, const std::string compression,
+    bool useMmap = false)
 {
     Options ops1;
     ops1.add("filename", src);
@@ -487,6 +496,7 @@ void streamTest(const std::string src, const std::string compression)
 
     Options ops2;
     ops2.add("filename", Support::datapath("las/autzen_trim.las"));
+    ops2.add("mmap", useMmap);
 
     LasReader lazReader;
     lazReader.setOptions(ops2);
@@ -503,6 +513,7 @@ TEST(LasReaderTest, stream)
 {
     // Compression option is ignored for non-compressed file.
     streamTest(Support::datapath("las/autzen_trim.las"), "laszip");
+    streamTest(Support::datapath("las/autzen_trim.las"), "laszip", true);
 #ifdef PDAL_HAVE_LASZIP
     streamTest(Support::datapath("laz/autzen_trim.laz"), "laszip");
 #endif
@@ -512,6 +523,248 @@ TEST(LasReaderTest, stream)
 }
 
 
+#ifdef PDAL_HAVE_LAZPERF
+// Chunks decompressed concurrently must be loaded in order.
+TEST(LasReaderTest, threadedLaz)
+{
+    auto readView = [](const std::string& file, int threads)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath(file));
+        ops.add("threads", threads);
+        LasReader reader;
+        reader.setOptions(ops);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        PointViewPtr view = *s.begin();
+
+        std::vector<char> buf(view->size() * view->pointSize());
+        char *pos = buf.data();
+        DimTypeList dims = view->dimTypes();
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            view->point(idx).getPackedData(dims, pos);
+            pos += view->pointSize();
+        }
+        return buf;
+    };
+
+    std::vector<char> las = readView("las/autzen_trim.las", 1);
+    EXPECT_EQ(las, readView("laz/autzen_trim.laz", 4));
+    EXPECT_EQ(las, readView("laz/autzen_trim.laz", 1));
+}
+
+
+// Reads that stop partway through a chunk must leave the reader positioned
+// at the next point, so that later reads continue from it.
+TEST(LasReaderTest, threadedLazPartial)
+{
+    auto readParts = [](const std::string& file, int threads)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath(file));
+        ops.add("threads", threads);
+        ops.add("count", 30000);
+        LasReader reader;
+        reader.setOptions(ops);
+
+        PointTable table;
+        reader.prepare(table);
+        StageWrapper::ready(reader, table);
+
+        std::vector<char> buf;
+        while (true)
+        {
+            PointViewPtr view(new PointView(table));
+            PointViewSet s = StageWrapper::run(reader, view);
+            view = *s.begin();
+            if (view->empty())
+                break;
+
+            size_t start = buf.size();
+            buf.resize(start + view->size() * view->pointSize());
+            char *pos = buf.data() + start;
+            DimTypeList dims = view->dimTypes();
+            for (PointId idx = 0; idx < view->size(); ++idx)
+            {
+                view->point(idx).getPackedData(dims, pos);
+                pos += view->pointSize();
+            }
+        }
+        StageWrapper::done(reader, table);
+        return buf;
+    };
+
+    std::vector<char> las = readParts("las/autzen_trim.las", 1);
+    EXPECT_FALSE(las.empty());
+    EXPECT_EQ(las, readParts("laz/autzen_trim.laz", 4));
+    EXPECT_EQ(las, readParts("laz/autzen_trim.laz", 1));
+}
+#endif
+
+
+// Points read from a mapped file must match those read from a stream.
+TEST(LasReaderTest, mmap)
+{
+    auto readView = [](const std::string& file, bool useMmap,
+        point_count_t start)
+    {
+        Options ops;
+        ops.add("filename", Support::datapath(file));
+        ops.add("mmap", useMmap);
+        std::shared_ptr<LasReader> reader(new LasReader);
+        reader->setOptions(ops);
+
+        PointTable table;
+        reader->prepare(table);
+        if (start)
+            reader->seek(start);
+        PointViewSet s = reader->execute(table);
+        PointViewPtr view = *s.begin();
+
+        std::vector<char> buf(view->size() * view->pointSize());
+        char *pos = buf.data();
+        DimTypeList dims = view->dimTypes();
+        for (PointId idx = 0; idx < view->size(); ++idx)
+        {
+            view->point(idx).getPackedData(dims, pos);
+            pos += view->pointSize();
+        }
+        return buf;
+    };
+
+    EXPECT_EQ(readView("las/1.2-with-color.las", false, 0),
+        readView("las/1.2-with-color.las", true, 0));
+    EXPECT_EQ(readView("las/1.2-with-color.las", false, 1000),
+        readView("las/1.2-with-color.las", true, 1000));
+    EXPECT_EQ(readView("las/1.2-with-color.las", true, 1000).size(),
+        readView("las/1.2-with-color.las", true, 0).size() / 1065 * 65);
+
+    // The clipped file is missing a point.
+    EXPECT_EQ(readView("las/1.2-with-color-clipped.las", false, 0),
+        readView("las/1.2-with-color-clipped.las", true, 0));
+
+    Options ops;
+    ops.add("filename", Support::datapath("las/1.2-with-color.las"));
+    LasReader reader;
+    reader.setOptions(ops);
+    PointTable table;
+    reader.prepare(table);
+    EXPECT_THROW(reader.seek(1066), pdal_error);
+}
+
+
+// Reading with bounds must return the points within the bounds in file
+// order, whether or not a spatial index is used.
+TEST(LasReaderTest, bounds)
+{
+    // Copy the file so that the index is created in the temp directory.
+    std::string filename(Support::temppath("autzen_bounds.las"));
+    std::string idxFilename(filename + ".idx");
+    {
+        std::ifstream in(Support::datapath("las/autzen_trim.las"),
+            std::ios::binary);
+        std::ofstream out(filename, std::ios::binary);
+        out << in.rdbuf();
+    }
+    FileUtils::deleteFile(idxFilename);
+
+    auto readXY = [&filename](const BOX2D& bounds, bool index,
+        bool writeIndex = false)
+    {
+        Options ops;
+        ops.add("filename", filename);
+        if (!bounds.empty())
+            ops.add("bounds", bounds);
+        ops.add("index", index);
+        ops.add("write_index", writeIndex);
+        LasReader reader;
+        reader.setOptions(ops);
+
+        PointTable table;
+        reader.prepare(table);
+        PointViewSet s = reader.execute(table);
+        PointViewPtr view = *s.begin();
+
+        std::vector<std::pair<double, double>> xy;
+        for (PointId idx = 0; idx < view->size(); ++idx)
+            xy.push_back(std::make_pair(
+                view->getFieldAs<double>(Dimension::Id::X, idx),
+                view->getFieldAs<double>(Dimension::Id::Y, idx)));
+        return xy;
+    };
+
+    BOX2D bounds(637000, 850000, 637500, 850500);
+    std::vector<std::pair<double, double>> expected;
+    for (auto& p : readXY(BOX2D(), false))
+        if (bounds.contains(p.first, p.second))
+            expected.push_back(p);
+    EXPECT_GT(expected.size(), 0u);
+    EXPECT_LT(expected.size(), 110000u);
+
+    EXPECT_EQ(readXY(bounds, false), expected);
+    // The index is only written when asked for.
+    EXPECT_EQ(readXY(bounds, true), expected);
+    EXPECT_FALSE(FileUtils::fileExists(idxFilename));
+    EXPECT_EQ(readXY(bounds, true, true), expected);
+    EXPECT_TRUE(FileUtils::fileExists(idxFilename));
+    // Read using the existing index.
+    EXPECT_EQ(readXY(bounds, true), expected);
+
+    // A truncated index isn't used.
+    {
+        std::string idx = FileUtils::readFileIntoString(idxFilename);
+        std::ofstream out(idxFilename, std::ios::binary | std::ios::trunc);
+        out << idx.substr(0, idx.size() / 2);
+    }
+    EXPECT_EQ(readXY(bounds, true), expected);
+    EXPECT_EQ(readXY(bounds, true, true), expected);
+
+    // Stream with the index.
+    Options ops;
+    ops.add("filename", filename);
+    ops.add("bounds", bounds);
+    ops.add("index", true);
+    LasReader reader;
+    reader.setOptions(ops);
+
+    class Checker : public Filter
+    {
+    public:
+        Checker(const std::vector<std::pair<double, double>>& expected) :
+            m_cnt(0), m_expected(expected)
+        {}
+        std::string getName() const
+            { return "checker"; }
+        point_count_t m_cnt;
+    private:
+        const std::vector<std::pair<double, double>>& m_expected;
+
+        bool processOne(PointRef& point)
+        {
+            EXPECT_EQ(point.getFieldAs<double>(Dimension::Id::X),
+                m_expected[m_cnt].first);
+            EXPECT_EQ(point.getFieldAs<double>(Dimension::Id::Y),
+                m_expected[m_cnt].second);
+            m_cnt++;
+            return true;
+        }
+    };
+
+    Checker c(expected);
+    c.setInput(reader);
+    FixedPointTable t(100);
+    c.prepare(t);
+    c.execute(t);
+    EXPECT_EQ(c.m_cnt, expected.size());
+
+    FileUtils::deleteFile(filename);
+    FileUtils::deleteFile(idxFilename);
+}
+
+
 // The header of 1.2-with-color-clipped says that it has 1065 points,
 // but it really only has 1064.
 TEST(LasReaderTest, LasHeaderIncorrentPointcount)
@@ -631,6 +631,45 @@ void compareFiles(const std::string& name1, const std::string& name2,
     }
 }
 
+#ifdef PDAL_HAVE_LAZPERF
+// Chunks compressed concurrently must produce the same file as chunks
+// compressed one after another.
+TEST(LasWriterTest, lazperfThreads)
+{
+    auto write = [](const std::string& filename, int threads)
+    {
+        Options readerOps;
+        readerOps.add("filename", Support::datapath("las/autzen_trim.las"));
+        LasReader reader;
+        reader.setOptions(readerOps);
+
+        FileUtils::deleteFile(filename);
+        Options writerOps;
+        writerOps.add("filename", filename);
+        writerOps.add("compression", "lazperf");
+        writerOps.add("threads", threads);
+        LasWriter writer;
+        writer.setOptions(writerOps);
+        writer.setInput(reader);
+
+        PointTable t;
+        writer.prepare(t);
+        writer.execute(t);
+    };
+
+    std::string file1(Support::temppath("threads1.laz"));
+    std::string file4(Support::temppath("threads4.laz"));
+    write(file1, 1);
+    write(file4, 4);
+
+    EXPECT_EQ(FileUtils::readFileIntoString(file1),
+        FileUtils::readFileIntoString(file4));
+    compareFiles(file4, Support::datapath("las/autzen_trim.las"));
+    FileUtils::deleteFile(file1);
+    FileUtils::deleteFile(file4);
+}
+#endif
+
 TEST(LasWriterTest, stream)
 {
     std::string infile(Support::datapath("las/autzen_trim.las"));